@@ -1,14 +1,138 @@
 #pragma once
 #include "Player.h"
-#include "GomokuRuleSet.h" // Need specific rules for forbidden check
+#include "RulePolicy.h"
+#include "SearchParams.h"
+#include "SmallBoardSolver.h"
+#include "SparseBoard.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
 
 class AIPlayer : public Player {
 public:
+    // Figures from the last completed getAction() call
+    struct SearchStats {
+        int depth = 0;          // Deepest fully searched iteration
+        long long score = 0;
+        bool solved = false;    // The score is a proven win or loss; deeper iterations were skipped
+        long long nodes = 0;
+        long long qnodes = 0;   // Quiescence nodes (included in nodes)
+        long long forcedNodes = 0;  // Nodes that only searched replies to a four or open three
+        int rootMoves = 0;      // Root moves searched, one per symmetry class
+        long long elapsedMs = 0;
+        bool timeCut = false;   // The clock stopped a budgeted search before its budget ran out
+    };
+
     AIPlayer(int difficulty = 2) : difficulty(difficulty) {} // 1=Easy, 2=Medium, 3=Hard
     std::string name() const override { return "AI"; }
-    Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules) override;
+    Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop = StopToken()) override;
+
+    const SearchStats& lastStats() const { return stats; }
+
+    // Multi-PV analysis for hints: the best lineCount moves for the side to
+    // move, best first. onDepth is called from the searching thread after each
+    // completed depth; the search stops at the time budget or when stopped.
+    struct Analysis {
+        int depth = 0;
+        std::vector<PvLine> lines;
+    };
+    Analysis analyze(const GameContext& ctx, const Board& board, const RuleSet& rules, int lineCount, int timeLimitMs,
+                     const StopToken& stop, const std::function<void(const Analysis&)>& onDepth);
+
+    // Infinite-board freestyle (see SparseBoard.h): the best move for toMove,
+    // within the difficulty's depth and time limits. Stats are filled as for
+    // getAction(). Only the best-ordered moves of each node are searched.
+    Cell getSparseMove(const SparseBoard& board, Side toMove, const StopToken& stop = StopToken());
+
+    // Small-board variants (see SmallBoard.h): a move that keeps the
+    // game-theoretic value, read from the solution file given to
+    // setSolution() or, for positions it does not hold, solved on the spot
+    // within the time limit. lastStats().score is the value for the side to
+    // move (1 win, 0 draw, -1 loss) and depth is 0 when no value was proven
+    // in time. Returns the cell, -1 on a full board.
+    int getSmallBoardMove(const SmallBoard& board, const StopToken& stop = StopToken());
+    void setSolution(std::shared_ptr<const SolutionBook> book) { solution = std::move(book); }
+
+    // Root splitting for the distributed search (server/DistributedSearch.h):
+    // rootMoves() is the ordered list of root moves getAction() searches, one
+    // per mirror-image class. setRootMoves() limits getAction() to a subset
+    // of it (empty = all), searched in the given order; the score is then the
+    // best within the subset, and symmetry reduction and the persistent cache
+    // are skipped.
+    std::vector<Move> rootMoves(const GameContext& ctx, const Board& board) const;
+    void setRootMoves(std::vector<Move> moves) { rootSubset = std::move(moves); }
+    // A score some other root move is known to reach: at the final depth a
+    // score at or below it is only an upper bound, which is cheaper to prove
+    void setRootFloor(std::optional<long long> score) { rootFloor = score; }
+    // Search only the final depth, with the aspiration window starting at the
+    // floor, for a caller that runs the shallower iterations itself
+    void setFinalDepthOnly(bool enabled) { finalDepthOnly = enabled; }
+
+    // Search switches, mainly for benchmarking and self-play comparisons
+    void setQuiescence(bool enabled) { quiescence = enabled; }
+    void setTimeLimitMs(int ms) { timeLimitOverrideMs = ms; }
+    void setNnue(bool enabled) { useNnue = enabled; } // Only has effect when a network is loaded
+    void setMaxDepth(int depth) { maxDepthOverride = depth; } // 0 = use the difficulty's depth
+    void setSymmetry(bool enabled) { symmetry = enabled; }    // Search one root move per mirror-image class
+    // Against a four or an open three, search only the replies that do not lose
+    // at once: blocks, own fives and, against a three, own fours
+    void setForcedReplies(bool enabled) { forcedReplies = enabled; }
+    // Stop after this many nodes: 0 = the difficulty's budget (SearchParams
+    // nodes.*), negative = no limit. Like the time limit, an unfinished
+    // iteration is discarded, so the move only depends on the position and
+    // the budget, not on machine speed.
+    void setNodeLimit(long long nodes) { nodeLimit = nodes; }
+    // Interactive play: a budgeted search also stops after this many times the
+    // difficulty's time limit (SearchParams time.*), so a slow host cannot hold
+    // up a move for minutes; lastStats().timeCut tells when that happened.
+    // 0 = only a 10-minute safety cap, as the server and tools want.
+    void setBudgetTimeCap(int multiple) { budgetTimeCap = multiple; }
+    // Leaf evaluation noise amplitude (-1 = the difficulty's, 0 = none) and
+    // its seed. The offset is a hash of the position and the seed, so it
+    // weakens play without making it depend on the host.
+    void setNoise(int amplitude) { noiseOverride = amplitude; }
+    void setNoiseSeed(uint64_t seed) { noiseSeed = seed; }
+    // Search parameters for this player; SearchParams::active() when constructed
+    void setParams(const SearchParams& p) { params = p; }
+    const SearchParams& searchParams() const { return params; }
 
 private:
     int difficulty;
-    int evaluatePos(const Board& board, Pos p, Side mySide, const GomokuRuleSet* gomokuRules) const;
+    SearchStats stats;
+    bool quiescence = true;
+    bool useNnue = true;
+    bool symmetry = true;
+    bool forcedReplies = true;
+    int timeLimitOverrideMs = 0; // 0 = use the difficulty's limit
+    int maxDepthOverride = 0;
+    long long nodeLimit = 0;
+    int budgetTimeCap = 0;
+    int noiseOverride = -1;
+    uint64_t noiseSeed = 0x853C49E6748FEA9BULL;
+    SearchParams params = SearchParams::active();
+    std::shared_ptr<const SolutionBook> solution;
+    std::vector<Move> rootSubset;
+    std::optional<long long> rootFloor;
+    bool finalDepthOnly = false;
+
+    // The search is instantiated per rule policy (see RulePolicy.h) and board
+    // type; getAction() and analyze() dispatch on RuleSet::variant() once per call.
+    template <class Rules> Action think(const GameContext& ctx, const Board& board, const StopToken& stop);
+    template <class Rules> Analysis analyzeWith(const GameContext& ctx, const Board& board, int lineCount, int timeLimitMs,
+                                                const StopToken& stop, const std::function<void(const Analysis&)>& onDepth);
+    int depthLimit() const;     // The difficulty's limits, after the overrides
+    int timeLimit() const;
+    int searchTimeLimit() const;    // timeLimit(), or only a safety cap when a node budget decides
+    long long nodeBudget() const;   // 0 = none
+    int noiseLevel() const;
 };
+
+// Search building blocks, also used by the tools (defined in AIPlayer.cpp).
+// Candidate moves: empty cells within radius of a stone, plus Tengen; the
+// output overload clears moves first. The one-argument form uses radius 2.
+void getCandidates(const Board& board, int radius, std::vector<Move>& moves);
+std::vector<Move> getCandidates(const Board& board, int radius);
+std::vector<Move> getCandidates(const Board& board);
+// Hand-tuned evaluation from mySide's point of view (EvalWeights::active())
+long long evaluateBoard(const Board& board, Side mySide, Side oppSide);
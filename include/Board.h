@@ -2,12 +2,18 @@
 #include "Common.h"
 #include <vector>
 #include <array>
+#include <cstdint>
+
+class NnueAccumulator;
 
 class Board {
 public:
-    static const int SIZE = 15;
+    static const int SIZE = BOARD_SIZE;
 
     Board();
+    // Copies never inherit an attached accumulator
+    Board(const Board& other);
+    Board& operator=(const Board& other);
     
     void reset();
     bool isValid(Pos p) const;
@@ -18,12 +24,41 @@ public:
     void set(Pos p, Side s);
     void clear(Pos p); // For undo or testing
 
+    // Cell-index fast paths; the move must be on the board
+    Side get(Move m) const { return cells[m.index]; }
+    bool isEmpty(Move m) const { return cells[m.index] == Side::None; }
+    void set(Move m, Side s);
+    void clear(Move m) { set(m, Side::None); }
+
     // Helper for checking lines
     // Returns count of consecutive stones of 'side' starting from p in direction (dr, dc)
     // Does NOT include p itself if includeSelf is false.
     int countConsecutive(Pos p, int dr, int dc, Side side) const;
 
+    // Zobrist hash of the stones, updated incrementally by set/clear.
+    // Keys are fixed across runs so hashes can be stored on disk.
+    uint64_t hash() const { return images[0]; }
+    static uint64_t zobristKey(Move m, Side s);
+
+    // The 8 symmetries of the square board, numbered 0-7: bit 2 transposes,
+    // then bit 0 mirrors the columns and bit 1 the rows. 0 is the identity.
+    static Move transform(Move m, int sym);
+    static Move inverseTransform(Move m, int sym);
+    // Bit s is set when the stones are unchanged by symmetry s (bit 0 always)
+    uint8_t symmetries() const;
+    // Smallest hash over the 8 images of the position, the same for every
+    // mirror image; sym receives the symmetry that produced it. The image
+    // hashes are kept by set/clear too, so this is cheap enough for a leaf.
+    uint64_t canonicalHash(int* sym = nullptr) const;
+
+    // Incremental evaluator hook: every change made by set/clear is forwarded
+    // to the attached accumulator. Call attach(nullptr) to detach.
+    void attach(NnueAccumulator* acc) { accumulator = acc; }
+    NnueAccumulator* attached() const { return accumulator; }
+
 private:
-    std::array<std::array<Side, SIZE>, SIZE> grid;
+    std::array<Side, SIZE * SIZE> cells;   // One byte per cell, indexed like Move
     int stoneCount;
+    std::array<uint64_t, 8> images{};      // Hash of the position under each symmetry; [0] is hash()
+    NnueAccumulator* accumulator = nullptr;
 };
@@ -2,22 +2,77 @@
 #include <string>
 #include <optional>
 #include <chrono>
+#include <cstdint>
 #include <vector>
 
 // Basic types
-enum class Side { Black, White, None };
+constexpr int BOARD_SIZE = 15;
+
+enum class Side : uint8_t { Black, White, None };
 
 struct Pos {
     int r, c;
     bool operator==(const Pos& other) const { return r == other.r && c == other.c; }
 };
 
-enum class ActionType { Place, Resign, ClaimForbidden, OfferDraw, AcceptDraw, RejectDraw, Undo };
+// A board cell in one byte: index = r * BOARD_SIZE + c. The default value is
+// "no cell" (non-place actions, unparseable or off-board input).
+struct Move {
+    static constexpr uint8_t NONE = 255;
+    uint8_t index = NONE;
+
+    constexpr Move() = default;
+    constexpr Move(Pos p) : index(inBounds(p.r, p.c) ? (uint8_t)(p.r * BOARD_SIZE + p.c) : NONE) {}
+    static constexpr Move at(int r, int c) { return Move(Pos{r, c}); }
+    static constexpr Move fromIndex(int i) { Move m; m.index = (uint8_t)i; return m; }
+
+    constexpr bool isNone() const { return index == NONE; }
+    constexpr int row() const { return index / BOARD_SIZE; }
+    constexpr int col() const { return index % BOARD_SIZE; }
+    constexpr Pos pos() const { return isNone() ? Pos{-1, -1} : Pos{row(), col()}; }
+
+    constexpr bool operator==(Move other) const { return index == other.index; }
+    constexpr bool operator!=(Move other) const { return index != other.index; }
+
+private:
+    static constexpr bool inBounds(int r, int c) { return r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE; }
+};
+static_assert(sizeof(Move) == 1, "Move must stay one byte");
+static_assert(Move::at(7, 8).row() == 7 && Move::at(7, 8).col() == 8 && Move::at(-1, 3).isNone(), "Move encoding");
+
+enum class ActionType : uint8_t { Place, Resign, ClaimForbidden, OfferDraw, AcceptDraw, RejectDraw, Undo, Hint, Cancelled }; // Cancelled: a stopped search with no move
 
 struct Action {
-    ActionType type;
-    std::optional<Pos> pos; // Only for Place
-    std::chrono::milliseconds spent;
+    ActionType type = ActionType::Place;
+    Move move;                  // Only for Place
+    uint32_t spentMs = 0;
+};
+
+// Packed history entry (4 bytes): who acted, what they did, where, and how long
+// they took in milliseconds (clamped to 65535)
+struct HistoryEntry {
+    HistoryEntry() = default;
+    HistoryEntry(Side side, const Action& action)
+        : bits((uint8_t)((uint8_t)side << 4 | (uint8_t)action.type)), move(action.move),
+          spentMs((uint16_t)(action.spentMs > 0xFFFF ? 0xFFFF : action.spentMs)) {}
+
+    Side side() const { return (Side)(bits >> 4); }
+    ActionType type() const { return (ActionType)(bits & 0x0F); }
+    Action action() const { return Action{type(), move, spentMs}; }
+
+    uint8_t bits = 0;           // side << 4 | type
+    Move move;
+    uint16_t spentMs = 0;
+};
+static_assert(sizeof(HistoryEntry) == 4, "HistoryEntry must stay packed");
+
+// One line of a multi-PV analysis: a candidate move, its score for the side
+// to move and the expected continuation (starting with the move itself)
+struct PvLine {
+    Move move;
+    long long score;
+    std::vector<Move> pv;
+    int forced = 0; // +1: forced win found, -1: forced loss, 0: heuristic score
 };
 
 enum class GameStatus { Ongoing, Win, Draw, Forbidden, TimeoutLose, PendingClaim };
@@ -28,25 +83,24 @@ struct Outcome {
     std::string reason; // "five", "double-three", "timeout", etc.
 };
 
-enum class Phase { Opening, Normal, PendingClaim, Finished };
+enum class Phase : uint8_t { Opening, Normal, PendingClaim, Finished };
 
 struct GameContext {
     Side toMove = Side::Black;
+    Phase phase = Phase::Opening;
+    // For pending forbidden claim
+    // If Black plays a forbidden move, we store it here.
+    // If White claims, White wins. If White plays elsewhere, this is cleared.
+    bool pendingForbidden = false; 
+    uint8_t blackTimeoutWarnings = 0;
+    uint8_t whiteTimeoutWarnings = 0;
     int turnIndex = 0;
     std::optional<Action> lastAction;
-    int blackTimeoutWarnings = 0;
-    int whiteTimeoutWarnings = 0;
-    Phase phase = Phase::Opening;
     
     // Time control
     long long totalGameDurationSeconds = 1800; // 30 minutes default
     long long elapsedGameSeconds = 0;
 
-    // For pending forbidden claim
-    // If Black plays a forbidden move, we store it here.
-    // If White claims, White wins. If White plays elsewhere, this is cleared.
-    bool pendingForbidden = false; 
-
     // Move history
-    std::vector<std::pair<Side, Action>> history;
+    std::vector<HistoryEntry> history;
 };
@@ -0,0 +1,45 @@
+#pragma once
+#include "Common.h"
+#include "Board.h"
+#include <cstdint>
+#include <string>
+
+// Line patterns scored by the hand-written evaluator (index into EvalWeights tables)
+enum EvalPattern { PAT_FIVE, PAT_OPEN_FOUR, PAT_FOUR, PAT_OPEN_THREE, PAT_THREE, PAT_OPEN_TWO, PAT_TWO, PAT_SINGLE, PAT_COUNT };
+
+// Classify a run of 'count' stones by how many of its ends are open; -1 if it scores nothing
+inline int classifyRun(int count, bool open1, bool open2) {
+    if (count >= 5) return PAT_FIVE;
+    if (!open1 && !open2) return -1;
+    bool both = open1 && open2;
+    if (count == 4) return both ? PAT_OPEN_FOUR : PAT_FOUR;
+    if (count == 3) return both ? PAT_OPEN_THREE : PAT_THREE;
+    if (count == 2) return both ? PAT_OPEN_TWO : PAT_TWO;
+    return both ? PAT_SINGLE : -1;
+}
+
+// Evaluator weights. Defaults are the original hand-picked values; a tuned
+// set can be loaded at startup so the engine is retuned without recompiling.
+struct EvalWeights {
+    // evaluateBoard: added per stone and direction
+    long long board[PAT_COUNT] = {100000000, 1000000, 100000, 100000, 1000, 100, 10, 0};
+    // AIPlayer move ordering (evaluatePos): pattern score of a point, attack weighted by attackFactor
+    int order[PAT_COUNT] = {100000, 10000, 1000, 1000, 100, 100, 10, 1};
+    int attackFactor = 2;
+
+    static const char* patternName(int pattern);
+
+    // Text file of "name value" lines, e.g. "board.open_three 100000"; unknown keys are rejected
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Hash of all weights; changes whenever a different set is loaded
+    uint64_t fingerprint() const;
+
+    static EvalWeights& active();
+    // Load $GOMOKU_WEIGHTS, else ../weights/eval.txt; defaults stay in place if neither loads
+    static bool loadDefault();
+};
+
+// Pattern counts of evaluateBoard: mySide's counts minus oppSide's
+void extractEvalFeatures(const Board& board, Side mySide, Side oppSide, int features[PAT_COUNT]);
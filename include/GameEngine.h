@@ -2,24 +2,36 @@
 #include "Common.h"
 #include "Board.h"
 #include "RuleSet.h"
+#include "GameSession.h"
 #include "Player.h"
 #include "Renderer.h"
+#include "MoveJournal.h"
+#include "SpectatorFeed.h"
+#include "SpectatorServer.h"
 #include <memory>
 
 class GameEngine {
 public:
     GameEngine();
+    ~GameEngine();
     void run();
 
 private:
-    Board board;
-    GameContext ctx;
-    std::unique_ptr<RuleSet> rules;
+    GameSession session;
     std::unique_ptr<Player> blackPlayer;
     std::unique_ptr<Player> whitePlayer;
+    int blackCode = 0;                                  // Player kinds as chosen in setup (0 = human, 1-3 = AI level, 4 = MCTS)
+    int whiteCode = 0;
     Renderer renderer;
+    SpectatorFeed spectators;                           // Every move and clock tick, published once
+    std::unique_ptr<SpectatorServer> spectatorServer;   // Serves the feed when $GOMOKU_SPECTATE is set
+    std::string spectateError;                          // Shown in the menu when the socket could not be opened
+    MoveJournal journal;                                // Every applied action, for crash recovery
 
     void setup();
+    bool resumeInterrupted();
+    // Submits to the session and journals the action if it changed the game
+    GameSession::MoveResult submitAction(const Action& action, int undoPlies);
     void saveGameRecord();
     void loadAndReplay();
 };
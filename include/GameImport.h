@@ -0,0 +1,68 @@
+#pragma once
+#include "Common.h"
+#include "GameRecord.h"
+#include "GameSession.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Streaming readers for game collections from other programs, and the check
+// that admits an imported game to our archive. A reader keeps one game and
+// one bounded line in memory, however large the file.
+//
+//   Record    our match/ text records (GameEngine::saveGameRecord), any number per file
+//   Psq       Piskvork / Gomocup: "Piskvork 15x15, ..." header, "x,y,ms" lines
+//             (1-based column, row), then the player names; games may be concatenated
+//   RenLib    RenLib .lib opening trees: every leaf of the tree is one game
+//   MoveList  one game per line: "h8 i9 h10 ..." (column letter, row number from 1;
+//             separators and move numbers optional) with an optional result
+//             "1-0", "0-1" or "1/2-1/2"; '#' starts a comment
+enum class ImportFormat : uint8_t { Record, Psq, RenLib, MoveList };
+
+const char* importFormatName(ImportFormat format);
+
+struct ImportedGame {
+    enum class Result : uint8_t { Unknown, BlackWins, WhiteWins, Draw };
+
+    GameRecord record;                  // Places alternate Black/White from the first move
+    Result result = Result::Unknown;    // As the source states it
+    int boardSize = Board::SIZE;        // As the source states it
+    std::string problem;                // Set by the reader when the game could not be read
+};
+
+class GameReader {
+public:
+    virtual ~GameReader() = default;
+
+    // The next game; false at the end of the file or on a damaged file
+    virtual bool next(ImportedGame& game) = 0;
+    uint64_t bytesRead() const { return bytes; }
+    // Why reading stopped early; empty at a clean end of file
+    const std::string& error() const { return failure; }
+
+    static std::unique_ptr<GameReader> open(const std::string& path, ImportFormat format);
+    // .psq and .lib by extension; other files by their first line
+    static ImportFormat detect(const std::string& path);
+
+protected:
+    std::ifstream in;
+    std::vector<char> buffer;
+    uint64_t bytes = 0;
+    std::string failure;
+
+    bool openFile(const std::string& path);
+    // One line without its end; longer lines are cut at MAX_LINE and flagged
+    bool readLine(std::string& line, bool& tooLong);
+    static const size_t MAX_LINE = 8192;
+};
+
+// Replays the game on the session (restarted first) under the session's rule
+// set and rewrites record.moves with the actions it accepted. Games must open
+// at Tengen; a game whose White reply lies above it is mirrored first, since
+// our rules want it on White's half. A game left on an unclaimed forbidden
+// move gets White's claim, and a stated win not shown on the board becomes
+// the loser's resignation. Returns false with the reason when a move is
+// illegal or the stated result contradicts the board.
+bool validateImportedGame(GameSession& session, ImportedGame& game, std::string& reason);
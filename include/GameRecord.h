@@ -0,0 +1,22 @@
+#pragma once
+#include "Common.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A finished game in the match/ text format written by GameEngine::saveGameRecord
+struct GameRecord {
+    std::string date;
+    std::string black;
+    std::string white;
+    std::vector<HistoryEntry> moves;
+};
+
+// Parse one record. Returns false if the stream has no move history section.
+// Records end at their final board, so a stream can hold any number of them.
+bool readGameRecord(std::istream& in, GameRecord& record);
+
+class Board;
+// Write one record in the same format; board is the final position
+void writeGameRecord(std::ostream& out, const GameRecord& record, const Board& board);
@@ -0,0 +1,43 @@
+#pragma once
+#include "Common.h"
+#include "Board.h"
+#include "RuleSet.h"
+#include <memory>
+#include <string>
+
+// One game's state, independent of any terminal or socket I/O: validates,
+// applies and judges actions against a RuleSet. GameEngine drives a single
+// session from the keyboard; the server hosts many of them.
+class GameSession {
+public:
+    struct MoveResult {
+        bool applied = false;   // false for rejected actions and for undo
+        Outcome outcome;        // Ongoing unless the action ended the game or left a pending claim
+        std::string message;    // Why an action was rejected, or the undo result
+    };
+
+    explicit GameSession(std::shared_ptr<const RuleSet> rules);
+
+    // Reset board and context for a new game
+    void start();
+
+    // Submit the side to move's action. An undo rewinds undoPlies moves.
+    MoveResult submit(const Action& action, int undoPlies = 1);
+
+    // The side to move ran out of step time
+    Outcome timeout();
+
+    bool finished() const { return over; }
+    const Board& getBoard() const { return board; }
+    GameContext& getContext() { return ctx; }
+    const GameContext& getContext() const { return ctx; }
+    const RuleSet& getRules() const { return *rules; }
+
+private:
+    std::shared_ptr<const RuleSet> rules;
+    Board board;
+    GameContext ctx;
+    bool over = false;
+
+    bool undo(int plies, std::string& message);
+};
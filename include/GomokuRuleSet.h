@@ -1,11 +1,17 @@
 #pragma once
 #include "RuleSet.h"
+#include "RulePolicy.h"
 #include <vector>
 
-class GomokuRuleSet : public RuleSet {
+// RuleSet adapter over a compile-time rule policy (see RulePolicy.h).
+// Game flow (Tengen opening, White's first move in its own half, forbidden
+// claims, timeouts) is shared; five and forbidden checks come from Policy.
+template <class Policy>
+class PolicyRuleSet : public RuleSet {
 public:
-    std::string name() const override { return "Gomoku (Renju-like)"; }
+    std::string name() const override { return Policy::NAME; }
     int boardSize() const override { return 15; }
+    RuleVariant variant() const override { return Policy::VARIANT; }
 
     void initGame(GameContext& ctx, Board& board) const override;
     bool validateAction(const GameContext& ctx, const Board& board, Side side, const Action& action, std::string& reason) const override;
@@ -15,16 +21,12 @@ public:
 
     // Public for testing/AI
     bool isForbidden(const Board& board, Pos p, std::string& reason) const;
-
-private:
-    // Forbidden logic helpers
-    bool checkOverline(const Board& board, Pos p) const;
-    bool checkThreeThree(const Board& board, Pos p) const;
-    bool checkFourFour(const Board& board, Pos p) const;
-    
-    // Helper to analyze lines
-    // Returns true if a pattern is found
-    bool isOpenThree(const Board& board, Pos p, int dr, int dc) const;
-    bool isFour(const Board& board, Pos p, int dr, int dc) const; // Straight 4 or broken 4 that can become 5
-    bool isFive(const Board& board, Pos p, int dr, int dc) const;
 };
+
+extern template class PolicyRuleSet<FreestylePolicy>;
+extern template class PolicyRuleSet<StandardPolicy>;
+extern template class PolicyRuleSet<RenjuPolicy>;
+
+using FreestyleRuleSet = PolicyRuleSet<FreestylePolicy>;
+using StandardRuleSet = PolicyRuleSet<StandardPolicy>;
+using GomokuRuleSet = PolicyRuleSet<RenjuPolicy>;
@@ -4,7 +4,7 @@
 class HumanPlayer : public Player {
 public:
     std::string name() const override { return "Human"; }
-    Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules) override;
+    Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop = StopToken()) override;
     
     // Static helper to parse command string
     static Action parseCommand(const std::string& input);
@@ -0,0 +1,43 @@
+#pragma once
+#include "Player.h"
+#include "RulePolicy.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+struct MctsNode;
+
+// Monte Carlo tree search player: PUCT selection with pattern-based priors,
+// tree parallelism with virtual loss, nodes in a preallocated arena.
+class MctsPlayer : public Player {
+public:
+    struct SearchStats {
+        long long playouts = 0;
+        long long nodes = 0;      // Arena nodes in use
+        long long elapsedMs = 0;
+        int threads = 0;
+    };
+
+    // threads = 0 uses all hardware threads
+    MctsPlayer(int timeLimitMs = 5000, int threads = 0, size_t arenaNodes = 1 << 21);
+    ~MctsPlayer() override;
+    std::string name() const override { return "AI"; }
+    Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop = StopToken()) override;
+
+    const SearchStats& lastStats() const { return stats; }
+
+private:
+    int timeLimitMs;
+    int threads;
+    size_t arenaCapacity;
+    std::unique_ptr<MctsNode[]> arena;
+    std::atomic<size_t> arenaUsed{0};
+    SearchStats stats;
+
+    int allocate(int count);
+    // Instantiated per rule policy; getAction() dispatches on RuleSet::variant()
+    template <class Rules> void expand(MctsNode& node, const Board& board, Side toMove, bool whiteFirstMove);
+    template <class Rules> int playout(Board& board, Side toMove, uint32_t& rng) const;
+    template <class Rules> void worker(const Board& rootBoard, Side rootSide, bool whiteFirstMove,
+                                       std::chrono::steady_clock::time_point deadline, const StopToken& stop, std::atomic<long long>& playouts);
+};
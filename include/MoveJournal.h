@@ -0,0 +1,93 @@
+#pragma once
+#include "Common.h"
+#include "GameSession.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Write-ahead journal of the game in progress, so a crash or kill loses at
+// most the last sync interval of it instead of the whole game.
+//
+// The game loop only copies a 16-byte record into a queue; a background
+// thread appends queued records to the file as soon as they arrive (one
+// write per batch, so a killed process loses nothing already queued) and
+// fsyncs at most every syncIntervalMs, and at once when a game ends.
+// Records carry a checksum: a torn tail is ignored on recovery. The file
+// holds one game; begin() truncates it.
+class MoveJournal {
+public:
+    enum class Kind : uint8_t { Start = 1, Action, Timeout, Clock, End };
+
+    struct Record {
+        Kind kind;
+        uint8_t arg;            // Start: black player code | white code << 4; Action: undo plies
+        uint16_t check;         // Checksum of the other fields
+        HistoryEntry entry;     // Action: side and action as submitted
+        uint32_t elapsedSeconds;
+        uint32_t totalSeconds;
+    };
+
+    struct Stats {
+        long long records = 0;
+        long long writes = 0;   // write() calls (batches)
+        long long syncs = 0;
+        long long syncMicros = 0;
+    };
+
+    explicit MoveJournal(std::string path, int syncIntervalMs = 200);
+    ~MoveJournal();     // Writes and syncs whatever is queued
+
+    // Game loop side; none of these waits on disk
+    void begin(int blackCode, int whiteCode, const GameContext& ctx);
+    void action(Side side, const Action& action, int undoPlies, const GameContext& ctx);
+    void timeout(const GameContext& ctx);
+    void clock(const GameContext& ctx);     // Game duration changed (overtime)
+    void end(const GameContext& ctx);       // Also syncs right away
+
+    void sync();        // Blocks until everything queued is on disk
+    Stats stats() const;
+    const std::string& path() const { return filePath; }
+
+    // The records of the journal's game up to the first damaged one; false if
+    // there is no game in the file
+    static bool load(const std::string& path, std::vector<Record>& records);
+    static bool finished(const std::vector<Record>& records) { return !records.empty() && records.back().kind == Kind::End; }
+    // Restarts the session and replays the records onto it, restoring board,
+    // context and clock; false if the session rejects a record
+    static bool replay(const std::vector<Record>& records, GameSession& session);
+    // $GOMOKU_JOURNAL, else ../match/current.journal
+    static std::string defaultPath();
+
+private:
+    const std::string filePath;
+    const std::chrono::milliseconds syncInterval;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable synced;
+    std::vector<Record> queue;
+    bool truncateRequested = false;
+    bool syncRequested = false;
+    bool stopping = false;
+    uint64_t appended = 0;      // Records queued so far
+    uint64_t durable = 0;       // Records known to be on disk
+    Stats counters;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+    std::thread writer;
+
+    void append(Record record, bool syncNow);
+    void writerLoop();
+    bool openFile();
+    bool writeAll(const void* data, size_t bytes);
+    void truncateFile();
+    void syncFile();
+};
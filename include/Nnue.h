@@ -0,0 +1,67 @@
+#pragma once
+#include "Common.h"
+#include "Board.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NnueAccumulator;
+
+// Small efficiently updatable network (NNUE-style) evaluator.
+//
+// Inputs are one-hot (cell, own/opponent stone) features seen from each side's
+// perspective. The first layer is kept as an int16 accumulator per perspective
+// that Board::set/clear update for the changed cell only; the remaining two
+// layers are int8 and evaluated with integer SIMD dot products.
+class NnueNetwork {
+public:
+    static const int INPUTS = Board::SIZE * Board::SIZE * 2;
+    static const int HIDDEN = 64;   // Accumulator width per perspective
+    static const int L2 = 32;
+    // evaluate() is clamped to +-MAX_EVAL: above any evaluateBoard score (a five
+    // weighs 1e8), far below the search's win scores (1e12), so a bad weights
+    // file cannot pose as a forced win
+    static constexpr long long MAX_EVAL = 10000000000LL;
+
+    // Load weights from file; returns false (and keeps the previous network) on any error
+    static bool load(const std::string& path);
+    // Load from $GOMOKU_NNUE, else ../nnue/gomoku.nnue. The hand-tuned evaluator stays in use if neither loads.
+    static bool loadDefault();
+    static const NnueNetwork* active();
+
+    // Random small weights, only for benchmarking the inference path
+    void initRandom(unsigned seed);
+    bool save(const std::string& path) const;
+
+    // Score from toMove's point of view, in evaluateBoard units
+    long long evaluate(const NnueAccumulator& acc, Side toMove) const;
+
+private:
+    friend class NnueAccumulator;
+
+    int32_t scale = 1;
+    alignas(32) int16_t ftBias[HIDDEN];
+    std::vector<int16_t> ftWeights;                 // [INPUTS][HIDDEN]
+    alignas(32) int32_t l2Bias[L2];
+    alignas(32) int8_t l2Weights[L2][2 * HIDDEN];
+    int32_t outBias = 0;
+    alignas(32) int8_t outWeights[L2];
+};
+
+class NnueAccumulator {
+public:
+    explicit NnueAccumulator(const NnueNetwork& net) : net(net) {}
+
+    // Recompute both perspectives from scratch
+    void refresh(const Board& board);
+    // Called by Board::set when cell p changes from 'before' to 'after'
+    void update(Move m, Side before, Side after);
+
+    const int16_t* values(Side perspective) const { return acc[perspective == Side::Black ? 0 : 1]; }
+
+private:
+    const NnueNetwork& net;
+    alignas(32) int16_t acc[2][NnueNetwork::HIDDEN];
+
+    void addFeature(int perspective, int feature, int sign);
+};
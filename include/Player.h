@@ -2,10 +2,12 @@
 #include "Common.h"
 #include "Board.h"
 #include "RuleSet.h"
+#include "StopToken.h"
 
 class Player {
 public:
     virtual ~Player() = default;
     virtual std::string name() const = 0;
-    virtual Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules) = 0;
+    // A stopped search returns its best move so far, or ActionType::Cancelled if it has none
+    virtual Action getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop = StopToken()) = 0;
 };
@@ -2,9 +2,19 @@
 #include "Common.h"
 #include "Board.h"
 #include <string>
+#include <vector>
 
 class Renderer {
 public:
     void render(const GameContext& ctx, const Board& board, const std::string& message = "", const std::string& currentInput = "");
     void clearScreen();
+
+    // Hint overlay: numbered candidate cells on the board plus one line per
+    // suggestion under it, drawn by every render() until cleared
+    void setHints(const std::vector<PvLine>& lines, int depth);
+    void clearHints();
+
+private:
+    std::vector<PvLine> hints;
+    int hintDepth = 0;
 };
@@ -0,0 +1,135 @@
+#pragma once
+#include "Common.h"
+#include "Board.h"
+#include "Trace.h"
+
+// Compile-time rule variants.
+//
+// The AI search is instantiated on one of these policies, so the win and
+// forbidden-move checks are plain inline calls on the hot path. The virtual
+// RuleSet interface (PolicyRuleSet<P> in GomokuRuleSet.h) only adapts a
+// policy for GameEngine, GameSession and the server. The freestyle and
+// standard checks take any board type, so they also run on SparseBoard.
+enum class RuleVariant : uint8_t { Freestyle, Standard, Renju };
+
+// Why a move is forbidden. The checks return the code; text is only made
+// for the player (forbiddenText) when a game reports it.
+enum class Forbidden : uint8_t { None, Overline, DoubleThree, DoubleFour };
+
+inline const char* forbiddenText(Forbidden reason) {
+    switch (reason) {
+    case Forbidden::Overline: return "长连 (6+)";
+    case Forbidden::DoubleThree: return "三三禁手";
+    case Forbidden::DoubleFour: return "四四禁手";
+    case Forbidden::None: break;
+    }
+    return "";
+}
+
+// Renju forbidden-move detection for Black, on a stone already placed at p.
+// The line around p is read into a fixed 9-cell window (index 4 = p):
+// 1 = Black, 0 = empty, 2 = White or off-board.
+namespace renju {
+
+inline void readLine(const Board& board, Pos p, int dr, int dc, int line[9]) {
+    for (int i = -4; i <= 4; ++i) {
+        Pos q = {p.r + i * dr, p.c + i * dc};
+        Side s = board.get(q); // Side::None off the board
+        if (!board.isValid(q) || s == Side::White) line[i + 4] = 2;
+        else line[i + 4] = (s == Side::Black) ? 1 : 0;
+    }
+}
+
+// 活三：能够形成直四的三 (01110, 010110, 011010)
+inline bool isOpenThree(const int* line) {
+    // 连三 .XXX.，p 在中间、左端或右端
+    if (line[3] == 1 && line[4] == 1 && line[5] == 1 && line[2] == 0 && line[6] == 0) return true;
+    if (line[4] == 1 && line[5] == 1 && line[6] == 1 && line[3] == 0 && line[7] == 0) return true;
+    if (line[2] == 1 && line[3] == 1 && line[4] == 1 && line[1] == 0 && line[5] == 0) return true;
+    // 跳三 1011
+    if (line[4] == 1 && line[5] == 0 && line[6] == 1 && line[7] == 1 && line[3] == 0 && line[8] == 0) return true;
+    if (line[2] == 1 && line[3] == 0 && line[4] == 1 && line[5] == 1 && line[1] == 0 && line[6] == 0) return true;
+    if (line[1] == 1 && line[2] == 0 && line[3] == 1 && line[4] == 1 && line[0] == 0 && line[5] == 0) return true;
+    // 跳三 1101
+    if (line[4] == 1 && line[5] == 1 && line[6] == 0 && line[7] == 1 && line[3] == 0 && line[8] == 0) return true;
+    if (line[3] == 1 && line[4] == 1 && line[5] == 0 && line[6] == 1 && line[2] == 0 && line[7] == 0) return true;
+    return false;
+}
+
+// 四：某个 5 格窗口内有 4 个黑子和 1 个空位
+inline bool isFour(const int* line) {
+    for (int start = 0; start <= 4; ++start) {
+        int ones = 0, zeros = 0;
+        for (int k = start; k < start + 5; ++k) {
+            if (line[k] == 1) ones++;
+            else if (line[k] == 0) zeros++;
+        }
+        if (ones == 4 && zeros == 1) return true;
+    }
+    return false;
+}
+
+// 长连、三三、四四；返回禁手类型（不是禁手时为 Forbidden::None）
+inline Forbidden classify(const Board& board, Pos p) {
+    static const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        int count = 1 + board.countConsecutive(p, d[0], d[1], Side::Black) + board.countConsecutive(p, -d[0], -d[1], Side::Black);
+        if (count > 5) return Forbidden::Overline;
+    }
+
+    int lines[4][9];
+    for (int i = 0; i < 4; ++i) readLine(board, p, dirs[i][0], dirs[i][1], lines[i]);
+    int threes = 0, fours = 0;
+    for (auto& line : lines) {
+        if (isOpenThree(line)) threes++;
+        if (isFour(line)) fours++;
+    }
+    if (threes >= 2) return Forbidden::DoubleThree;
+    if (fours >= 2) return Forbidden::DoubleFour;
+    return Forbidden::None;
+}
+
+inline bool isForbidden(const Board& board, Pos p) {
+    return classify(board, p) != Forbidden::None;
+}
+
+} // namespace renju
+
+// Five or more in a row wins for both sides; nothing is forbidden
+struct FreestylePolicy {
+    static constexpr RuleVariant VARIANT = RuleVariant::Freestyle;
+    static constexpr bool HAS_FORBIDDEN = false;
+    static constexpr const char* NAME = "Gomoku (Freestyle)";
+
+    // Does a run of 'length' stones through the new stone win for 'side'?
+    static constexpr bool isWinningRun(int length, Side) { return length >= 5; }
+    template <class B> static Forbidden forbidden(const B&, Pos, Side) { return Forbidden::None; }
+    template <class B> static bool isForbidden(const B&, Pos, Side) { return false; }
+};
+
+// Exactly five wins for both sides; overlines do not count, nothing is forbidden
+struct StandardPolicy {
+    static constexpr RuleVariant VARIANT = RuleVariant::Standard;
+    static constexpr bool HAS_FORBIDDEN = false;
+    static constexpr const char* NAME = "Gomoku (Standard)";
+
+    static constexpr bool isWinningRun(int length, Side) { return length == 5; }
+    template <class B> static Forbidden forbidden(const B&, Pos, Side) { return Forbidden::None; }
+    template <class B> static bool isForbidden(const B&, Pos, Side) { return false; }
+};
+
+// Black must make exactly five and may not play overlines, double threes or
+// double fours; White wins with five or more
+struct RenjuPolicy {
+    static constexpr RuleVariant VARIANT = RuleVariant::Renju;
+    static constexpr bool HAS_FORBIDDEN = true;
+    static constexpr const char* NAME = "Gomoku (Renju-like)";
+
+    static constexpr bool isWinningRun(int length, Side side) { return length == 5 || (length > 5 && side == Side::White); }
+    static Forbidden forbidden(const Board& board, Pos p, Side side) {
+        if (side != Side::Black) return Forbidden::None;
+        TRACE_SCOPE("rules.forbidden");
+        return renju::classify(board, p);
+    }
+    static bool isForbidden(const Board& board, Pos p, Side side) { return forbidden(board, p, side) != Forbidden::None; }
+};
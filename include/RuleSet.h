@@ -1,6 +1,7 @@
 #pragma once
 #include "Common.h"
 #include "Board.h"
+#include "RulePolicy.h"
 #include <string>
 #include <vector>
 
@@ -10,6 +11,8 @@ public:
 
     virtual std::string name() const = 0;
     virtual int boardSize() const = 0;
+    // Which compile-time policy the AI should instantiate its search on
+    virtual RuleVariant variant() const = 0;
 
     // Initialize game state (e.g. Black plays Tengen)
     virtual void initGame(GameContext& ctx, Board& board) const = 0;
@@ -0,0 +1,79 @@
+#pragma once
+#include "Common.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Persistent cache of deep root search results, keyed by position hash.
+//
+// The file is memory-mapped, so opening it costs the same whatever its size.
+// Writes land in the mapping and a background thread flushes them
+// asynchronously; the search never waits on disk. Each entry carries its own
+// checksum, so entries torn by a crash are read back as empty and the file
+// can always be reopened. The table has a fixed capacity chosen at creation,
+// organised in 4-way buckets with depth-preferred, age-aware replacement.
+class SearchCache {
+public:
+    struct Result {
+        Move move;
+        int depth;
+        long long score;
+        uint32_t searchMs;   // Time the original search took to reach this depth
+    };
+
+    struct Stats {
+        std::atomic<long long> probes{0};
+        std::atomic<long long> hits{0};
+        std::atomic<long long> stores{0};
+        std::atomic<long long> msSaved{0};
+    };
+
+    ~SearchCache();
+
+    // Open or create the cache file; capacity (entries) is rounded up to a power of two
+    static bool open(const std::string& path, size_t capacity = 1 << 20);
+    // Open $GOMOKU_CACHE, else ../cache/search.cache
+    static bool openDefault();
+    static SearchCache* active();
+    static void closeActive();
+
+    bool probe(uint64_t key, Result& out);
+    void store(uint64_t key, const Result& result);
+    void flush();   // Synchronous flush, e.g. on exit
+    void recordSaved(uint32_t ms) { counters.msSaved += ms; }
+
+    size_t capacity() const { return entryCount; }
+    const Stats& stats() const { return counters; }
+
+private:
+    struct Header;
+    struct Entry;
+
+    Header* header = nullptr;
+    Entry* entries = nullptr;
+    size_t entryCount = 0;
+    size_t mappedBytes = 0;
+    Stats counters;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    // Asynchronous write-back
+    std::thread flusher;
+    std::mutex flushMutex;
+    std::condition_variable flushCv;
+    bool stopping = false;
+    std::atomic<bool> dirty{false};
+
+    SearchCache() = default;
+    bool map(const std::string& path, size_t capacity);
+    void unmap();
+    void flushLoop();
+};
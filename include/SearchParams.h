@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// AIPlayer search parameters. Defaults are the original hand-picked values; a
+// tuned set (gomoku_spsa) can be loaded at startup like EvalWeights. Every
+// parameter is also reachable by name, so the config file and the tuner need
+// no per-field code.
+struct SearchParams {
+    int candidateRadius = 2;        // Empty points within this distance of a stone are move candidates
+    // A difficulty is a node budget plus evaluation noise: the search stops at
+    // the same node whatever the machine, so a level plays the same moves on
+    // any host. gomoku_bench levels measures the gaps; they are not tuned to targets.
+    int nodesEasy = 250;            // Node budget per move per difficulty (0 = time limited)
+    int nodesMedium = 2000;
+    int nodesHard = 150000;
+    int noiseEasy = 60000;          // Leaf evaluations are offset by up to +-noise, fixed per position
+    int noiseMedium = 2000;
+    int noiseHard = 0;
+    int depthEasy = 10;             // Maximum depth per difficulty (at most MAX_DEPTH)
+    int depthMedium = 10;
+    int depthHard = 10;
+    int timeEasyMs = 1000;          // Time limit per move per difficulty when the node budget is 0;
+    int timeMediumMs = 5000;        // the game also stops budgeted moves at 3x (AIPlayer::setBudgetTimeCap)
+    int timeHardMs = 15000;
+    int aspirationWindow = 20000;   // Initial half-width around the previous iteration's score
+    int lmrMinDepth = 3;            // Late move reductions: only at this remaining depth or more,
+    int lmrMinMoves = 4;            // after this many searched moves,
+    int quietThreshold = 1000;      // and for moves whose ordering score is below this
+    int qsMaxPly = 8;               // Quiescence search depth limit
+
+    static const int MAX_DEPTH = 10;
+    static const int MAX_QS_PLY = 16;
+
+    struct ParamInfo {
+        const char* name;           // Config key, e.g. "lmr.min_moves"
+        int SearchParams::*field;
+        int min, max;
+        bool tunable;               // Searched by the tuner by default; limits are not (more is always stronger)
+    };
+    static int count();
+    static const ParamInfo& info(int index);
+    static int find(const std::string& name);   // Index, or -1 if unknown
+    int& operator[](int index) { return this->*info(index).field; }
+    int operator[](int index) const { return this->*info(index).field; }
+
+    // Text file of "name value" lines, e.g. "lmr.min_moves 4"; unknown keys
+    // and values out of range are rejected
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Hash of the parameters that change what a search of a given depth returns
+    uint64_t fingerprint() const;
+
+    static SearchParams& active();
+    // Load $GOMOKU_PARAMS, else ../weights/search.txt; defaults stay in place if neither loads
+    static bool loadDefault();
+};
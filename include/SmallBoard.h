@@ -0,0 +1,80 @@
+#pragma once
+#include "Common.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Compact board for small k-in-a-row variants (3x3 up to 11x11, any run length
+// from 3), the board of the exhaustive solver. Freestyle rules: Black moves
+// first, a run of inRow or more wins, nothing is forbidden.
+//
+// Cells are numbered r * size + c; the stones of each side are a 128-bit
+// bitboard. Every "line" (window of inRow consecutive cells) keeps a stone
+// count per side, updated by play/undo on the lines through the cell, so the
+// solver gets open lines, immediate wins and forced blocks without scanning
+// the board. The position hash is kept for all 8 symmetries at once, which
+// makes the canonical (mirror-independent) key a minimum over 8 words.
+class SmallBoard {
+public:
+    static constexpr int MAX_SIZE = 11;
+    static constexpr int MAX_CELLS = MAX_SIZE * MAX_SIZE;
+    static constexpr int MAX_LINES = 4 * MAX_CELLS;
+
+    SmallBoard(int size = 7, int inRow = 5);
+
+    int size() const;
+    int inRow() const;
+    int cells() const;
+    int stones() const { return stoneCount; }
+    bool isFull() const { return stoneCount == cells(); }
+    Side toMove() const { return (stoneCount & 1) ? Side::White : Side::Black; }
+    Side get(int cell) const;
+    bool isEmpty(int cell) const { return get(cell) == Side::None; }
+
+    // Place a stone for the side to move; true if it completes a run
+    bool play(int cell);
+    // Take back the stone on cell, which must be the last one played
+    void undo(int cell);
+
+    // Lines without a stone of the other side: s can still win along them
+    int openLines(Side s) const { return open[(int)s]; }
+    // Whether s has an open line it can still fill with the moves left to it
+    bool canWin(Side s) const;
+    // Lines where s lacks one stone and the other side has none
+    int nearWins(Side s) const { return near[(int)s]; }
+    // The distinct empty cells where s would complete a run; out holds cells() entries
+    int winningCells(Side s, int* out) const;
+    // On a line still open for either side. Stones elsewhere change nothing.
+    bool live(int cell) const;
+    // Move ordering weight for the side to move: its own lines through the
+    // cell and the opponent lines a stone there would block, longer ones
+    // first. defend ranks blocking far above building.
+    int potential(int cell, bool defend = false) const;
+
+    // Zobrist hash of the stones as seen through symmetry sym (numbered as in
+    // Board::transform); canonicalHash is the smallest of the 8
+    uint64_t hash(int sym = 0) const { return hashes[sym]; }
+    uint64_t canonicalHash(int* sym = nullptr) const;
+    int transform(int cell, int sym) const;
+    int inverseTransform(int cell, int sym) const;
+    // Bit s is set when the stones are unchanged by symmetry s
+    uint8_t symmetries() const;
+
+    std::string cellName(int cell) const;   // "h8" style
+    int parseCell(const std::string& text) const;   // -1 if not a cell of this board
+    std::string toString() const;
+
+    // Lines, symmetry tables and hash keys of one size and run length, shared by its boards
+    struct Geometry;
+
+private:
+    std::shared_ptr<const Geometry> geo;
+    uint64_t bits[2][2] = {};       // Stones per side: cell i is bit i % 64 of word i / 64
+    std::array<uint8_t, MAX_LINES> lineCount[2];
+    int open[2] = {};
+    int near[2] = {};
+    int openByCount[2][MAX_SIZE + 1] = {};     // Open lines of each side by its stone count
+    int stoneCount = 0;
+    uint64_t hashes[8] = {};
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include "SmallBoard.h"
+#include "StopToken.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Exact solver for SmallBoard positions: the game-theoretic value for the
+// side to move (1 win, 0 draw, -1 loss) and a move that keeps it.
+//
+// Two null-window alpha-beta searches ("does the side to move win?", then
+// "does it lose?") with a shared, lock-free hash table keyed by the canonical
+// hash, so the 8 mirror images of a position are solved once. A node is cut
+// without search when the side to move can win at once, must block a single
+// winning cell of the opponent or loses to two of them, or when neither side
+// can still fill an open line with the moves left to it. Cells on no open
+// line are never played (a stone there changes nothing), nor mirror images
+// of an earlier move in symmetric positions. A side that is not yet sure of
+// a draw tries blocking moves first, one who is tries building ones.
+//
+// solveParallel() expands the first plies into a tree of distinct positions
+// and hands its leaves to worker threads, which solve them exactly against
+// the shared table; the values are then backed up the tree. Every leaf is
+// solved in full, so a split costs nodes that alpha-beta would have cut:
+// split only as deep as the threads need. Every position of that tree and
+// every proven table entry can be written as a lookup file.
+class SmallBoardSolver {
+public:
+    struct Stats {
+        long long nodes = 0;
+        long long jobs = 0;             // Tree leaves solved by the workers
+        long long treePositions = 0;    // Distinct positions in the split tree
+        double seconds = 0;
+    };
+
+    // A move from the root position and its value for the side to move
+    struct RootMove {
+        int cell;
+        int value;
+    };
+
+    explicit SmallBoardSolver(size_t tableMegabytes = 64);
+    ~SmallBoardSolver();
+
+    // Exact value of the position; best receives a move that keeps it (-1 if
+    // the game is over). Returns -2 if stopped or past the deadline first.
+    int solve(const SmallBoard& board, int& best, const StopToken& stop = StopToken(),
+              std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    // The same on threads, splitting the search splitPly plies below the
+    // position. progress(jobsDone, jobs, nodes) is called about every 5 s.
+    int solveParallel(const SmallBoard& board, int threads, int splitPly, int& best,
+                      const std::function<void(long long, long long, long long)>& progress = nullptr);
+
+    // Values of the root moves from the last solveParallel(), one per mirror-image class
+    const std::vector<RootMove>& rootMoves() const { return roots; }
+    const Stats& stats() const { return counters; }
+    double tableUsage() const;  // Share of table slots in use
+
+    // Writes the split tree of the last solveParallel() and every proven
+    // table entry as a SolutionBook file; returns the number of positions
+    bool writeBook(const std::string& path, const SmallBoard& board, size_t* written = nullptr) const;
+
+private:
+    class Table;
+    struct Worker;
+    struct TreeNode;
+
+    Table* table;
+    Stats counters;
+    std::vector<RootMove> roots;
+    std::vector<TreeNode> tree;
+
+    int exact(Worker& w, SmallBoard& board, int* best);
+    int search(Worker& w, SmallBoard& board, int alpha, int beta, int* bestOut);
+    int generate(SmallBoard& board, int* moves, int ttMove, bool defend = false) const;
+    void buildTree(const SmallBoard& root, int splitPly);
+};
+
+// Lookup file written by SmallBoardSolver::writeBook: the proven positions of
+// one size and run length, sorted by canonical hash. Loading reads the file
+// into three flat arrays (10 bytes per position); probe() is a binary search.
+//
+// Format, little-endian: "GMKSOLV1", uint8 size, uint8 inRow, 6 reserved
+// bytes, uint64 count, then per position uint64 canonical hash, uint8 best
+// cell in the canonical orientation (255 = none) and int8 value.
+class SolutionBook {
+public:
+    struct Entry {
+        uint64_t key;
+        uint8_t cell;
+        int8_t value;
+    };
+
+    bool load(const std::string& path);
+    static bool write(const std::string& path, int size, int inRow, std::vector<Entry>& entries);
+
+    // The value for the side to move and a best move (-1 if the file has
+    // none, e.g. for lost positions); false if the position is not in the file
+    bool probe(const SmallBoard& board, int& value, int& best) const;
+    bool matches(const SmallBoard& board) const { return board.size() == boardSize && board.inRow() == runLength; }
+    size_t size() const { return keys.size(); }
+
+private:
+    int boardSize = 0;
+    int runLength = 0;
+    std::vector<uint64_t> keys;
+    std::vector<uint8_t> cells;
+    std::vector<int8_t> values;
+};
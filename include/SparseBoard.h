@@ -0,0 +1,134 @@
+#pragma once
+#include "Common.h"
+#include "EvalWeights.h"
+#include <climits>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A cell of the unbounded board. The default value is "no cell".
+struct Cell {
+    int r = INT_MIN, c = INT_MIN;
+
+    constexpr Cell() = default;
+    constexpr Cell(Pos p) : r(p.r), c(p.c) {}
+    static constexpr Cell at(int r, int c) { return Cell(Pos{r, c}); }
+
+    constexpr bool isNone() const { return r == INT_MIN; }
+    constexpr Pos pos() const { return Pos{r, c}; }
+    constexpr bool operator==(Cell other) const { return r == other.r && c == other.c; }
+    constexpr bool operator!=(Cell other) const { return !(*this == other); }
+};
+
+// Board for infinite-board (freestyle) gomoku.
+//
+// Only the stones and the empty cells within 2 of a stone (the move
+// candidates) are stored, in one hash table, next to a list of the stones and
+// their bounding box. Everything the search asks for is kept up to date by
+// set/clear, which only touch the lines through the changed cell:
+// - per candidate, the pattern a stone there would make in each direction
+//   (move ordering) and how close each side is to a five through it (threat
+//   filter);
+// - the evaluator's pattern counts, the same features as evaluateBoard.
+// Memory and the cost of every call grow with the number of stones, never
+// with the area they cover. The query interface mirrors Board so the
+// AIPlayer search can be instantiated on either.
+class SparseBoard {
+public:
+    using MoveType = Cell;
+
+    SparseBoard();
+    void reset();
+
+    // Board-compatible queries: every coordinate is on the board
+    bool isValid(Pos) const { return true; }
+    bool isFull() const { return false; }
+    Side get(Pos p) const;
+    bool isEmpty(Pos p) const { return get(p) == Side::None; }
+    Side get(Cell m) const { return get(m.pos()); }
+    bool isEmpty(Cell m) const { return get(m.pos()) == Side::None; }
+    void set(Cell m, Side s);   // Side::None removes the stone
+    void clear(Cell m) { set(m, Side::None); }
+    int countConsecutive(Pos p, int dr, int dc, Side side) const;
+
+    int stoneCount() const { return (int)stoneList.size(); }
+    const std::vector<Cell>& stones() const { return stoneList; } // Unordered
+    // Bounding box of the stones; all zero on an empty board
+    struct Box { int minR = 0, minC = 0, maxR = 0, maxC = 0; };
+    Box bounds() const;
+    uint64_t hash() const { return zobrist; }
+
+    // Empty cells within 2 of any stone, row by row; only (0, 0) on an empty board
+    void candidates(std::vector<Cell>& out) const;
+    // The best 'limit' candidates for toMove by AIPlayer's move-ordering score
+    // (own patterns weighted by attackFactor, plus the opponent's), best first,
+    // ties row by row; keys receives the scores
+    void orderedCandidates(Side toMove, size_t limit, std::vector<Cell>& moves, std::vector<int>& keys) const;
+    // Candidates where one side has 3 stones in a window of five cells
+    // through the cell with no opposing stone: the only cells where a stone
+    // can make a five or a four (open or not). Row by row.
+    void threatCandidates(std::vector<Cell>& out) const;
+
+    // evaluateBoard's pattern counts and score, read from the running totals
+    void features(Side mySide, int out[PAT_COUNT]) const;
+    long long evaluate(Side mySide) const;
+
+    // Bytes held by the table and the cell lists
+    size_t memoryBytes() const;
+
+private:
+    struct CellInfo {
+        Side side = Side::None;
+        uint8_t nearby = 0;         // Stones within 2 (a candidate when > 0 and empty)
+        uint32_t index = 0;         // Position in stoneList when occupied, else in threatList + 1 (0 = not listed)
+        // Empty cells only, 4 bits per side x direction (bit 4 * (side * 4 + dir)):
+        uint32_t windows = 0;       // Most stones of that side in an unblocked 5-cell window through the cell
+        uint32_t patterns = 0;      // EvalPattern of a stone placed here, NO_PATTERN if none
+    };
+    static const uint32_t NO_PATTERN = 15;
+
+    // Open-addressing map from a packed cell to its CellInfo: linear probing,
+    // backward-shift deletion, grown at half load. Key 0 (the packed "no
+    // cell") marks an empty slot.
+    class CellTable {
+    public:
+        explicit CellTable(size_t capacity = 64);
+        CellInfo* find(uint64_t key);
+        const CellInfo* find(uint64_t key) const;
+        CellInfo& insert(uint64_t key);     // Existing or new entry; invalidates other pointers
+        void erase(uint64_t key);
+        void clear();
+        size_t bytes() const { return slots.capacity() * sizeof(Slot); }
+        template <class F> void forEach(F f) const {
+            for (const auto& s : slots) if (s.key) f(s.key, s.info);
+        }
+
+    private:
+        struct Slot { uint64_t key; CellInfo info; };
+        std::vector<Slot> slots;
+        size_t used = 0;
+        size_t home(uint64_t key) const;
+        void grow();
+    };
+
+    static uint64_t pack(int r, int c) { return (uint64_t)((uint32_t)r ^ 0x80000000u) << 32 | ((uint32_t)c ^ 0x80000000u); }
+    static Cell unpack(uint64_t key) { return Cell::at((int)((uint32_t)(key >> 32) ^ 0x80000000u), (int)((uint32_t)key ^ 0x80000000u)); }
+
+    CellTable cells;
+    std::vector<Cell> stoneList;
+    std::vector<Cell> threatList;   // Empty cells passing the threat filter, unordered
+    mutable Box box;
+    mutable bool boxStale = false;
+    mutable std::vector<std::pair<int, Cell>> scoredScratch;   // orderedCandidates, kept to reuse its capacity
+    uint64_t zobrist = 0;
+    int patternCounts[2][PAT_COUNT];  // Per side: stones x directions in each pattern
+
+    void place(Cell m, Side s);
+    void remove(Cell m);
+    void updateLines(Cell m);
+    void refreshPattern(Cell q, CellInfo& info, int dir) const;
+    void refreshCell(Cell q, CellInfo& info);
+    void setWindows(Cell q, CellInfo& info, uint32_t windows);
+    void unlistThreat(CellInfo& info);
+    void addRuns(Cell m, int dir, int sign);
+};
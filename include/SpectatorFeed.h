@@ -0,0 +1,67 @@
+#pragma once
+#include "Common.h"
+#include "Board.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One published event. Frames are immutable once published and shared by
+// every reader, so fan-out to N spectators costs N pointer copies, not N
+// copies of the data. 'data' is one '\n'-terminated protocol line:
+//   BOARD <seq> <b|w to move> <225 cells of . x o, row by row>
+//   MOVE  <seq> <b|w> <r> <c> <spent ms>
+//   CLOCK <seq> <b|w to move> <step seconds left, -1 for the AI> <game seconds elapsed> <game seconds total>
+//   END   <seq> <black|white|draw> <reason>
+struct SpectatorFrame {
+    enum class Kind : uint8_t { Board, Move, Clock, End };
+    uint64_t seq;
+    Kind kind;
+    std::string data;
+};
+using SpectatorFramePtr = std::shared_ptr<const SpectatorFrame>;
+
+// Single-writer, many-reader feed of a game for spectators.
+//
+// The game loop publishes each event once into a fixed ring of frame
+// pointers; it never waits for readers. Each reader keeps its own cursor and
+// pulls frames at its own pace. A reader that falls more than 'capacity'
+// frames behind skips ahead: it receives the latest BOARD frame and continues
+// from there.
+class SpectatorFeed {
+public:
+    struct Cursor {
+        uint64_t next = 0;
+        bool synced = false;    // New readers start with a BOARD frame
+    };
+
+    explicit SpectatorFeed(size_t capacity = 1024);
+
+    // Writer side (the game loop)
+    void publishBoard(const GameContext& ctx, const Board& board);     // New game, undo, any non-move change
+    void publishMove(const GameContext& ctx, const Board& board, const HistoryEntry& entry);
+    void publishClock(const GameContext& ctx, int stepSecondsLeft);
+    void publishEnd(const Outcome& outcome);
+
+    // Reader side: appends every frame after the cursor and advances it.
+    // Returns the number of frames skipped because the reader fell behind.
+    uint64_t read(Cursor& cursor, std::vector<SpectatorFramePtr>& out) const;
+    uint64_t published() const;
+
+    // Called after every publish, outside the feed lock (e.g. to wake an I/O thread)
+    void setListener(std::function<void()> listener);
+
+private:
+    const size_t capacity;
+    mutable std::mutex mutex;
+    std::vector<SpectatorFramePtr> ring;
+    uint64_t nextSeq = 0;
+    SpectatorFramePtr latestBoard;      // Resync point; may be newer than the ring's BOARD frames
+    std::function<void()> listener;
+
+    // Publishes a frame built from 'body' (the line without tag and seq); a
+    // non-empty snapshot (BOARD body) also replaces the resync point at the same seq
+    void publish(SpectatorFrame::Kind kind, const char* tag, const std::string& body, const std::string& snapshot = "");
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "SpectatorFeed.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Serves a SpectatorFeed to any number of local (UNIX domain socket) readers.
+//
+// One I/O thread polls all spectators. Each one holds a queue of shared frame
+// pointers plus a write offset into the frame at its head, so a frame is
+// formatted once however many spectators read it. A spectator whose socket
+// is full is skipped until it drains; the game loop never waits on it, and
+// the feed resyncs it from the latest BOARD frame if it falls too far behind.
+// Spectators only read; anything they send is discarded.
+// On Windows the socket is a Winsock AF_UNIX socket, which needs Windows 10
+// 1803 or later; start() returns false where it is unavailable.
+class SpectatorServer {
+public:
+    SpectatorServer(SpectatorFeed& feed, const std::string& socketPath);
+    ~SpectatorServer();
+
+    bool start();   // Bind, listen and start the I/O thread
+    void stop();
+
+    size_t spectators() const { return clientCount.load(); }
+    uint64_t framesSkipped() const { return skipped.load(); } // Summed over spectators that fell behind
+
+private:
+#ifdef _WIN32
+    using Socket = std::uintptr_t;     // SOCKET
+#else
+    using Socket = int;
+#endif
+    static constexpr Socket NO_SOCKET = (Socket)-1;
+
+    struct Client {
+        Socket fd = NO_SOCKET;
+        SpectatorFeed::Cursor cursor;
+        std::deque<SpectatorFramePtr> pending;
+        size_t offset = 0;      // Bytes of pending.front() already sent
+    };
+
+    SpectatorFeed& feed;
+    std::string socketPath;
+    Socket listenFd = NO_SOCKET;
+    Socket wake[2] = {NO_SOCKET, NO_SOCKET};   // Connected pair: the I/O thread polls [0], publish writes [1]
+    bool netStarted = false;
+    std::thread io;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> clientCount{0};
+    std::atomic<uint64_t> skipped{0};
+
+    void loop();
+    bool flush(Client& client);   // false when the spectator disconnected
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// Cooperative cancellation for long-running searches.
+//
+// The owner keeps a StopSource and hands token() to the search; the search
+// polls stopRequested(), a single relaxed atomic load, every 64 nodes
+// and unwinds when it returns true. A default-constructed token is
+// never stopped.
+class StopToken {
+public:
+    StopToken() = default;
+    bool stopRequested() const { return flag && flag->load(std::memory_order_relaxed); }
+
+private:
+    friend class StopSource;
+    explicit StopToken(std::shared_ptr<const std::atomic<bool>> flag) : flag(std::move(flag)) {}
+    std::shared_ptr<const std::atomic<bool>> flag;
+};
+
+class StopSource {
+public:
+    StopSource() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+    void requestStop() { flag->store(true, std::memory_order_relaxed); }
+    bool stopRequested() const { return flag->load(std::memory_order_relaxed); }
+    StopToken token() const { return StopToken(flag); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Tracing scopes, compiled in only with -DGOMOKU_TRACE (cmake -DGOMOKU_TRACE=ON).
+//
+//   void f() {
+//       TRACE_SCOPE("ai.eval");
+//       ...
+//   }
+//
+// Each scope records its name, start and duration into a ring buffer owned by
+// the calling thread (no locks, no allocation after the thread's first
+// event). The newest events of every thread are written as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev); per-name totals are kept separately and
+// never overwritten, so the summary covers the whole run. Names must be string
+// literals: they are stored and compared by pointer.
+//
+// Without GOMOKU_TRACE, TRACE_SCOPE expands to nothing and the export
+// functions do nothing.
+namespace trace {
+
+#ifdef GOMOKU_TRACE
+
+uint64_t nowNs();
+void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name(name), start(nowNs()) {}
+    ~Scope() { record(name, start, nowNs()); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+// Write all threads' buffered events; returns false if the file can't be written
+bool writeChromeJson(const std::string& path);
+// Inclusive time, call count and mean per scope name, summed over threads
+void printSummary(std::ostream& out);
+// Drop all events and totals, e.g. to trace a single move
+void reset();
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#else
+
+inline bool writeChromeJson(const std::string&) { return false; }
+inline void printSummary(std::ostream&) {}
+inline void reset() {}
+
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif
+
+constexpr bool enabled() {
+#ifdef GOMOKU_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace trace
@@ -0,0 +1,34 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Bounded pool of worker threads shared by many owners (e.g. game sessions).
+// Tasks are queued per owner and served round-robin across owners, so one
+// busy owner cannot starve the others. submit() refuses work once maxQueued
+// tasks are waiting.
+class WorkerPool {
+public:
+    WorkerPool(int threads, size_t maxQueued);
+    ~WorkerPool();
+
+    bool submit(uint64_t owner, std::function<void()> task);
+    size_t queued() const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::unordered_map<uint64_t, std::deque<std::function<void()>>> queues;
+    std::deque<uint64_t> ready;   // Owners with pending tasks, in service order
+    size_t total = 0;
+    size_t maxQueued;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void workerLoop();
+};
@@ -1,4 +1,10 @@
 #include "include/GameEngine.h"
+#include "include/Nnue.h"
+#include "include/EvalWeights.h"
+#include "include/SearchParams.h"
+#include "include/SearchCache.h"
+#include "include/Trace.h"
+#include <cstdlib>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -15,7 +21,22 @@ int main() {
     SetConsoleOutputCP(CP_UTF8);
 #endif
 
+    // Neural evaluator weights ($GOMOKU_NNUE or ../nnue/gomoku.nnue); hand-tuned evaluation otherwise
+    NnueNetwork::loadDefault();
+    // Tuned evaluation weights ($GOMOKU_WEIGHTS or ../weights/eval.txt); built-in defaults otherwise
+    EvalWeights::loadDefault();
+    // Tuned search parameters ($GOMOKU_PARAMS or ../weights/search.txt); built-in defaults otherwise
+    SearchParams::loadDefault();
+    // Persistent search results ($GOMOKU_CACHE or ../cache/search.cache); searching without it on failure
+    SearchCache::openDefault();
+
     GameEngine engine;
     engine.run();
+    SearchCache::closeActive();
+    // Tracing builds only (-DGOMOKU_TRACE): Chrome trace of the session to $GOMOKU_TRACE_FILE or gomoku_trace.json
+    if (trace::enabled()) {
+        const char* path = std::getenv("GOMOKU_TRACE_FILE");
+        trace::writeChromeJson(path && *path ? path : "gomoku_trace.json");
+    }
     return 0;
 }
@@ -0,0 +1,749 @@
+#include "DistributedSearch.h"
+#include "../include/GomokuRuleSet.h"
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+enum FrameType : uint8_t { Hello = 1, JobFrame = 2, ResultFrame = 3, Cancel = 4, Quit = 5 };
+const uint32_t MAGIC = 0x444B4D47;     // "GMKD" read as little-endian bytes
+const uint16_t VERSION = 2;
+const size_t MAX_FRAME = 4096;          // A job is under 600 bytes
+
+struct Writer {
+    std::string bytes;
+    void u8(uint8_t v) { bytes.push_back((char)v); }
+    void u16(uint16_t v) { for (int i = 0; i < 2; ++i) u8((uint8_t)(v >> (8 * i))); }
+    void u32(uint32_t v) { for (int i = 0; i < 4; ++i) u8((uint8_t)(v >> (8 * i))); }
+    void u64(uint64_t v) { for (int i = 0; i < 8; ++i) u8((uint8_t)(v >> (8 * i))); }
+};
+
+// Reads past the end yield zeros and clear ok
+struct Reader {
+    const std::string& bytes;
+    size_t pos = 0;
+    bool ok = true;
+    explicit Reader(const std::string& bytes) : bytes(bytes) {}
+    uint8_t u8() {
+        if (pos >= bytes.size()) {
+            ok = false;
+            return 0;
+        }
+        return (uint8_t)bytes[pos++];
+    }
+    uint16_t u16() { uint16_t v = u8(); return (uint16_t)(v | u8() << 8); }
+    uint32_t u32() { uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= (uint32_t)u8() << (8 * i); return v; }
+    uint64_t u64() { uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= (uint64_t)u8() << (8 * i); return v; }
+};
+
+std::string frame(FrameType type, const std::string& payload) {
+    Writer w;
+    w.u32((uint32_t)payload.size() + 1);
+    w.u8(type);
+    w.bytes += payload;
+    return w.bytes;
+}
+
+bool sendAll(int fd, const std::string& bytes) {
+    size_t off = 0;
+    while (off < bytes.size()) {
+        ssize_t n = ::send(fd, bytes.data() + off, bytes.size() - off, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// Takes the next complete frame off the front of buffer; bad is set for a
+// length no peer of ours would send
+bool nextFrame(std::string& buffer, uint8_t& type, std::string& payload, bool& bad) {
+    if (buffer.size() < 4) return false;
+    uint32_t length = 0;
+    for (int i = 0; i < 4; ++i) length |= (uint32_t)(uint8_t)buffer[i] << (8 * i);
+    if (length == 0 || length > MAX_FRAME) {
+        bad = true;
+        return false;
+    }
+    if (buffer.size() < 4 + (size_t)length) return false;
+    type = (uint8_t)buffer[4];
+    payload.assign(buffer, 5, length - 1);
+    buffer.erase(0, 4 + (size_t)length);
+    return true;
+}
+
+// "unix:/path", a bare path, or "tcp:host:port" (host empty: any interface when listening)
+bool splitAddress(const std::string& address, bool& isUnix, std::string& host, std::string& port) {
+    if (address.compare(0, 4, "tcp:") == 0) {
+        size_t colon = address.rfind(':');
+        if (colon <= 3) return false;
+        isUnix = false;
+        host = address.substr(4, colon - 4);
+        port = address.substr(colon + 1);
+        return !port.empty();
+    }
+    isUnix = true;
+    host = (address.compare(0, 5, "unix:") == 0) ? address.substr(5) : address;
+    return !host.empty();
+}
+
+int openTcp(const std::string& host, const std::string& port, bool listening) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (listening) hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found) != 0) return -1;
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        bool ok;
+        if (listening) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            ok = bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 64) == 0;
+        } else {
+            ok = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+        }
+        if (!ok) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    return fd;
+}
+
+int openUnix(const std::string& path, bool listening) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    bool ok;
+    if (listening) {
+        unlink(path.c_str());
+        ok = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 && listen(fd, 64) == 0;
+    } else {
+        ok = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct JobSpec {
+    uint32_t id = 0;
+    RuleVariant variant = RuleVariant::Renju;
+    Side toMove = Side::Black;
+    int turnIndex = 0;
+    int depth = 1;
+    long long floor = LLONG_MIN;   // Best score already reached by another job; LLONG_MIN: none
+    std::vector<std::pair<Move, Side>> stones;
+    std::vector<Move> moves;
+};
+
+std::string encodeJob(const JobSpec& job) {
+    Writer w;
+    w.u32(job.id);
+    w.u8((uint8_t)job.variant);
+    w.u8((uint8_t)job.toMove);
+    w.u16((uint16_t)job.turnIndex);
+    w.u8((uint8_t)job.depth);
+    w.u64((uint64_t)job.floor);
+    w.u8((uint8_t)job.stones.size());
+    for (const auto& s : job.stones) {
+        w.u8(s.first.index);
+        w.u8((uint8_t)s.second);
+    }
+    w.u8((uint8_t)job.moves.size());
+    for (Move m : job.moves) w.u8(m.index);
+    return frame(JobFrame, w.bytes);
+}
+
+bool decodeJob(const std::string& payload, JobSpec& job) {
+    Reader r(payload);
+    job.id = r.u32();
+    uint8_t variant = r.u8();
+    uint8_t side = r.u8();
+    job.turnIndex = r.u16();
+    job.depth = r.u8();
+    job.floor = (long long)r.u64();
+    job.stones.resize(r.u8());
+    for (auto& s : job.stones) {
+        s.first = Move::fromIndex(r.u8());
+        s.second = (Side)r.u8();
+        if (s.first.isNone() || s.first.index >= Board::SIZE * Board::SIZE || (uint8_t)s.second > 1) return false;
+    }
+    job.moves.resize(r.u8());
+    for (auto& m : job.moves) {
+        m = Move::fromIndex(r.u8());
+        if (m.isNone() || m.index >= Board::SIZE * Board::SIZE) return false;
+    }
+    if (!r.ok || variant > (uint8_t)RuleVariant::Renju || side > 1 || job.depth < 1) return false;
+    job.variant = (RuleVariant)variant;
+    job.toMove = (Side)side;
+    return true;
+}
+
+long long threadCpuMs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// An answered job, for the critical path: step counts the phases of its position
+struct JobTiming {
+    int task = 0;
+    int step = 0;
+    long long cpuMs = 0;
+};
+
+// Time to run the jobs (of one task, or all with task -1) on 'cores' cores:
+// each in the order it was created, on the core that frees up first, and
+// not before the jobs of the previous phase of its position are done
+long long criticalPath(const std::vector<JobTiming>& jobs, size_t cores, int task) {
+    std::vector<long long> freeAt(std::max<size_t>(1, cores), 0);
+    std::map<std::pair<int, int>, long long> stepEnd;
+    long long end = 0;
+    for (const auto& job : jobs) {
+        if (task >= 0 && job.task != task) continue;
+        auto prev = stepEnd.find({job.task, job.step - 1});
+        long long ready = (prev == stepEnd.end()) ? 0 : prev->second;
+        auto core = std::min_element(freeAt.begin(), freeAt.end());
+        *core = std::max(*core, ready) + job.cpuMs;
+        long long& done = stepEnd[{job.task, job.step}];
+        done = std::max(done, *core);
+        end = std::max(end, *core);
+    }
+    return end;
+}
+
+} // namespace
+
+void DistributedSearch::configurePlayer(AIPlayer& ai, int depth) {
+    ai = AIPlayer(3);
+    ai.setMaxDepth(depth);
+    ai.setTimeLimitMs(600000);
+    ai.setNodeLimit(-1);
+}
+
+DistributedSearch::DistributedSearch(const std::string& address) : address(address) {}
+
+DistributedSearch::~DistributedSearch() {
+    shutdown();
+    if (listenFd >= 0) {
+        close(listenFd);
+        if (!unixPath.empty()) unlink(unixPath.c_str());
+    }
+}
+
+bool DistributedSearch::start() {
+    bool isUnix;
+    std::string host, port;
+    if (!splitAddress(address, isUnix, host, port)) return false;
+    listenFd = isUnix ? openUnix(host, true) : openTcp(host, port, true);
+    if (isUnix && listenFd >= 0) unixPath = host;
+    return listenFd >= 0;
+}
+
+size_t DistributedSearch::workers() const {
+    size_t ready = 0;
+    for (const auto& p : peers) ready += p.ready;
+    return ready;
+}
+
+void DistributedSearch::shutdown() {
+    std::string quit = frame(Quit, std::string());
+    for (auto& p : peers) {
+        sendAll(p.fd, quit);
+        close(p.fd);
+    }
+    peers.clear();
+}
+
+void DistributedSearch::acceptPeers() {
+    while (true) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN)) return;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // Fails harmlessly on UNIX sockets
+        Peer peer;
+        peer.fd = fd;
+        peers.push_back(std::move(peer));
+    }
+}
+
+size_t DistributedSearch::waitForWorkers(size_t count, int timeoutMs) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::vector<Event> events;
+    while (workers() < count && Clock::now() < deadline) pump(20, events);
+    return workers();
+}
+
+void DistributedSearch::drop(size_t index, std::vector<Event>& events) {
+    if (peers[index].job >= 0) {
+        Event lost;
+        lost.job = peers[index].job;
+        lost.lost = true;
+        events.push_back(lost);
+    }
+    close(peers[index].fd);
+    peers.erase(peers.begin() + (ptrdiff_t)index);
+}
+
+bool DistributedSearch::readFrom(Peer& peer, std::vector<Event>& events) {
+    char buf[4096];
+    ssize_t n = recv(peer.fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0) return false;
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    peer.in.append(buf, (size_t)n);
+
+    uint8_t type;
+    std::string payload;
+    bool bad = false;
+    while (nextFrame(peer.in, type, payload, bad)) {
+        Reader r(payload);
+        if (type == Hello) {
+            uint32_t magic = r.u32();
+            uint16_t version = r.u16();
+            peer.pid = r.u32();
+            if (!r.ok || magic != MAGIC || version != VERSION) return false;
+            peer.ready = true;
+        } else if (type == ResultFrame && peer.ready) {
+            Event e;
+            e.job = r.u32();
+            e.move = Move::fromIndex(r.u8());
+            e.depth = r.u8();
+            e.solved = r.u8() != 0;
+            e.score = (long long)r.u64();
+            e.nodes = (long long)r.u64();
+            e.cpuMs = r.u32();
+            if (!r.ok || e.job != peer.job) return false;
+            peer.job = -1;
+            events.push_back(e);
+        } else {
+            return false;
+        }
+    }
+    return !bad;
+}
+
+void DistributedSearch::pump(int timeoutMs, std::vector<Event>& events) {
+    std::vector<pollfd> fds;
+    fds.push_back({listenFd, POLLIN, 0});
+    for (const auto& p : peers) fds.push_back({p.fd, POLLIN, 0});
+    if (poll(fds.data(), fds.size(), timeoutMs) <= 0) return;
+
+    // Back to front, so dropping a peer leaves the indices still to visit valid
+    for (size_t i = fds.size() - 1; i >= 1; --i) {
+        if (!fds[i].revents) continue;
+        bool alive = !(fds[i].revents & (POLLERR | POLLNVAL));
+        if (alive) alive = readFrom(peers[i - 1], events);
+        if (!alive) drop(i - 1, events);
+    }
+    if (fds[0].revents & POLLIN) acceptPeers();
+}
+
+DistributedSearch::Result DistributedSearch::search(const GameContext& ctx, const Board& board, const RuleSet& rules, int depth) {
+    Task task;
+    task.ctx = ctx;
+    task.board = board;
+    task.rules = &rules;
+    task.depth = depth;
+    return searchAll({task}).results[0];
+}
+
+DistributedSearch::Batch DistributedSearch::searchAll(const std::vector<Task>& tasks) {
+    auto start = Clock::now();
+    Batch batch;
+    batch.results.resize(tasks.size());
+    AIPlayer local;
+    configurePlayer(local, 1);
+    local.setFinalDepthOnly(true);
+
+    // Per position, the iteration in progress: phase 0 searches the move
+    // ordered first alone, phase 1 the others, split over the workers with
+    // its score as the floor. Without that floor they would be searched
+    // with a full window, for several times the nodes.
+    struct TaskState {
+        JobSpec base;
+        std::vector<Move> moves;    // Best of the last iteration first
+        int depth = 1;
+        int phase = 0;
+        int step = 0;               // Phases started, for the critical path
+        int open = 0;               // Jobs of the phase not answered yet
+        bool haveBest = false;
+        Move best;
+        long long score = 0;
+        bool solved = false;
+        long long slowestMs[2] = {0, 0};    // Per phase, in this iteration and the last
+        long long lastSlowestMs[2] = {0, 0};
+    };
+    struct JobState {
+        JobSpec spec;
+        int task = 0;
+        int phase = 0;
+        int step = 0;
+        bool done = false;
+        int copies = 0;
+        Clock::time_point firstSent;
+        long long cpuMs = 0;
+    };
+    std::vector<TaskState> states(tasks.size());
+    std::vector<JobState> jobs;
+    std::deque<int> queue;
+    const uint32_t firstId = nextJobId;
+    const size_t startWorkers = workers();
+    size_t finished = 0;
+
+    auto addJob = [&](int t, std::vector<Move> moves, long long floor) {
+        TaskState& st = states[t];
+        JobState job;
+        job.spec = st.base;
+        job.spec.id = nextJobId++;
+        job.spec.depth = st.depth;
+        job.spec.floor = floor;
+        job.spec.moves = std::move(moves);
+        job.task = t;
+        job.phase = st.phase;
+        job.step = st.step;
+        jobs.push_back(std::move(job));
+        queue.push_back((int)jobs.size() - 1);
+        st.open++;
+        batch.results[t].jobs++;
+    };
+    auto startPhase = [&](int t) {
+        TaskState& st = states[t];
+        st.step++;
+        if (st.phase == 0) {
+            addJob(t, {st.moves[0]}, LLONG_MIN);
+            return;
+        }
+        size_t count = std::min(st.moves.size() - 1, std::max<size_t>(1, startWorkers) * (size_t)jobsPerWorker);
+        std::vector<std::vector<Move>> split(count);
+        for (size_t i = 1; i < st.moves.size(); ++i) split[(i - 1) % count].push_back(st.moves[i]);
+        for (auto& moves : split) addJob(t, std::move(moves), st.haveBest ? st.score : LLONG_MIN);
+    };
+    // Called when the last job of a phase is in: the next phase or iteration, or the result
+    auto advance = [&](int t) {
+        TaskState& st = states[t];
+        if (st.phase == 0 && st.moves.size() > 1) {
+            st.phase = 1;
+            startPhase(t);
+            return;
+        }
+        Result& result = batch.results[t];
+        if (st.haveBest) {
+            auto it = std::find(st.moves.begin(), st.moves.end(), st.best);
+            std::rotate(st.moves.begin(), it, it + 1);
+            result.move = st.best;
+            result.score = st.score;
+            result.depth = st.solved ? tasks[t].depth : st.depth;
+        }
+        if (!st.haveBest || st.solved || st.depth >= tasks[t].depth) {
+            result.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+            finished++;
+            return;
+        }
+        st.depth++;
+        st.phase = 0;
+        st.haveBest = false;
+        for (int p = 0; p < 2; ++p) {
+            st.lastSlowestMs[p] = st.slowestMs[p];
+            st.slowestMs[p] = 0;
+        }
+        startPhase(t);
+    };
+
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        TaskState& st = states[t];
+        st.base.variant = tasks[t].rules->variant();
+        st.base.toMove = tasks[t].ctx.toMove;
+        st.base.turnIndex = tasks[t].ctx.turnIndex;
+        for (int i = 0; i < Board::SIZE * Board::SIZE; ++i) {
+            Side s = tasks[t].board.get(Move::fromIndex(i));
+            if (s != Side::None) st.base.stones.push_back({Move::fromIndex(i), s});
+        }
+        st.moves = local.rootMoves(tasks[t].ctx, tasks[t].board);
+        if (st.moves.empty()) {
+            finished++;
+            continue;
+        }
+        startPhase((int)t);
+    }
+
+    // A score at or below the job's floor is only a bound: it never wins a
+    // tie. Among the others a tie goes to the move ordered first, as in one search.
+    auto accept = [&](int j, Move move, long long score, bool solved, long long nodes, long long cpuMs) {
+        JobState& job = jobs[j];
+        TaskState& st = states[job.task];
+        int t = job.task;
+        job.done = true;
+        job.cpuMs = cpuMs;
+        batch.results[t].nodes += nodes;
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - job.firstSent).count();
+        st.slowestMs[job.phase] = std::max(st.slowestMs[job.phase], ms);
+        if (!move.isNone()) {
+            auto rank = [&](Move m) { return std::find(st.moves.begin(), st.moves.end(), m) - st.moves.begin(); };
+            bool tieWin = st.haveBest && score == st.score && score > job.spec.floor && rank(move) < rank(st.best);
+            if (!st.haveBest || score > st.score || tieWin) {
+                st.haveBest = true;
+                st.best = move;
+                st.score = score;
+                st.solved = solved;
+            }
+        }
+        if (--st.open == 0) advance(t);     // May add jobs: job is not used after this
+    };
+    auto searchLocally = [&](int j) {
+        if (jobs[j].copies == 0) jobs[j].firstSent = Clock::now();
+        const JobSpec spec = jobs[j].spec;
+        const Task& task = tasks[jobs[j].task];
+        local.setMaxDepth(spec.depth);
+        local.setRootMoves(spec.moves);
+        local.setRootFloor(spec.floor != LLONG_MIN ? std::optional<long long>(spec.floor) : std::nullopt);
+        long long cpuStart = threadCpuMs();
+        Action action = local.getAction(task.ctx, task.board, *task.rules);
+        long long cpuMs = threadCpuMs() - cpuStart;
+        batch.results[jobs[j].task].local++;
+        const auto& stats = local.lastStats();
+        accept(j, action.type == ActionType::Place ? action.move : Move(), stats.score, stats.solved, stats.nodes, cpuMs);
+    };
+    auto send = [&](Peer& peer, int j) {
+        peer.job = jobs[j].spec.id;
+        peer.sent = Clock::now();
+        if (jobs[j].copies++ == 0) jobs[j].firstSent = peer.sent;
+        return sendAll(peer.fd, encodeJob(jobs[j].spec));
+    };
+    auto cancelCopies = [&](long long id) {
+        Writer w;
+        w.u32((uint32_t)id);
+        std::string cancel = frame(Cancel, w.bytes);
+        for (auto& peer : peers) {
+            if (peer.job == id) sendAll(peer.fd, cancel);
+        }
+    };
+
+    std::vector<Event> events;
+    while (finished < tasks.size()) {
+        // Idle workers take queued jobs, then copies of the oldest slow one
+        for (auto& peer : peers) {
+            if (!peer.ready || peer.job >= 0) continue;
+            int job = -1;
+            if (!queue.empty()) {
+                job = queue.front();
+                queue.pop_front();
+            } else {
+                auto now = Clock::now();
+                for (size_t j = 0; j < jobs.size(); ++j) {
+                    if (jobs[j].done || jobs[j].copies != 1) continue;
+                    long long slowMs = 4 * states[jobs[j].task].lastSlowestMs[jobs[j].phase] + 500;
+                    if (now - jobs[j].firstSent <= std::chrono::milliseconds(slowMs)) continue;
+                    if (job < 0 || jobs[j].firstSent < jobs[job].firstSent) job = (int)j;
+                }
+                if (job >= 0) batch.results[jobs[job].task].reissued++;
+            }
+            if (job >= 0) send(peer, job);     // A failed send shows up as a hangup below
+        }
+
+        if (workers() == 0 && !queue.empty()) {
+            int job = queue.front();
+            queue.pop_front();
+            searchLocally(job);
+            continue;
+        }
+
+        events.clear();
+        pump(20, events);
+        for (const Event& e : events) {
+            long long j = e.job - firstId;
+            if (e.job < firstId || j >= (long long)jobs.size()) continue;     // Left over from an earlier search
+            int job = (int)j;
+            jobs[job].copies--;
+            if (jobs[job].done) continue;
+            if (!e.lost && e.depth > 0) {
+                cancelCopies(e.job);
+                accept(job, e.move, e.score, e.solved, e.nodes, e.cpuMs);
+            } else {
+                if (e.lost) batch.results[jobs[job].task].lost++;
+                if (jobs[job].copies == 0 && std::find(queue.begin(), queue.end(), job) == queue.end()) queue.push_front(job);
+            }
+        }
+
+        // Nobody left to take a stalled job: the coordinator searches it
+        auto now = Clock::now();
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            if (!jobs[j].done && jobs[j].copies > 0 && now - jobs[j].firstSent > std::chrono::milliseconds(stallMs)) {
+                long long id = jobs[j].spec.id;
+                searchLocally((int)j);
+                cancelCopies(id);
+                break;
+            }
+        }
+    }
+
+    std::vector<JobTiming> timings;
+    for (const auto& job : jobs) {
+        if (job.done) timings.push_back({job.task, job.step, job.cpuMs});
+    }
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        Result& result = batch.results[t];
+        for (const auto& job : timings) result.cpuMs += (job.task == (int)t) ? job.cpuMs : 0;
+        result.pathCpuMs = criticalPath(timings, startWorkers, (int)t);
+        batch.cpuMs += result.cpuMs;
+    }
+    batch.pathCpuMs = criticalPath(timings, startWorkers, -1);
+    batch.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    return batch;
+}
+
+int runSearchWorker(const std::string& address) {
+    bool isUnix;
+    std::string host, port;
+    if (!splitAddress(address, isUnix, host, port)) return 1;
+    int fd = isUnix ? openUnix(host, false) : openTcp(host, port, false);
+    if (fd < 0) return 1;
+
+    Writer hello;
+    hello.u32(MAGIC);
+    hello.u16(VERSION);
+    hello.u32((uint32_t)getpid());
+    if (!sendAll(fd, frame(Hello, hello.bytes))) {
+        close(fd);
+        return 1;
+    }
+
+    FreestyleRuleSet freestyle;
+    StandardRuleSet standard;
+    GomokuRuleSet renju;
+    int wake[2];
+    if (pipe(wake) < 0) {
+        close(fd);
+        return 1;
+    }
+
+    // One job at a time on a search thread; this thread keeps reading, so a
+    // CANCEL or QUIT stops the search at once. The player and its settings
+    // last for the whole connection; a job only sets its depth, moves and floor.
+    AIPlayer ai;
+    DistributedSearch::configurePlayer(ai, 1);
+    ai.setFinalDepthOnly(true);
+    std::thread searcher;
+    StopSource stop;
+    uint32_t runningJob = 0;
+    bool running = false;
+    std::mutex resultMutex;
+    std::string resultFrame;
+    auto finish = [&]() {
+        if (!running) return;
+        stop.requestStop();
+        searcher.join();
+        running = false;
+    };
+
+    std::string in;
+    bool quit = false;
+    while (!quit) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            char c;
+            (void)!read(wake[0], &c, 1);
+            searcher.join();
+            running = false;
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (!sendAll(fd, resultFrame)) break;
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        char buf[4096];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;     // The coordinator went away
+        in.append(buf, (size_t)n);
+
+        uint8_t type;
+        std::string payload;
+        bool bad = false;
+        while (!quit && nextFrame(in, type, payload, bad)) {
+            if (type == JobFrame) {
+                JobSpec job;
+                if (!decodeJob(payload, job) || running) {
+                    quit = true;
+                    break;
+                }
+                runningJob = job.id;
+                running = true;
+                stop = StopSource();
+                searcher = std::thread([&, job, token = stop.token()]() {
+                    long long cpuStart = threadCpuMs();
+                    Board board;
+                    for (const auto& s : job.stones) board.set(s.first, s.second);
+                    GameContext ctx;
+                    ctx.toMove = job.toMove;
+                    ctx.turnIndex = job.turnIndex;
+                    const RuleSet& rules = (job.variant == RuleVariant::Freestyle) ? (const RuleSet&)freestyle
+                                         : (job.variant == RuleVariant::Standard) ? (const RuleSet&)standard : (const RuleSet&)renju;
+                    ai.setMaxDepth(job.depth);
+                    ai.setRootMoves(job.moves);
+                    ai.setRootFloor(job.floor != LLONG_MIN ? std::optional<long long>(job.floor) : std::nullopt);
+                    Action action = ai.getAction(ctx, board, rules, token);
+                    const auto& stats = ai.lastStats();
+
+                    Writer w;
+                    w.u32(job.id);
+                    w.u8(action.type == ActionType::Place ? action.move.index : Move::NONE);
+                    w.u8((uint8_t)(token.stopRequested() || stats.depth == 0 ? 0 : job.depth));
+                    w.u8(stats.solved ? 1 : 0);
+                    w.u64((uint64_t)stats.score);
+                    w.u64((uint64_t)stats.nodes);
+                    w.u32((uint32_t)(threadCpuMs() - cpuStart));
+                    {
+                        std::lock_guard<std::mutex> lock(resultMutex);
+                        resultFrame = frame(ResultFrame, w.bytes);
+                    }
+                    char c = 1;
+                    (void)!write(wake[1], &c, 1);
+                });
+            } else if (type == Cancel) {
+                Reader r(payload);
+                if (running && r.u32() == runningJob) stop.requestStop();
+            } else {
+                quit = true;    // QUIT, or a frame we do not know
+            }
+        }
+        if (bad) break;
+    }
+
+    finish();
+    close(wake[0]);
+    close(wake[1]);
+    close(fd);
+    return 0;
+}
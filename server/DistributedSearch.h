@@ -0,0 +1,144 @@
+#pragma once
+#include "../include/AIPlayer.h"
+#include "../include/Board.h"
+#include "../include/RuleSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Splits fixed-depth AIPlayer searches across worker processes on this host
+// or others, over a UNIX or TCP socket.
+//
+// The coordinator listens on an address ("unix:/path" or "tcp:host:port",
+// host empty for all interfaces); workers (runSearchWorker) connect to it,
+// so a host joins by dialling in. The coordinator runs the iterative
+// deepening itself. Each iteration of a position searches the move ordered
+// first (the last iteration's best) on one worker. Then it deals the other
+// moves round-robin into jobsPerWorker jobs per worker, with that score as
+// the floor (AIPlayer::setRootFloor). A job searches only the iteration's
+// depth (AIPlayer::setFinalDepthOnly), so no worker repeats the shallow
+// iterations, and the best move goes first in the next iteration. Ties go
+// to the move ordered first, as in one search, so the result is the
+// in-process one.
+//
+// Within one position the first move of every iteration runs alone, which
+// bounds the speed-up of a single search (1.5-1.7x on 2-4 workers at depth 6
+// in gomoku_dsearch bench). searchAll() takes many positions at once and
+// hands any idle worker the next job of any of them, so the workers stay
+// busy while a position waits on its first move.
+//
+// Slow and dead workers: the job of a worker that disconnects goes back to
+// the queue. An idle worker with nothing queued also gets a copy of the
+// oldest job that has run more than 4 times as long as the slowest job of
+// its kind in the position's previous iteration, plus half a second; the
+// first answer wins and the other copy is cancelled. A job unanswered after
+// stallMs, or any job when no worker is left, is searched by the
+// coordinator itself, so a search always completes.
+//
+// Protocol: frames of uint32 length (type and payload), uint8 type, payload;
+// integers little-endian, cells as Move::index.
+//   worker HELLO   uint32 magic "GMKD", uint16 version, uint32 pid
+//   coord  JOB     uint32 job, uint8 variant, uint8 side to move, uint16 turn index, uint8 depth,
+//                  int64 floor (INT64_MIN: none), uint8 stones, stones x (uint8 cell, uint8 side),
+//                  uint8 moves, moves x uint8 cell (searched in this order, at this depth only)
+//   worker RESULT  uint32 job, uint8 best cell, uint8 depth (0 if stopped), uint8 proven win or loss,
+//                  int64 score, uint64 nodes, uint32 CPU ms
+//   coord  CANCEL  uint32 job (the worker answers with depth 0)
+//   coord  QUIT
+class DistributedSearch {
+public:
+    struct Result {
+        Move move;
+        long long score = 0;
+        int depth = 0;              // Last completed iteration (a proven result counts as full); 0: no move
+        long long nodes = 0;        // Summed over the accepted job results
+        long long elapsedMs = 0;    // Until this position finished
+        // Search CPU time of the accepted job results. pathCpuMs is the jobs
+        // scheduled on one core per worker, each once the phase before it is
+        // done: the wall time to expect with a core per worker.
+        long long cpuMs = 0;
+        long long pathCpuMs = 0;
+        int jobs = 0;
+        int reissued = 0;           // Copies of running jobs given to idle workers
+        int lost = 0;               // Jobs whose worker disconnected
+        int local = 0;              // Jobs the coordinator searched itself
+    };
+
+    struct Task {
+        GameContext ctx;
+        Board board;
+        const RuleSet* rules = nullptr;
+        int depth = 1;
+    };
+
+    // Results in task order; cpuMs and pathCpuMs as in Result, for all the
+    // positions sharing the workers
+    struct Batch {
+        std::vector<Result> results;
+        long long elapsedMs = 0;
+        long long cpuMs = 0;
+        long long pathCpuMs = 0;
+    };
+
+    explicit DistributedSearch(const std::string& address);
+    ~DistributedSearch();
+
+    bool start();   // Bind and listen
+    // Accepts workers until count of them said HELLO; returns how many did
+    size_t waitForWorkers(size_t count, int timeoutMs);
+    size_t workers() const;     // Connected workers that said HELLO
+    // Tells every worker to exit and drops it
+    void shutdown();
+
+    Result search(const GameContext& ctx, const Board& board, const RuleSet& rules, int depth);
+    Batch searchAll(const std::vector<Task>& tasks);
+
+    void setJobsPerWorker(int jobs) { jobsPerWorker = std::max(1, jobs); }
+    void setStallMs(int ms) { stallMs = ms; }
+
+    // The fixed-depth settings every participant searches with
+    static void configurePlayer(AIPlayer& ai, int depth);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Peer {
+        int fd = -1;
+        bool ready = false;     // Sent a valid HELLO
+        uint32_t pid = 0;
+        std::string in;
+        long long job = -1;     // Running job id, -1 when idle
+        Clock::time_point sent;
+    };
+
+    // What pump() saw: a job result from a peer, or a peer that went away
+    struct Event {
+        long long job = -1;
+        bool lost = false;
+        Move move;
+        int depth = 0;
+        long long score = 0;
+        long long nodes = 0;
+        long long cpuMs = 0;
+        bool solved = false;
+    };
+
+    std::string address;
+    std::string unixPath;
+    int listenFd = -1;
+    std::vector<Peer> peers;
+    uint32_t nextJobId = 0;     // Unique across searches: a stalled worker may answer late
+    int jobsPerWorker = 1;
+    int stallMs = 60000;
+
+    void acceptPeers();
+    void pump(int timeoutMs, std::vector<Event>& events);
+    bool readFrom(Peer& peer, std::vector<Event>& events);
+    void drop(size_t index, std::vector<Event>& events);
+};
+
+// Worker side: connects to a coordinator and serves jobs until it says QUIT
+// or goes away. Returns 0 then, 1 if it could not connect.
+int runSearchWorker(const std::string& address);
@@ -0,0 +1,338 @@
+#include "GameServer.h"
+#include "../include/GomokuRuleSet.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const int SPARSE_LIMIT = 1000000;    // Infinite board: largest |row| or |column| accepted
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+GameServer::GameServer(const std::string& socketPath, int workerThreads, size_t maxQueued)
+    : socketPath(socketPath), rules(std::make_shared<GomokuRuleSet>()), pool(workerThreads, maxQueued) {}
+
+GameServer::~GameServer() {
+    for (auto& entry : connections) close(entry.first);
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (wakePipe[0] >= 0) {
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+    }
+}
+
+bool GameServer::start() {
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return false;
+    if (listen(listenFd, 1024) < 0) return false;
+    setNonBlocking(listenFd);
+
+    if (pipe(wakePipe) < 0) return false;
+    setNonBlocking(wakePipe[0]);
+    setNonBlocking(wakePipe[1]);
+    running = true;
+    return true;
+}
+
+void GameServer::stop() {
+    running = false;
+    char c = 0;
+    (void)!write(wakePipe[1], &c, 1);
+}
+
+void GameServer::run() {
+    std::vector<pollfd> fds;
+    while (running) {
+        fds.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wakePipe[0], POLLIN, 0});
+        for (auto& entry : connections) {
+            short events = POLLIN;
+            {
+                std::lock_guard<std::mutex> lock(entry.second->outMutex);
+                if (!entry.second->out.empty()) events |= POLLOUT;
+            }
+            fds.push_back({entry.first, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), 1000) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char buf[256];
+            while (read(wakePipe[0], buf, sizeof(buf)) > 0) {}
+        }
+        if (fds[0].revents & POLLIN) acceptClients();
+
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (!fds[i].revents) continue;
+            auto it = connections.find(fds[i].fd);
+            if (it == connections.end()) continue;
+            auto conn = it->second;
+            bool alive = true;
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) alive = false;
+            if (alive && (fds[i].revents & POLLIN)) alive = readFrom(conn);
+            if (alive && (fds[i].revents & POLLOUT)) alive = flush(conn);
+            if (!alive) closeConnection(fds[i].fd);
+        }
+    }
+}
+
+void GameServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        setNonBlocking(fd);
+        auto conn = std::make_shared<Connection>();
+        conn->fd = fd;
+        connections[fd] = conn;
+    }
+}
+
+bool GameServer::readFrom(const std::shared_ptr<Connection>& conn) {
+    char buf[4096];
+    while (true) {
+        ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        conn->in.append(buf, n);
+    }
+
+    size_t start = 0, nl;
+    while ((nl = conn->in.find('\n', start)) != std::string::npos) {
+        handleLine(conn, conn->in.substr(start, nl - start));
+        start = nl + 1;
+    }
+    conn->in.erase(0, start);
+    return flush(conn);
+}
+
+bool GameServer::flush(const std::shared_ptr<Connection>& conn) {
+    std::lock_guard<std::mutex> lock(conn->outMutex);
+    while (!conn->out.empty()) {
+        ssize_t n = ::send(conn->fd, conn->out.data(), conn->out.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        conn->out.erase(0, n);
+    }
+    return true;
+}
+
+void GameServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) return;
+    for (uint64_t sid : it->second->sessions) {
+        auto s = sessions.find(sid);
+        if (s == sessions.end()) continue;
+        std::lock_guard<std::mutex> lock(s->second->mutex);
+        s->second->closed = true;
+        s->second->stop.requestStop();
+        sessions.erase(s);
+        sessionsAlive--;
+    }
+    close(fd);
+    connections.erase(it);
+}
+
+void GameServer::send(const std::shared_ptr<Connection>& conn, const std::string& line) {
+    {
+        std::lock_guard<std::mutex> lock(conn->outMutex);
+        conn->out += line;
+        conn->out += '\n';
+    }
+    char c = 0;
+    (void)!write(wakePipe[1], &c, 1); // Wake the I/O thread to flush
+}
+
+std::string GameServer::endLine(uint64_t sid, const Outcome& outcome) {
+    std::string winner = "draw";
+    if (outcome.winner.has_value()) winner = (*outcome.winner == Side::Black) ? "black" : "white";
+    return "END " + std::to_string(sid) + " " + winner + " " + outcome.reason;
+}
+
+void GameServer::handleLine(const std::shared_ptr<Connection>& conn, const std::string& line) {
+    std::istringstream iss(line);
+    std::string cmd;
+    iss >> cmd;
+
+    if (cmd == "NEW") {
+        std::string tag, variant;
+        int difficulty = 1;
+        iss >> tag >> difficulty;
+        if (!iss || difficulty < 1 || difficulty > 3) {
+            send(conn, "ERR " + tag + " difficulty must be 1, 2 or 3");
+            return;
+        }
+        if (iss >> variant && variant != "infinite") {
+            send(conn, "ERR " + tag + " unknown variant " + variant);
+            return;
+        }
+        auto session = std::make_shared<HostedSession>(rules, difficulty);
+        if (variant == "infinite") {
+            session->infinite = true;
+            session->sparse.set(Cell::at(0, 0), Side::Black);
+        }
+        session->id = nextSessionId++;
+        session->conn = conn;
+        sessions[session->id] = session;
+        conn->sessions.push_back(session->id);
+        sessionsAlive++;
+        send(conn, "OK " + tag + " " + std::to_string(session->id));
+        // Black's first stone is already on the board: the AI (White) moves first
+        scheduleAI(session);
+        return;
+    }
+
+    uint64_t sid = 0;
+    iss >> sid;
+    auto it = sessions.find(sid);
+    if (it == sessions.end()) {
+        send(conn, "ERR " + std::to_string(sid) + " unknown session");
+        return;
+    }
+    auto session = it->second;
+
+    if (cmd == "QUIT") {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->closed = true;
+        session->stop.requestStop();
+        sessions.erase(it);
+        sessionsAlive--;
+        return;
+    }
+
+    if (cmd == "MOVE") {
+        int r = -1, c = -1;
+        iss >> r >> c;
+        std::unique_lock<std::mutex> lock(session->mutex);
+        if (session->thinking || session->toMove() == session->aiSide) {
+            send(conn, "ERR " + std::to_string(sid) + " not your turn");
+            // An AI turn refused earlier by a full pool is retried here
+            if (!session->thinking && !session->finished()) {
+                lock.unlock();
+                scheduleAI(session);
+            }
+            return;
+        }
+        if (session->infinite) {
+            Outcome outcome;
+            if (!iss || session->sparseOver || std::abs(r) > SPARSE_LIMIT || std::abs(c) > SPARSE_LIMIT ||
+                !session->sparse.isEmpty(Cell::at(r, c))) {
+                send(conn, "ERR " + std::to_string(sid) + (session->sparseOver ? " game is over" : " invalid move"));
+                return;
+            }
+            if (playSparse(*session, Cell::at(r, c), outcome)) {
+                send(conn, endLine(sid, outcome));
+                return;
+            }
+            lock.unlock();
+            scheduleAI(session);
+            return;
+        }
+        Action action{ActionType::Place, Move::at(r, c), 0};
+        GameSession::MoveResult result = session->game.submit(action);
+        if (!result.applied) {
+            send(conn, "ERR " + std::to_string(sid) + " " + result.message);
+            return;
+        }
+        if (session->game.finished()) {
+            send(conn, endLine(sid, result.outcome));
+            return;
+        }
+    } else {
+        send(conn, "ERR " + std::to_string(sid) + " unknown command");
+        return;
+    }
+    scheduleAI(session);
+}
+
+bool GameServer::playSparse(HostedSession& session, Cell cell, Outcome& outcome) {
+    Side side = session.sparseToMove;
+    session.sparse.set(cell, side);
+    session.sparseToMove = (side == Side::Black) ? Side::White : Side::Black;
+    static const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        int count = 1 + session.sparse.countConsecutive(cell.pos(), d[0], d[1], side) +
+                    session.sparse.countConsecutive(cell.pos(), -d[0], -d[1], side);
+        if (!FreestylePolicy::isWinningRun(count, side)) continue;
+        session.sparseOver = true;
+        outcome.status = GameStatus::Win;
+        outcome.winner = side;
+        outcome.reason = std::string(side == Side::Black ? "黑方" : "白方") + (count > 5 ? "长连" : "五连");
+        return true;
+    }
+    return false;
+}
+
+void GameServer::scheduleAI(const std::shared_ptr<HostedSession>& session) {
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->thinking = true;
+    }
+    bool queued = pool.submit(session->id, [this, session]() {
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->closed) return;
+        }
+        // The game state does not change while 'thinking' is set, so the search runs unlocked
+        if (session->infinite) {
+            Cell cell = session->ai.getSparseMove(session->sparse, session->aiSide, session->stop.token());
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->thinking = false;
+            auto conn = session->conn.lock();
+            if (session->closed || !conn) return;
+            Outcome outcome;
+            bool over = playSparse(*session, cell, outcome);
+            send(conn, "AI " + std::to_string(session->id) + " " + std::to_string(cell.r) + " " + std::to_string(cell.c));
+            if (over) send(conn, endLine(session->id, outcome));
+            return;
+        }
+        Action action = session->ai.getAction(session->game.getContext(), session->game.getBoard(), session->game.getRules(), session->stop.token());
+
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->thinking = false;
+        if (session->closed || action.type == ActionType::Cancelled) return;
+        auto conn = session->conn.lock();
+        if (!conn) return;
+
+        GameSession::MoveResult result = session->game.submit(action);
+        if (!result.applied) {
+            send(conn, "ERR " + std::to_string(session->id) + " AI move rejected: " + result.message);
+            return;
+        }
+        send(conn, "AI " + std::to_string(session->id) + " " + std::to_string(action.move.row()) + " " + std::to_string(action.move.col()));
+        if (session->game.finished()) send(conn, endLine(session->id, result.outcome));
+    });
+
+    if (!queued) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->thinking = false;
+        if (auto conn = session->conn.lock()) send(conn, "ERR " + std::to_string(session->id) + " server busy");
+    }
+}
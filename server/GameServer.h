@@ -0,0 +1,92 @@
+#pragma once
+#include "../include/GameSession.h"
+#include "../include/AIPlayer.h"
+#include "../include/WorkerPool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hosts many concurrent games over a local (UNIX domain) socket.
+//
+// One I/O thread multiplexes all connections with poll(); AI moves of all
+// sessions run on one shared WorkerPool with per-session round-robin.
+// Line protocol (coordinates are 0-based row/column):
+//   client: NEW <tag> <difficulty> [infinite]
+//                                       -> OK <tag> <sid>   (client plays Black; difficulty 1-3)
+//                                          or ERR <tag> <reason>
+//           MOVE <sid> <r> <c>          -> AI <sid> <r> <c> or ERR <sid> <reason>
+//           QUIT <sid>
+//   server: END <sid> <black|white|draw> <reason> when a game finishes
+// The default game is Renju on 15x15, opened by Black's automatic Tengen.
+// 'infinite' plays freestyle (five or more wins) on an unbounded board
+// instead: Black's first stone is at 0 0, coordinates may be negative (up
+// to +-1000000), and the game only ends on a five or QUIT.
+class GameServer {
+public:
+    GameServer(const std::string& socketPath, int workerThreads, size_t maxQueued);
+    ~GameServer();
+
+    bool start();   // Bind and listen
+    void run();     // I/O loop until stop()
+    void stop();
+
+    size_t sessionCount() const { return sessionsAlive.load(); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::mutex outMutex;
+        std::string out;
+        std::vector<uint64_t> sessions;
+    };
+
+    struct HostedSession {
+        uint64_t id = 0;
+        std::mutex mutex;
+        GameSession game;
+        // Infinite-board sessions keep their stones here and leave 'game' unused
+        bool infinite = false;
+        SparseBoard sparse;
+        Side sparseToMove = Side::White;
+        bool sparseOver = false;
+        AIPlayer ai;
+        Side aiSide = Side::White;
+        bool thinking = false;
+        bool closed = false;
+        StopSource stop;        // Stops an in-flight search when the session closes
+        std::weak_ptr<Connection> conn;
+
+        HostedSession(std::shared_ptr<const RuleSet> rules, int difficulty) : game(std::move(rules)), ai(difficulty) {}
+
+        Side toMove() const { return infinite ? sparseToMove : game.getContext().toMove; }
+        bool finished() const { return infinite ? sparseOver : game.finished(); }
+    };
+
+    std::string socketPath;
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1};
+    std::atomic<bool> running{false};
+    std::shared_ptr<const RuleSet> rules;
+    WorkerPool pool;
+
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+    std::unordered_map<uint64_t, std::shared_ptr<HostedSession>> sessions;
+    uint64_t nextSessionId = 1;
+    std::atomic<size_t> sessionsAlive{0};
+
+    void acceptClients();
+    bool readFrom(const std::shared_ptr<Connection>& conn);
+    bool flush(const std::shared_ptr<Connection>& conn);
+    void closeConnection(int fd);
+    void handleLine(const std::shared_ptr<Connection>& conn, const std::string& line);
+    void scheduleAI(const std::shared_ptr<HostedSession>& session);
+    // Infinite board: places the stone and reports a five; the caller holds the session mutex
+    static bool playSparse(HostedSession& session, Cell cell, Outcome& outcome);
+    void send(const std::shared_ptr<Connection>& conn, const std::string& line);
+    static std::string endLine(uint64_t sid, const Outcome& outcome);
+};
@@ -0,0 +1,255 @@
+// Distributed root-split search (see DistributedSearch.h).
+//
+//   gomoku_dsearch worker <address>
+//   gomoku_dsearch coordinator <address> [-w workers] [-d depth]
+//   gomoku_dsearch bench [-w max workers] [-d depth] [-j jobs per worker] [-a address]
+//
+// Addresses are unix:/path or tcp:host:port. "coordinator" waits for the
+// given number of workers (started by hand, on any host) and searches the
+// position set. "bench" starts 1..N local worker processes itself and, at
+// each count, searches the set one position at a time and then all at once
+// (searchAll). It prints the speed-up of both against the in-process
+// search, then stops one worker and kills another in mid-search to show the
+// result does not change. With fewer cores than workers the processes share
+// them, so the speed-up is taken from the critical path: the jobs in CPU
+// time, scheduled on one core per worker in the order the coordinator
+// issued them. That is the wall time to expect with a core per worker.
+#include "DistributedSearch.h"
+#include "../include/GomokuRuleSet.h"
+#include <csignal>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct SearchPosition {
+    std::string name;
+    std::vector<Pos> moves;    // From Tengen, Black first
+};
+
+static std::vector<SearchPosition> positionSet() {
+    return {
+        {"opening", {{7, 7}, {8, 8}, {6, 8}, {8, 6}, {8, 7}, {6, 6}}},
+        {"diagonal", {{7, 7}, {7, 8}, {8, 8}, {6, 6}, {9, 9}, {10, 10}, {8, 7}, {8, 6}}},
+        {"crossed", {{7, 7}, {8, 7}, {7, 8}, {7, 6}, {6, 7}, {8, 9}, {9, 8}, {6, 9}, {8, 8}, {10, 7}}},
+        {"midgame", {{7, 7}, {8, 7}, {8, 6}, {6, 8}, {7, 6}, {7, 8}, {9, 6}, {6, 6}, {10, 6}, {11, 6}, {9, 5}, {6, 7}}},
+    };
+}
+
+static void setUp(const SearchPosition& pos, GameContext& ctx, Board& board) {
+    for (size_t i = 0; i < pos.moves.size(); ++i) board.set(pos.moves[i], (i % 2 == 0) ? Side::Black : Side::White);
+    ctx.toMove = (pos.moves.size() % 2 == 0) ? Side::Black : Side::White;
+    ctx.turnIndex = (int)pos.moves.size();
+}
+
+static std::string cellName(Move m) {
+    if (m.isNone()) return "--";
+    return std::string(1, (char)('a' + m.col())) + std::to_string(m.row() + 1);
+}
+
+static pid_t spawnWorker(const char* self, const std::string& address) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/proc/self/exe", self, "worker", address.c_str(), (char*)nullptr);
+        execlp(self, self, "worker", address.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void reap(std::vector<pid_t>& pids) {
+    for (pid_t pid : pids) {
+        kill(pid, SIGCONT);
+        waitpid(pid, nullptr, 0);
+    }
+    pids.clear();
+}
+
+// The in-process search every distributed result is compared with
+struct Reference {
+    Move move;
+    long long score = 0;
+    double seconds = 0;
+};
+
+static int runCoordinator(const std::string& address, int workerCount, int depth) {
+    GomokuRuleSet rules;
+    DistributedSearch coordinator(address);
+    if (!coordinator.start()) {
+        std::cerr << "Failed to listen on " << address << "\n";
+        return 1;
+    }
+    std::cout << "Waiting for " << workerCount << " workers on " << address << std::endl;
+    coordinator.waitForWorkers((size_t)workerCount, 600000);
+    std::cout << coordinator.workers() << " workers connected\n";
+    auto positions = positionSet();
+    std::vector<DistributedSearch::Task> tasks(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        setUp(positions[i], tasks[i].ctx, tasks[i].board);
+        tasks[i].rules = &rules;
+        tasks[i].depth = depth;
+    }
+    auto batch = coordinator.searchAll(tasks);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto& r = batch.results[i];
+        std::cout << "  " << std::left << std::setw(10) << positions[i].name << std::setw(6) << cellName(r.move) << "score " << r.score
+                  << ", " << r.nodes << " nodes, " << r.elapsedMs << " ms, " << r.jobs << " jobs (" << r.reissued << " reissued, "
+                  << r.lost << " lost, " << r.local << " local)\n";
+    }
+    std::cout << "  total " << batch.elapsedMs << " ms\n";
+    coordinator.shutdown();
+    return 0;
+}
+
+static int runBench(const char* self, const std::string& address, int maxWorkers, int depth, int jobsPerWorker) {
+    GomokuRuleSet rules;
+    auto positions = positionSet();
+
+    std::vector<Reference> refs;
+    double refTotal = 0;
+    long long refNodes = 0;
+    std::cout << "In-process search, depth " << depth << ":\n";
+    for (const auto& pos : positions) {
+        GameContext ctx;
+        Board board;
+        setUp(pos, ctx, board);
+        AIPlayer ai;
+        DistributedSearch::configurePlayer(ai, depth);
+        auto t0 = std::chrono::steady_clock::now();
+        Action action = ai.getAction(ctx, board, rules);
+        Reference ref;
+        ref.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        ref.move = action.move;
+        ref.score = ai.lastStats().score;
+        refs.push_back(ref);
+        refTotal += ref.seconds;
+        refNodes += ai.lastStats().nodes;
+        std::cout << "  " << std::left << std::setw(10) << pos.name << std::setw(6) << cellName(ref.move) << "score " << ref.score
+                  << ", " << ai.lastStats().nodes << " nodes, " << std::fixed << std::setprecision(2) << ref.seconds << " s\n";
+    }
+    std::cout << "  total " << refTotal << " s, " << refNodes << " nodes, " << std::thread::hardware_concurrency() << " cores\n\n";
+
+    std::vector<DistributedSearch::Task> tasks(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        setUp(positions[i], tasks[i].ctx, tasks[i].board);
+        tasks[i].rules = &rules;
+        tasks[i].depth = depth;
+    }
+
+    // What one pass over the set cost, and how many of its scores and moves match the reference
+    struct SetRun {
+        double seconds = -1;
+        DistributedSearch::Batch batch;
+        long long nodes = 0;
+        int agree = 0;
+        int reissued = 0;
+        int lost = 0;
+        int local = 0;
+    };
+    // Runs the set on count fresh workers, one position at a time or all at
+    // once; disrupt (if set) acts on the worker pids in mid-search
+    auto runSet = [&](int count, bool together, const std::function<void(std::vector<pid_t>&)>& disrupt) {
+        SetRun run;
+        DistributedSearch coordinator(address);
+        coordinator.setJobsPerWorker(jobsPerWorker);
+        if (!coordinator.start()) return run;
+        std::vector<pid_t> pids;
+        for (int i = 0; i < count; ++i) pids.push_back(spawnWorker(self, address));
+        if ((int)coordinator.waitForWorkers((size_t)count, 10000) < count) {
+            coordinator.shutdown();
+            reap(pids);
+            return run;
+        }
+        std::thread disruptor;
+        if (disrupt) disruptor = std::thread([&]() { disrupt(pids); });
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (together) {
+            run.batch = coordinator.searchAll(tasks);
+        } else {
+            // Each search is scheduled on its own; the set takes the sum of the paths
+            for (const auto& task : tasks) {
+                auto one = coordinator.searchAll({task});
+                run.batch.results.push_back(one.results[0]);
+                run.batch.cpuMs += one.cpuMs;
+                run.batch.pathCpuMs += one.pathCpuMs;
+            }
+        }
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            const auto& r = run.batch.results[i];
+            run.nodes += r.nodes;
+            run.agree += (r.score == refs[i].score) + (r.move == refs[i].move);
+            run.reissued += r.reissued;
+            run.lost += r.lost;
+            run.local += r.local;
+        }
+        if (disruptor.joinable()) disruptor.join();
+        coordinator.shutdown();
+        reap(pids);
+        return run;
+    };
+
+    std::cout << "Speed-up = in-process seconds / critical path (CPU s on one core per worker)\n";
+    std::cout << std::left << std::setw(9) << "workers" << std::setw(8) << "mode" << std::setw(10) << "seconds" << std::setw(10)
+              << "cpu s" << std::setw(10) << "path s" << std::setw(10) << "speed-up" << std::setw(12) << "nodes"
+              << "agree (score+move of " << positions.size() * 2 << ")\n";
+    for (int n = 1; n <= maxWorkers; ++n) {
+        for (bool together : {false, true}) {
+            SetRun run = runSet(n, together, nullptr);
+            if (run.seconds < 0) {
+                std::cerr << "Could not start " << n << " workers on " << address << "\n";
+                return 1;
+            }
+            double path = run.batch.pathCpuMs / 1000.0;
+            std::cout << std::setw(9) << n << std::setw(8) << (together ? "batch" : "single") << std::setw(10) << std::fixed
+                      << std::setprecision(2) << run.seconds << std::setw(10) << run.batch.cpuMs / 1000.0 << std::setw(10) << path
+                      << std::setw(10) << refTotal / std::max(path, 1e-3) << std::setw(12) << run.nodes << run.agree << "\n";
+        }
+    }
+
+    if (maxWorkers >= 2) {
+        // Stop one worker (a hung host) and kill another (a crashed one) while the first position is searched
+        int count = std::max(3, maxWorkers);
+        long long delayMs = std::max(20LL, (long long)(refs[0].seconds * 1000 / count / 2));
+        SetRun run = runSet(count, false, [&](std::vector<pid_t>& pids) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            kill(pids[0], SIGSTOP);
+            kill(pids[1], SIGKILL);
+        });
+        std::cout << "\nFaults (" << count << " workers, one stopped and one killed after " << delayMs << " ms): " << run.seconds
+                  << " s, " << run.reissued << " jobs reissued, " << run.lost << " lost, " << run.local << " searched locally, agree "
+                  << run.agree << "/" << positions.size() * 2 << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string mode = (argc > 1) ? argv[1] : "bench";
+    std::string address = "unix:/tmp/gomoku-dsearch-" + std::to_string(getpid()) + ".sock";
+    int workers = (int)std::max(2u, std::thread::hardware_concurrency());
+    int depth = 6;
+    int jobsPerWorker = 1;
+    int first = 2;
+    if ((mode == "worker" || mode == "coordinator") && argc > 2) {
+        address = argv[2];
+        first = 3;
+    }
+    for (int i = first; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "-w") workers = std::max(1, std::stoi(argv[i + 1]));
+        else if (arg == "-d") depth = std::max(1, std::stoi(argv[i + 1]));
+        else if (arg == "-j") jobsPerWorker = std::max(1, std::stoi(argv[i + 1]));
+        else if (arg == "-a") address = argv[i + 1];
+    }
+
+    if (mode == "worker") return runSearchWorker(address);
+    if (mode == "coordinator") return runCoordinator(address, workers, depth);
+    if (mode == "bench") return runBench(argv[0], address, workers, depth, jobsPerWorker);
+    std::cerr << "Usage: gomoku_dsearch worker <address> | coordinator <address> [-w n] [-d depth] | bench [-w n] [-d depth] [-j jobs] [-a address]\n";
+    return 1;
+}
@@ -0,0 +1,186 @@
+// Local load generator standing in for real clients.
+//
+//   gomoku_load [socket path] [seconds per step] [difficulty] <session counts>...
+//
+// For each session count it opens connections (up to 64 sessions each),
+// plays random legal Black moves next to existing stones, restarts games
+// when they end, and reports AI moves/sec with p50/p99 reply latency.
+#include "../include/Board.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct ClientSession {
+    int conn = 0;
+    Board board;
+    Clock::time_point sentAt;
+};
+
+struct ClientConnection {
+    int fd = -1;
+    std::string in;
+};
+
+static int connectTo(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void sendLine(int fd, const std::string& line) {
+    std::string msg = line + "\n";
+    size_t off = 0;
+    while (off < msg.size()) {
+        ssize_t n = ::send(fd, msg.data() + off, msg.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        off += n;
+    }
+}
+
+static bool randomMove(const Board& board, std::mt19937& rng, Pos& out) {
+    std::vector<Pos> moves;
+    for (int r = 0; r < Board::SIZE; ++r) {
+        for (int c = 0; c < Board::SIZE; ++c) {
+            if (!board.isEmpty({r, c})) continue;
+            bool neighbor = false;
+            for (int dr = -1; dr <= 1 && !neighbor; ++dr) {
+                for (int dc = -1; dc <= 1 && !neighbor; ++dc) {
+                    Pos n = {r + dr, c + dc};
+                    neighbor = board.isValid(n) && !board.isEmpty(n);
+                }
+            }
+            if (neighbor) moves.push_back({r, c});
+        }
+    }
+    if (moves.empty()) return false;
+    out = moves[rng() % moves.size()];
+    return true;
+}
+
+static void runStep(const std::string& path, int sessions, int seconds, int difficulty) {
+    const int perConnection = 64;
+    std::vector<ClientConnection> conns;
+    for (int i = 0; i < (sessions + perConnection - 1) / perConnection; ++i) {
+        int fd = connectTo(path);
+        if (fd < 0) {
+            std::cerr << "connect failed\n";
+            return;
+        }
+        conns.push_back({fd, ""});
+    }
+
+    std::unordered_map<uint64_t, ClientSession> active;
+    std::mt19937 rng(42);
+    for (int i = 0; i < sessions; ++i) {
+        sendLine(conns[i / perConnection].fd, "NEW " + std::to_string(i / perConnection) + " " + std::to_string(difficulty));
+    }
+
+    std::vector<double> latenciesMs;
+    long long aiMoves = 0, games = 0, errors = 0;
+    auto start = Clock::now();
+    auto end = start + std::chrono::seconds(seconds);
+    std::vector<pollfd> fds;
+
+    auto handle = [&](int connIdx, const std::string& line) {
+        std::istringstream iss(line);
+        std::string cmd;
+        iss >> cmd;
+        if (cmd == "OK") {
+            uint64_t sid;
+            std::string tag;
+            iss >> tag >> sid;
+            ClientSession s;
+            s.conn = connIdx;
+            s.board.set({7, 7}, Side::Black);
+            s.sentAt = Clock::now();
+            active[sid] = s;
+        } else if (cmd == "AI") {
+            uint64_t sid;
+            int r, c;
+            iss >> sid >> r >> c;
+            auto it = active.find(sid);
+            if (it == active.end()) return;
+            auto now = Clock::now();
+            latenciesMs.push_back(std::chrono::duration<double, std::milli>(now - it->second.sentAt).count());
+            aiMoves++;
+            it->second.board.set({r, c}, Side::White);
+            // An END line follows if that move won; don't answer it
+            bool whiteWon = false;
+            int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+            for (auto& d : dirs) {
+                const Board& b = it->second.board;
+                if (1 + b.countConsecutive({r, c}, d[0], d[1], Side::White) + b.countConsecutive({r, c}, -d[0], -d[1], Side::White) >= 5) whiteWon = true;
+            }
+            Pos p;
+            if (!whiteWon && now < end && randomMove(it->second.board, rng, p)) {
+                it->second.board.set(p, Side::Black);
+                it->second.sentAt = Clock::now();
+                sendLine(conns[connIdx].fd, "MOVE " + std::to_string(sid) + " " + std::to_string(p.r) + " " + std::to_string(p.c));
+            }
+        } else if (cmd == "END") {
+            uint64_t sid;
+            iss >> sid;
+            active.erase(sid);
+            games++;
+            if (Clock::now() < end) sendLine(conns[connIdx].fd, "NEW " + std::to_string(connIdx) + " " + std::to_string(difficulty));
+        } else if (cmd == "ERR") {
+            errors++;
+        }
+    };
+
+    while (Clock::now() < end) {
+        fds.clear();
+        for (auto& c : conns) fds.push_back({c.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), 100) <= 0) continue;
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            char buf[65536];
+            ssize_t n = recv(conns[i].fd, buf, sizeof(buf), 0);
+            if (n <= 0) continue;
+            conns[i].in.append(buf, n);
+            size_t startPos = 0, nl;
+            while ((nl = conns[i].in.find('\n', startPos)) != std::string::npos) {
+                handle((int)i, conns[i].in.substr(startPos, nl - startPos));
+                startPos = nl + 1;
+            }
+            conns[i].in.erase(0, startPos);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& c : conns) close(c.fd);
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    auto pct = [&](double q) { return latenciesMs.empty() ? 0.0 : latenciesMs[(size_t)(q * (latenciesMs.size() - 1))]; };
+    std::cout << sessions << " sessions: " << (long long)(aiMoves / elapsed) << " moves/s, p50 " << pct(0.50)
+              << " ms, p99 " << pct(0.99) << " ms, " << games << " games finished, " << errors << " errors" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "/tmp/gomoku.sock";
+    int seconds = (argc > 2) ? std::stoi(argv[2]) : 10;
+    int difficulty = (argc > 3) ? std::stoi(argv[3]) : 1;
+    std::vector<int> counts;
+    for (int i = 4; i < argc; ++i) counts.push_back(std::stoi(argv[i]));
+    if (counts.empty()) counts = {1, 10, 100, 1000};
+
+    for (int n : counts) runStep(path, n, seconds, difficulty);
+    return 0;
+}
@@ -0,0 +1,30 @@
+// gomoku_server [socket path] [worker threads] [max queued AI moves]
+#include "GameServer.h"
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+static GameServer* activeServer = nullptr;
+
+static void onSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "/tmp/gomoku.sock";
+    int workers = (argc > 2) ? std::stoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    size_t maxQueued = (argc > 3) ? std::stoul(argv[3]) : 65536;
+
+    GameServer server(path, workers, maxQueued);
+    if (!server.start()) {
+        std::cerr << "Failed to listen on " << path << "\n";
+        return 1;
+    }
+    activeServer = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::cout << "Gomoku server on " << path << " (" << workers << " AI workers)" << std::endl;
+    server.run();
+    return 0;
+}
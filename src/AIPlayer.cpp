@@ -1,198 +1,1128 @@
 #include "../include/AIPlayer.h"
+#include "../include/Nnue.h"
+#include "../include/EvalWeights.h"
+#include "../include/SearchCache.h"
+#include "../include/Trace.h"
 #include <vector>
 #include <algorithm>
 #include <random>
 #include <limits>
+#include <cstdlib>
+#include <memory>
 
-// 带Alpha-Beta剪枝的极大极小算法
-// 搜索深度由难度控制
-// 简单: 深度 1 (贪婪)
-// 中等: 深度 2
-// 困难: 深度 4 (聪明)
+// 负极大值形式的主变例搜索 (PVS)，配合迭代加深、渴望窗口和后期着法缩减 (LMR)
+// 难度由节点预算和评估噪声决定（默认值，可由 SearchParams 配置），在任何机器上走出相同的着法：
+// 简单: 250 节点，噪声 ±60000
+// 中等: 2000 节点，噪声 ±2000
+// 困难: 150000 节点，无噪声
+// 迭代加深到预算用完 (最多 MAX_HARD_DEPTH)；有预算时难度的时间上限 1/5/15 秒不起作用，只有预算为 0 时按时间停止
 
+// 手工评估：各棋型数量（己方减对方）乘以权重，权重可在启动时从文件加载
 long long evaluateBoard(const Board& board, Side mySide, Side oppSide) {
+    int features[PAT_COUNT];
+    extractEvalFeatures(board, mySide, oppSide, features);
+
+    const auto& weights = EvalWeights::active().board;
     long long score = 0;
+    for (int k = 0; k < PAT_COUNT; ++k) score += weights[k] * features[k];
+    return score;
+}
+
+// 获取候选走法：现有棋子周围 radius 步范围内的空点（棋盘为空时只有天元），写入 moves（先清空）
+void getCandidates(const Board& board, int radius, std::vector<Move>& moves) {
+    TRACE_SCOPE("ai.movegen");
+    moves.clear();
+    for (int r = 0; r < Board::SIZE; ++r) {
+        for (int c = 0; c < Board::SIZE; ++c) {
+            Move m = Move::at(r, c);
+            if (!board.isEmpty(m)) continue;
+            if (r == 7 && c == 7) { moves.push_back(m); continue; } // 中心点总是候选
+
+            bool neighbor = false;
+            for (int dr = -radius; dr <= radius && !neighbor; ++dr) {
+                for (int dc = -radius; dc <= radius; ++dc) {
+                    Move n = Move::at(r + dr, c + dc);
+                    if (!n.isNone() && !board.isEmpty(n)) {
+                        neighbor = true;
+                        break;
+                    }
+                }
+            }
+            if (neighbor) moves.push_back(m);
+        }
+    }
+}
+
+std::vector<Move> getCandidates(const Board& board, int radius) {
+    std::vector<Move> moves;
+    moves.reserve(64);
+    getCandidates(board, radius, moves);
+    return moves;
+}
+
+std::vector<Move> getCandidates(const Board& board) {
+    return getCandidates(board, 2);
+}
+
+const long long WIN_SCORE = 1000000000000LL;   // 大于任何 evaluateBoard 的结果
+const long long INF_SCORE = WIN_SCORE * 2;
+const int MAX_HARD_DEPTH = SearchParams::MAX_DEPTH;
+// 渴望窗口、LMR 条件、静态搜索层数等可调参数见 SearchParams.h，每个 AIPlayer 持有一份
+const int MAX_PV = MAX_HARD_DEPTH + 2;         // 主变例表的层数（不含静态搜索）
+const size_t SPARSE_MAX_BRANCH = 20;           // 无限棋盘每个节点只搜排序靠前的着法
+const size_t SMALL_BOARD_TABLE_MB = 16;        // 小棋盘现场求解的置换表大小
+const int BUDGET_SAFETY_MS = 600000;           // 有节点预算时的时间安全上限，远大于任何预算的耗时
+// 搜索栈的最大层数：内部节点不超过最大深度，静态搜索最多再走 MAX_QS_PLY 层（外加一步挡五）
+const int MAX_PLY = MAX_PV + SearchParams::MAX_QS_PLY + 2;
+
+// 带排序分的着法；order 为原列表中的位置，同分时保持原顺序
+template <class M>
+struct ScoredMove {
+    int score;
+    int order;
+    M move;
+};
+
+// 按分数从高到低排序，同分保持原顺序（std::stable_sort 会申请临时缓冲区，这里用原位置作次关键字）
+template <class M>
+static void sortByScore(std::vector<ScoredMove<M>>& list) {
+    std::sort(list.begin(), list.end(), [](const auto& a, const auto& b) {
+        return a.score != b.score ? a.score > b.score : a.order < b.order;
+    });
+}
+
+// 每层的着法工作区：搜索开始前按棋盘容量一次分配好，节点内只清空后复用。
+// 有界棋盘的候选点不超过 225 个，容量不会再增长，搜索过程中不申请堆内存；
+// 无限棋盘的威胁点随棋子数增长，缓冲区只在遇到更多点时扩容
+template <class M>
+struct PlyBuffers {
+    std::vector<M> moves;
+    std::vector<int> keys;
+    std::vector<ScoredMove<M>> scored;  // 着法排序；静态搜索的强制着法
+    std::vector<M> scan;                // 威胁扫描点
+    std::vector<M> replies, oppOpenFours, myFours;  // 强制应对
+
+    void reserve(size_t capacity) {
+        moves.reserve(capacity);
+        keys.reserve(capacity);
+        scored.reserve(capacity);
+        scan.reserve(capacity);
+        replies.reserve(capacity);
+        oppOpenFours.reserve(capacity);
+        myFours.reserve(capacity);
+    }
+};
+
+// M 为着法类型：有界棋盘为 Move，无限棋盘为 Cell
+template <class M>
+struct SearchContext {
+    const NnueNetwork* net = nullptr;   // 为空时使用手工评估 evaluateBoard
+    std::chrono::steady_clock::time_point deadline;
+    StopToken stop;             // 外部取消（认输、退出、对局超时）
+    long long nodeLimit = 0;    // 节点预算，0 为不限
+    int noise = 0;              // 叶节点评估噪声幅度（难度），0 为无
+    uint64_t noiseSeed = 0;
+    bool quiescence = true;
+    bool forcedReplies = true;  // 对方有四/活三时只搜强制应对
+    long long rootFloor = -INF_SCORE;  // 最后一轮根节点的下限（分布式搜索），不超过它的分数只是上界
+    SearchParams params;
+    long long nodes = 0;
+    long long qnodes = 0;       // 其中静态搜索的节点数
+    long long forcedNodes = 0;  // 只搜强制应对的内部节点数
+    bool aborted = false;
+    bool clockStopped = false;  // 因时间上限或外部取消而中止：结果不只由局面和预算决定
+    // 三角主变例表：pv[ply] 为从该层开始的最佳着法序列
+    M pv[MAX_PV][MAX_PV];
+    int pvLength[MAX_PV] = {};
+    PlyBuffers<M>* plies = nullptr;     // 每层一份，指向本线程的 SearchArena
+};
+
+// 每个线程一份搜索工作区：第一次搜索时分配，之后同一线程上的搜索（任何 AIPlayer）直接复用，
+// 不再申请堆内存。同一线程上的搜索不会嵌套，所以一份就够
+template <class M>
+struct SearchArena {
+    std::vector<PlyBuffers<M>> plies;
+    PlyBuffers<M> root;                 // 根节点的着法与排序
+};
+
+template <class M>
+static SearchArena<M>& threadArena() {
+    static thread_local SearchArena<M> arena;
+    return arena;
+}
+
+static size_t moveCapacity(const Board&) {
+    return Board::SIZE * Board::SIZE;
+}
+
+static size_t moveCapacity(const SparseBoard& board) {
+    return std::max<size_t>(256, board.stoneCount() * 8);
+}
+
+// 搜索开始前备好全部工作区（已有足够容量时什么也不做），之后的节点只复用它们；返回根节点的缓冲区
+template <class M, class B>
+static PlyBuffers<M>& prepareArena(SearchContext<M>& sc, const B& board) {
+    SearchArena<M>& arena = threadArena<M>();
+    arena.plies.resize(MAX_PLY);
+    for (auto& buffers : arena.plies) buffers.reserve(moveCapacity(board));
+    arena.root.reserve(moveCapacity(board));
+    sc.plies = arena.plies.data();
+    return arena.root;
+}
+
+template <class M>
+static void updatePv(SearchContext<M>& sc, int ply, M p) {
+    if (ply >= MAX_PV) return;
+    sc.pv[ply][0] = p;
+    int childLength = (ply + 1 < MAX_PV) ? sc.pvLength[ply + 1] : 0;
+    childLength = std::min(childLength, MAX_PV - 1);
+    for (int i = 0; i < childLength; ++i) sc.pv[ply][i + 1] = sc.pv[ply + 1][i];
+    sc.pvLength[ply] = childLength + 1;
+}
+
+static constexpr Side opponentOf(Side s) {
+    return (s == Side::Black) ? Side::White : Side::Black;
+}
+
+// 落子方在编译期已知：白方节点不生成任何禁手检查代码，黑方节点直接调用规则的检查
+template <class Rules, Side side, class B, class M>
+static bool forbiddenFor(const B& board, M m) {
+    if constexpr (Rules::HAS_FORBIDDEN && side == Side::Black) return Rules::isForbidden(board, m.pos(), side);
+    else return false;
+}
+
+// 在 p 点落子后是否按规则获胜（连珠规则下黑方必须恰好五连）
+template <class Rules, class B, class M>
+static bool isWinningMove(const B& board, M m, Side side) {
+    Pos p = m.pos();
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        int count = 1 + board.countConsecutive(p, d[0], d[1], side) + board.countConsecutive(p, -d[0], -d[1], side);
+        if (Rules::isWinningRun(count, side)) return true;
+    }
+    return false;
+}
+
+// 在 p 点为 side 落子能形成的棋型分值（p 本身应为空）
+static int pointPatternScore(const Board& board, Move m, Side side) {
+    Pos p = m.pos();
+    const auto& order = EvalWeights::active().order;
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int s = 0;
+    for (auto& d : dirs) {
+        int fwd = board.countConsecutive(p, d[0], d[1], side);
+        int bwd = board.countConsecutive(p, -d[0], -d[1], side);
+        int count = 1 + fwd + bwd;
+        bool open1 = board.isEmpty({p.r + (fwd + 1) * d[0], p.c + (fwd + 1) * d[1]});
+        bool open2 = board.isEmpty({p.r - (bwd + 1) * d[0], p.c - (bwd + 1) * d[1]});
+
+        int pattern = classifyRun(count, open1, open2);
+        if (pattern >= 0) s += order[pattern];
+    }
+    return s;
+}
+
+// 难度噪声：由局面哈希和种子决定的 [-noise, noise] 内的偏移，与机器无关；
+// 对黑方为正的偏移对白方为负，负极大值搜索看到的是同一个局面分。
+// 标准棋盘取规范哈希，互为镜像的局面噪声相同
+template <class M>
+static long long leafNoise(const SearchContext<M>& sc, uint64_t hash, Side toMove) {
+    if (sc.noise <= 0) return 0;
+    uint64_t x = hash ^ sc.noiseSeed;   // splitmix64 混合
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    long long offset = (long long)(x % (2 * (uint64_t)sc.noise + 1)) - sc.noise;
+    return (toMove == Side::Black) ? offset : -offset;
+}
+
+// 叶节点评估：有网络时读取增量更新的累加器，否则回退到手工评估
+static long long evaluateLeaf(const SearchContext<Move>& sc, const Board& board, Side toMove) {
+    TRACE_SCOPE("ai.eval");
+    long long noise = leafNoise(sc, board.canonicalHash(), toMove);
+    if (sc.net && board.attached()) return sc.net->evaluate(*board.attached(), toMove) + noise;
+    return evaluateBoard(board, toMove, opponentOf(toMove)) + noise;
+}
+
+// 无限棋盘：与 evaluateBoard 相同的棋型计数，由 SparseBoard 增量维护
+static long long evaluateLeaf(const SearchContext<Cell>& sc, const SparseBoard& board, Side toMove) {
+    TRACE_SCOPE("ai.eval");
+    return board.evaluate(toMove) + leafNoise(sc, board.hash(), toMove);
+}
+
+// 威胁等级：在 p 点为 side 落子后该方向上形成的最强棋型
+enum Threat { THREAT_NONE = 0, THREAT_OPEN_THREE, THREAT_FOUR, THREAT_OPEN_FOUR, THREAT_FIVE };
+
+template <class Rules, class B>
+static int lineThreat(const B& board, Pos p, int dr, int dc, Side side) {
+    // 以 p 为中心（索引 5）取 11 格：0=空, 1=己方（含 p）, 2=对方或棋盘外
+    int cells[11];
+    for (int i = -5; i <= 5; ++i) {
+        Pos q = {p.r + i * dr, p.c + i * dc};
+        if (i == 0) cells[i + 5] = 1;
+        else if (!board.isValid(q)) cells[i + 5] = 2;
+        else {
+            Side s = board.get(q);
+            cells[i + 5] = (s == side) ? 1 : (s == Side::None ? 0 : 2);
+        }
+    }
+
+    int run = 1;
+    for (int i = 6; i < 11 && cells[i] == 1; ++i) run++;
+    for (int i = 4; i >= 0 && cells[i] == 1; --i) run++;
+    if (Rules::isWinningRun(run, side)) return THREAT_FIVE;
+
+    // 四：包含 p 的 5 格窗口里有 4 个己方和 1 个空位；两个不同的成五点即活四
+    int fiveSpots = 0;
+    for (int start = 1; start <= 5; ++start) {
+        int own = 0, emptyIdx = -1;
+        bool blocked = false;
+        for (int k = start; k < start + 5; ++k) {
+            if (cells[k] == 1) own++;
+            else if (cells[k] == 0) emptyIdx = k;
+            else blocked = true;
+        }
+        if (!blocked && own == 4) fiveSpots |= 1 << emptyIdx;
+    }
+    if (fiveSpots & (fiveSpots - 1)) return THREAT_OPEN_FOUR;
+    if (fiveSpots) return THREAT_FOUR;
+
+    // 活三：6 格窗口两端为空，中间 4 格为 3 个己方加 1 个空位
+    for (int start = 1; start <= 4; ++start) {
+        if (cells[start] != 0 || cells[start + 5] != 0) continue;
+        int own = 0, empty = 0;
+        for (int k = start + 1; k < start + 5; ++k) {
+            if (cells[k] == 1) own++;
+            else if (cells[k] == 0) empty++;
+        }
+        if (own == 3 && empty == 1) return THREAT_OPEN_THREE;
+    }
+    return THREAT_NONE;
+}
+
+template <class Rules, class B, class M>
+static int pointThreat(const B& board, M m, Side side) {
+    Pos p = m.pos();
     int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int best = THREAT_NONE;
+    for (auto& d : dirs) best = std::max(best, lineThreat<Rules>(board, p, d[0], d[1], side));
+    return best;
+}
+
+// 着法排序分：进攻（己方成型）优先于防守（破坏对方成型）
+static int evaluatePos(const Board& board, Move p, Side mySide) {
+    return pointPatternScore(board, p, mySide) * EvalWeights::active().attackFactor + pointPatternScore(board, p, opponentOf(mySide));
+}
+
+// scored 为排序用的缓冲区
+static void orderMoves(std::vector<Move>& moves, std::vector<int>& keys, std::vector<ScoredMove<Move>>& scored, const Board& board, Side toMove) {
+    TRACE_SCOPE("ai.order");
+    scored.clear();
+    for (const auto& p : moves) scored.push_back({evaluatePos(board, p, toMove), (int)scored.size(), p});
+    sortByScore(scored);
+
+    keys.clear();
+    for (size_t i = 0; i < scored.size(); ++i) {
+        moves[i] = scored[i].move;
+        keys.push_back(scored[i].score);
+    }
+}
+
+// 生成并排序着法，写入该层的 moves/keys
+static void generateMoves(const Board& board, Side toMove, int radius, PlyBuffers<Move>& buf) {
+    getCandidates(board, radius, buf.moves);
+    orderMoves(buf.moves, buf.keys, buf.scored, board, toMove);
+}
+
+// 无限棋盘：排序分由 SparseBoard 增量维护，只取前 SPARSE_MAX_BRANCH 个（候选点随棋子数增长）
+static void generateMoves(const SparseBoard& board, Side toMove, int /*radius: SparseBoard 固定为 2*/, PlyBuffers<Cell>& buf) {
+    TRACE_SCOPE("ai.order");
+    board.orderedCandidates(toMove, SPARSE_MAX_BRANCH, buf.moves, buf.keys);
+}
+
+// 静态搜索扫描威胁的点：有界棋盘为 2 步内的全部候选点（成四/成五点不会更远，与搜索半径无关）；无限棋盘只取经过该点、不含对方棋子的
+// 五格窗口内某方已有 3 子的点（由 SparseBoard 增量维护），其余点不可能成五或成四
+static void threatCandidates(const Board& board, std::vector<Move>& out) {
+    getCandidates(board, 2, out);
+}
+
+static void threatCandidates(const SparseBoard& board, std::vector<Cell>& out) {
+    TRACE_SCOPE("ai.movegen");
+    board.threatCandidates(out);
+}
+
+// 检测强制局面时扫描的点：有界棋盘直接用已生成的候选点；无限棋盘的候选只取了排序靠前的一部分，
+// 改用威胁点表（成五点、成活四点都在其中）
+static const std::vector<Move>& forcedScanPoints(const Board&, PlyBuffers<Move>& buf) {
+    return buf.moves;
+}
+
+static const std::vector<Cell>& forcedScanPoints(const SparseBoard& board, PlyBuffers<Cell>& buf) {
+    board.threatCandidates(buf.scan);
+    return buf.scan;
+}
+
+// 强制应对：由线上棋型判断局面是否只剩少数合理着法，是则把 moves/keys 收缩到这些点（保持原排序）。
+// - 己方有成五点：只走它
+// - 对方有成五点（冲四/活四）：只能去挡
+// - 对方有成活四点（活三）：挡住它（落子后对方不再有任何成活四点），或己方冲四
+// 对方为黑方时，禁手点不构成威胁（成五除外：五连优先）；己方的禁手点由搜索循环跳过。
+// 返回是否发生了收缩。行棋方按运行时参数传入：两种颜色共用一份代码（只在有威胁时才做禁手判断）
+template <class Rules, class B, class M>
+static bool restrictToForcedReplies(B& board, Side toMove, PlyBuffers<M>& buf) {
+    TRACE_SCOPE("ai.forced");
+    Side oppSide = opponentOf(toMove);
+    std::vector<M>& moves = buf.moves;
+    std::vector<int>& keys = buf.keys;
+    const std::vector<M>& points = forcedScanPoints(board, buf);
 
-    // 扫描整个棋盘（效率较低）
-    // 只扫描有棋子的线
-    // 使用简化的评估，只评估棋盘对 mySide 与 oppSide 的“潜力”。
-    
-    auto evaluatePos = [&](Pos p, Side side) -> long long {
-        long long s = 0;
-        for (auto& d : dirs) {
-            int count = 1;
-            int r, c;
-            // 正向
-            r = p.r + d[0]; c = p.c + d[1];
-            while (board.isValid({r, c}) && board.get({r, c}) == side) { count++; r += d[0]; c += d[1]; }
-            bool open1 = board.isValid({r, c}) && board.isEmpty({r, c});
-            // 反向
-            r = p.r - d[0]; c = p.c - d[1];
-            while (board.isValid({r, c}) && board.get({r, c}) == side) { count++; r -= d[0]; c -= d[1]; }
-            bool open2 = board.isValid({r, c}) && board.isEmpty({r, c});
-            
-            if (count >= 5) s += 100000000;
-            else if (count == 4) {
-                if (open1 && open2) s += 1000000;
-                else if (open1 || open2) s += 100000;
+    // 先只看对方：大多数节点没有威胁，一遍扫描即可返回
+    std::vector<M>& replies = buf.replies;
+    std::vector<M>& oppOpenFours = buf.oppOpenFours;
+    std::vector<M>& myFours = buf.myFours;
+    replies.clear();
+    oppOpenFours.clear();
+    myFours.clear();
+    for (const auto& p : points) {
+        int theirs = pointThreat<Rules>(board, p, oppSide);
+        if (theirs == THREAT_FIVE) replies.push_back(p);
+        else if (theirs == THREAT_OPEN_FOUR) oppOpenFours.push_back(p);
+    }
+    if (replies.empty() && oppOpenFours.empty()) return false;
+
+    for (const auto& p : points) {
+        int mine = pointThreat<Rules>(board, p, toMove);
+        if (mine == THREAT_FIVE) {
+            replies.assign(1, p);
+            oppOpenFours.clear();
+            break;
+        }
+        if (mine >= THREAT_FOUR) myFours.push_back(p);
+    }
+
+    if (replies.empty()) {
+        if (Rules::HAS_FORBIDDEN && oppSide == Side::Black) {
+            oppOpenFours.erase(std::remove_if(oppOpenFours.begin(), oppOpenFours.end(), [&](M p) {
+                board.set(p, oppSide);
+                bool forbidden = forbiddenFor<Rules, Side::Black>(board, p);
+                board.clear(p);
+                return forbidden;
+            }), oppOpenFours.end());
+        }
+        if (oppOpenFours.empty()) return false;
+
+        replies.assign(myFours.begin(), myFours.end());
+        for (const auto& d : moves) {
+            if (std::find(replies.begin(), replies.end(), d) != replies.end()) continue;
+            board.set(d, toMove);
+            bool defends = std::none_of(oppOpenFours.begin(), oppOpenFours.end(), [&](M p) {
+                return !(p == d) && pointThreat<Rules>(board, p, oppSide) == THREAT_OPEN_FOUR;
+            });
+            board.clear(d);
+            if (defends) replies.push_back(d);
+        }
+        // 挡不住（如对方已有双活三）也没有冲四：直接挡一个活三点，让搜索看到必败
+        if (replies.empty()) replies.assign(oppOpenFours.begin(), oppOpenFours.end());
+    }
+    if (replies.empty()) return false;
+
+    // 原地收缩：保留原顺序中的应对点，不在候选中的（无限棋盘排序截断之外的）追加在后
+    size_t kept = 0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (std::find(replies.begin(), replies.end(), moves[i]) == replies.end()) continue;
+        moves[kept] = moves[i];
+        keys[kept] = keys[i];
+        kept++;
+    }
+    moves.resize(kept);
+    keys.resize(kept);
+    for (const auto& p : replies) {
+        if (std::find(moves.begin(), moves.end(), p) != moves.end()) continue;
+        moves.push_back(p);
+        keys.push_back(0);
+    }
+    return true;
+}
+
+// 每 64 个节点检查一次停止令牌（一次原子读），每 1024 个节点检查一次时间；节点预算每个节点都检查
+template <class M>
+static bool countNodeAndCheckAbort(SearchContext<M>& sc) {
+    long long n = ++sc.nodes;
+    if (sc.nodeLimit > 0 && n >= sc.nodeLimit) sc.aborted = true;
+    else if ((n & 63) == 0 && sc.stop.stopRequested()) sc.aborted = sc.clockStopped = true;
+    else if ((n & 1023) == 0 && std::chrono::steady_clock::now() >= sc.deadline) sc.aborted = sc.clockStopped = true;
+    return sc.aborted;
+}
+
+// 搜索按行棋方实例化：toMove 为编译期常量，子节点调用对方的实例
+template <class Rules, Side toMove, class B, class M>
+static long long quiesce(SearchContext<M>& sc, B& board, long long alpha, long long beta, int ply, int qply);
+
+template <class Rules, Side toMove, class B, class M>
+static long long search(SearchContext<M>& sc, B& board, int depth, long long alpha, long long beta, int ply) {
+    if (ply < MAX_PV) sc.pvLength[ply] = 0;
+    if (countNodeAndCheckAbort(sc)) return 0;
+
+    constexpr Side oppSide = opponentOf(toMove);
+    if (depth <= 0) {
+        if (sc.quiescence) return quiesce<Rules, toMove>(sc, board, alpha, beta, ply, 0);
+        return evaluateLeaf(sc, board, toMove);
+    }
+
+    // 着法表放在本层的工作区里，子节点使用下一层的
+    PlyBuffers<M>& buf = sc.plies[ply];
+    generateMoves(board, toMove, sc.params.candidateRadius, buf);
+    if (buf.moves.empty()) return 0;
+    if (sc.forcedReplies && restrictToForcedReplies<Rules>(board, toMove, buf)) sc.forcedNodes++;
+    const std::vector<M>& moves = buf.moves;
+    const std::vector<int>& keys = buf.keys;
+
+    long long bestScore = -INF_SCORE;
+    int searched = 0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        M p = moves[i];
+        // 五连优先：即使同时形成禁手也直接获胜
+        if (isWinningMove<Rules>(board, p, toMove)) {
+            if (ply + 1 < MAX_PV) sc.pvLength[ply + 1] = 0;
+            updatePv(sc, ply, p);
+            return WIN_SCORE - ply - 1;
+        }
+
+        board.set(p, toMove);
+        // 黑方禁手检查（必须先落子再判断棋型）
+        if (forbiddenFor<Rules, toMove>(board, p)) {
+            board.clear(p);
+            continue;
+        }
+
+        long long score;
+        if (searched == 0) {
+            score = -search<Rules, oppSide>(sc, board, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            // 零窗口搜索，安静的靠后着法减少一层；失败高时全深度/全窗口重搜
+            const SearchParams& sp = sc.params;
+            int reduction = (depth >= sp.lmrMinDepth && searched >= sp.lmrMinMoves && keys[i] < sp.quietThreshold) ? 1 : 0;
+            score = -search<Rules, oppSide>(sc, board, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && reduction > 0) {
+                score = -search<Rules, oppSide>(sc, board, depth - 1, -alpha - 1, -alpha, ply + 1);
             }
-            else if (count == 3) {
-                if (open1 && open2) s += 100000;
-                else if (open1 || open2) s += 1000;
+            if (score > alpha && score < beta) {
+                score = -search<Rules, oppSide>(sc, board, depth - 1, -beta, -alpha, ply + 1);
             }
-            else if (count == 2) {
-                if (open1 && open2) s += 100;
-                else if (open1 || open2) s += 10;
+        }
+        board.clear(p); // Backtrack
+        if (sc.aborted) return 0;
+
+        searched++;
+        bestScore = std::max(bestScore, score);
+        if (score > alpha) {
+            alpha = score;
+            updatePv(sc, ply, p);
+        }
+        if (alpha >= beta) break;
+    }
+
+    // 黑方所有候选点都是禁手
+    if (searched == 0) return -(WIN_SCORE - ply);
+    return bestScore;
+}
+
+// 静态搜索：到达搜索视界后只继续走强制性着法，直到局面平静
+// - 己方能成五：直接获胜
+// - 对方有成五点：只能去挡（两处以上则必败）
+// - 对方有活三：放弃“站桩”评估，只走挡点或己方冲四
+// - 否则：站桩评估，再尝试己方冲四延伸
+template <class Rules, Side toMove, class B, class M>
+static long long quiesce(SearchContext<M>& sc, B& board, long long alpha, long long beta, int ply, int qply) {
+    sc.qnodes++;
+    if (countNodeAndCheckAbort(sc)) return 0;
+
+    if (ply >= MAX_PLY) return evaluateLeaf(sc, board, toMove);
+
+    constexpr Side oppSide = opponentOf(toMove);
+    PlyBuffers<M>& buf = sc.plies[ply];
+    std::vector<M>& candidates = buf.scan;
+    threatCandidates(board, candidates);
+
+    int oppFiveCount = 0;
+    M oppFive;
+    std::vector<ScoredMove<M>>& forcing = buf.scored;
+    forcing.clear();
+    bool oppOpenThree = false;
+    {
+        TRACE_SCOPE("ai.threats");
+        for (const auto& p : candidates) {
+            int mine = pointThreat<Rules>(board, p, toMove);
+            if (mine == THREAT_FIVE) return WIN_SCORE - ply - 1;
+            int theirs = pointThreat<Rules>(board, p, oppSide);
+            if (theirs == THREAT_FIVE && oppFiveCount++ == 0) oppFive = p;
+            if (theirs == THREAT_OPEN_FOUR) oppOpenThree = true;
+            if (mine >= THREAT_FOUR || theirs == THREAT_OPEN_FOUR) {
+                forcing.push_back({mine * 8 + theirs, (int)forcing.size(), p});
             }
         }
-        return s;
-    };
+    }
 
-    for (int r = 0; r < Board::SIZE; ++r) {
-        for (int c = 0; c < Board::SIZE; ++c) {
-            Pos p = {r, c};
-            Side s = board.get(p);
-            if (s == mySide) score += evaluatePos(p, mySide);
-            else if (s == oppSide) score -= evaluatePos(p, oppSide);
+    if (oppFiveCount >= 2) return -(WIN_SCORE - ply - 2);
+    if (oppFiveCount == 1) {
+        M p = oppFive;
+        board.set(p, toMove);
+        if (forbiddenFor<Rules, toMove>(board, p)) {
+            board.clear(p);
+            return -(WIN_SCORE - ply - 2);
         }
+        long long score = -quiesce<Rules, oppSide>(sc, board, -beta, -alpha, ply + 1, qply + 1);
+        board.clear(p);
+        return score;
     }
-    return score;
+
+    long long standPat = evaluateLeaf(sc, board, toMove);
+    if (qply >= sc.params.qsMaxPly) return standPat;
+
+    long long bestScore = -INF_SCORE;
+    if (!oppOpenThree) {
+        if (standPat >= beta) return standPat;
+        alpha = std::max(alpha, standPat);
+        bestScore = standPat;
+    }
+
+    sortByScore(forcing);
+    int searched = 0;
+    for (const auto& f : forcing) {
+        M p = f.move;
+        board.set(p, toMove);
+        if (forbiddenFor<Rules, toMove>(board, p)) {
+            board.clear(p);
+            continue;
+        }
+        long long score = -quiesce<Rules, oppSide>(sc, board, -beta, -alpha, ply + 1, qply + 1);
+        board.clear(p);
+        if (sc.aborted) return 0;
+
+        searched++;
+        bestScore = std::max(bestScore, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) break;
+    }
+
+    if (searched == 0 && oppOpenThree) return standPat;
+    return bestScore;
 }
 
-// 获取候选走法（按距离中心/棋子的远近排序）
-std::vector<Pos> getCandidates(const Board& board) {
-    std::vector<Pos> moves;
-    for (int r = 0; r < Board::SIZE; ++r) {
-        for (int c = 0; c < Board::SIZE; ++c) {
-            Pos p = {r, c};
-            if (board.isEmpty(p)) {
-                // 剪枝：只考虑现有棋子周围 2 步范围内的走法
-                bool neighbor = false;
-                if (board.get({7,7}) == Side::None && r==7 && c==7) { moves.push_back(p); continue; } // 中心点总是候选
-
-                for (int dr = -2; dr <= 2; ++dr) {
-                    for (int dc = -2; dc <= 2; ++dc) {
-                        if (dr==0 && dc==0) continue;
-                        Pos n = {r+dr, c+dc};
-                        if (board.isValid(n) && !board.isEmpty(n)) {
-                            neighbor = true;
-                            break;
-                        }
-                    }
-                    if (neighbor) break;
-                }
-                if (neighbor) moves.push_back(p);
+// 缓存键：局面哈希 + 行棋方 + 影响搜索结果的设置（规则、评估权重、搜索参数、网络、静态搜索、强制应对、白方首手限制）
+static uint64_t rootCacheKey(uint64_t positionKey, Side toMove, bool whiteOpening, RuleVariant variant, const SearchContext<Move>& sc) {
+    uint64_t key = positionKey ^ EvalWeights::active().fingerprint() ^ sc.params.fingerprint() * 0xD6E8FEB86659FD93ULL;
+    if (toMove == Side::White) key ^= 0xF0E1D2C3B4A59687ULL;
+    if (whiteOpening) key ^= 0x1F2E3D4C5B6A7988ULL;
+    if (sc.net) key ^= 0x5851F42D4C957F2DULL;
+    if (sc.quiescence) key ^= 0x2545F4914F6CDD1DULL;
+    if (sc.forcedReplies) key ^= 0x61C8864680B583EBULL;
+    key ^= 0x9E3779B97F4A7C15ULL * ((uint64_t)variant + 1);
+    if (sc.noise > 0) key ^= ((uint64_t)sc.noise * 0xBF58476D1CE4E5B9ULL) ^ (sc.noiseSeed * 0x94D049BB133111EBULL);
+    return key;
+}
+
+// 有节点预算的搜索另加预算和深度上限：同一局面、同一预算的结果才能互相替代
+static uint64_t budgetCacheKey(uint64_t key, long long nodeLimit, int maxDepth) {
+    key ^= (uint64_t)nodeLimit * 0xA0761D6478BD642FULL;
+    key ^= ((uint64_t)maxDepth + 1) * 0xE7037ED1A0B428DBULL;
+    return key;
+}
+
+// 对称剪枝：局面在某些对称变换下不变时，互为镜像的根着法结果相同，每个等价类只保留一个。
+// 返回实际使用的对称集合（只保留把候选集映射到自身的变换，白方首手限制不是对称的）
+static uint8_t reduceBySymmetry(const Board& board, std::vector<Move>& moves) {
+    uint8_t syms = board.symmetries();
+    if (syms == 1) return syms;
+
+    bool candidate[Board::SIZE * Board::SIZE] = {};
+    for (Move m : moves) candidate[m.index] = true;
+    for (int s = 1; s < 8; ++s) {
+        if (!(syms & (1 << s))) continue;
+        for (Move m : moves) {
+            if (!candidate[Board::transform(m, s).index]) {
+                syms &= (uint8_t)~(1 << s);
+                break;
             }
         }
     }
-    return moves;
+
+    bool covered[Board::SIZE * Board::SIZE] = {};
+    size_t kept = 0;
+    for (Move m : moves) {
+        if (covered[m.index]) continue;
+        for (int s = 0; s < 8; ++s) {
+            if (syms & (1 << s)) covered[Board::transform(m, s).index] = true;
+        }
+        moves[kept++] = m;
+    }
+    moves.resize(kept);
+    return syms;
 }
 
-long long minimax(Board& board, int depth, long long alpha, long long beta, bool maximizingPlayer, Side mySide, Side oppSide, const GomokuRuleSet* rules) {
-    if (depth == 0) {
-        return evaluateBoard(board, mySide, oppSide);
+// 根节点候选：半径内的空点，去掉白方首手不合规的点，再做对称剪枝；返回使用的对称集合
+static uint8_t rootCandidates(const Board& board, const GameContext& ctx, int radius, bool symmetry, std::vector<Move>& moves) {
+    getCandidates(board, radius, moves);
+    // 规则：白方第一手必须下在自己的半场（行 >= 7）
+    if (ctx.toMove == Side::White && ctx.turnIndex == 1) {
+        moves.erase(std::remove_if(moves.begin(), moves.end(), [](Move p) { return p.row() < 7; }), moves.end());
     }
+    return symmetry ? reduceBySymmetry(board, moves) : 1;
+}
 
-    std::vector<Pos> moves = getCandidates(board);
-    if (moves.empty()) return 0;
+// 根节点的行棋方只在运行时知道：按它选择搜索的实例
+template <class Rules, class B, class M>
+static long long searchAs(Side toMove, SearchContext<M>& sc, B& board, int depth, long long alpha, long long beta, int ply) {
+    if (toMove == Side::Black) return search<Rules, Side::Black>(sc, board, depth, alpha, beta, ply);
+    return search<Rules, Side::White>(sc, board, depth, alpha, beta, ply);
+}
 
-    if (maximizingPlayer) {
-        long long maxEval = -std::numeric_limits<long long>::max();
-        for (const auto& p : moves) {
-            // 黑方禁手检查
-            if (mySide == Side::Black && rules) {
-                std::string reason;
-                // isForbidden 检查在 p 点落子是否会形成禁手模式。
-                // 实际上，为了简化 Minimax，在树的深层会跳过禁手检查或假设简单的启发式。
-                if (rules->isForbidden(board, p, reason)) continue; 
+// 根节点搜索：与内部节点相同的 PVS，但不做缩减，并记录最佳着法
+template <class Rules, class B, class M>
+static long long searchRoot(SearchContext<M>& sc, B& board, const std::vector<M>& moves, Side mySide, int depth,
+                            long long alpha, long long beta, M& rootBest) {
+    Side oppSide = opponentOf(mySide);
+    long long bestScore = -INF_SCORE;
+    int searched = 0;
+    for (const auto& p : moves) {
+        if (isWinningMove<Rules>(board, p, mySide)) {
+            rootBest = p;
+            return WIN_SCORE - 1;
+        }
+
+        board.set(p, mySide);
+        // 禁手检查
+        if (Rules::isForbidden(board, p.pos(), mySide)) {
+            board.clear(p);
+            continue;
+        }
+
+        long long score;
+        if (searched == 0) {
+            score = -searchAs<Rules>(oppSide, sc, board, depth - 1, -beta, -alpha, 1);
+        } else {
+            score = -searchAs<Rules>(oppSide, sc, board, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta) {
+                score = -searchAs<Rules>(oppSide, sc, board, depth - 1, -beta, -alpha, 1);
             }
+        }
+        board.clear(p);
+        if (sc.aborted) return 0;
 
-            board.set(p, mySide);
-            long long eval = minimax(board, depth - 1, alpha, beta, false, mySide, oppSide, rules);
-            board.clear(p); // Backtrack
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) break;
+        if (searched == 0 || score > bestScore) {
+            bestScore = score;
+            rootBest = p;
         }
-        return maxEval;
-    } else {
-        long long minEval = std::numeric_limits<long long>::max();
-        for (const auto& p : moves) {
-            // 对手禁手检查（如果对手是黑方）
-            if (oppSide == Side::Black && rules) {
-                std::string reason;
-                if (rules->isForbidden(board, p, reason)) continue;
+        searched++;
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) break;
+    }
+    return bestScore;
+}
+
+// 迭代加深：每一轮以上一轮的分数为中心开渴望窗口，失败时逐步放宽。
+// 从 startDepth 开始；完成的轮次更新 bestMove、prevScore 与 stats 的深度和分数。
+// 返回最后一轮完整迭代结束的时间（毫秒，没有完成的轮次时为 0）
+template <class Rules, class B, class M>
+static long long deepen(SearchContext<M>& sc, B& board, std::vector<M>& moves, Side mySide, int startDepth, int maxDepth,
+                        std::chrono::steady_clock::time_point startTime, int timeLimitMs,
+                        M& bestMove, long long& prevScore, AIPlayer::SearchStats& stats) {
+    long long completedMs = 0;
+    for (int depth = startDepth; depth <= maxDepth && !moves.empty(); ++depth) {
+        long long delta = sc.params.aspirationWindow;
+        long long alpha = -INF_SCORE, beta = INF_SCORE;
+        if (depth > 1) {
+            alpha = prevScore - delta;
+            beta = prevScore + delta;
+        }
+        // 根节点下限只用于最后一轮：分数不超过它的着法只需证明这一点，不必求出确切值
+        const long long floorScore = (depth == maxDepth) ? sc.rootFloor : -INF_SCORE;
+        if (alpha < floorScore) {
+            alpha = floorScore;
+            beta = std::max(beta, std::min(INF_SCORE, floorScore + delta));
+        }
+
+        M iterBest = moves[0];
+        long long score = 0;
+        while (true) {
+            score = searchRoot<Rules>(sc, board, moves, mySide, depth, alpha, beta, iterBest);
+            if (sc.aborted) break;
+            if (score <= alpha && alpha > floorScore) {
+                delta *= 4;
+                alpha = (delta > WIN_SCORE) ? floorScore : std::max(floorScore, score - delta);
+            } else if (score >= beta && beta < INF_SCORE) {
+                delta *= 4;
+                beta = (delta > WIN_SCORE) ? INF_SCORE : std::min(INF_SCORE, score + delta);
+            } else {
+                break;
             }
+        }
+        if (sc.aborted) break; // 未完成的一轮结果不可信，沿用上一轮
+
+        bestMove = iterBest;
+        prevScore = score;
+        stats.depth = depth;
+        stats.score = score;
 
-            board.set(p, oppSide);
-            long long eval = minimax(board, depth - 1, alpha, beta, true, mySide, oppSide, rules);
-            board.clear(p); // Backtrack
-            minEval = std::min(minEval, eval);
-            beta = std::min(beta, eval);
-            if (beta <= alpha) break;
+        // 上一轮最佳着法放到最前，作为下一轮的主变例
+        auto it = std::find(moves.begin(), moves.end(), bestMove);
+        std::rotate(moves.begin(), it, it + 1);
+
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        completedMs = elapsedMs;
+        if (std::llabs(score) >= WIN_SCORE - 100) { // 已找到必胜/必败
+            stats.solved = true;
+            break;
         }
-        return minEval;
+        // 下一轮大概率无法完成：有节点预算时按节点数判断，结果与机器速度无关
+        if (sc.nodeLimit > 0 ? sc.nodes * 2 > sc.nodeLimit : elapsedMs * 2 > timeLimitMs) break;
+    }
+    return completedMs;
+}
+
+// 按规则变体实例化整个搜索：胜负与禁手判断在热路径上都是内联调用
+Action AIPlayer::getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop) {
+    switch (rules.variant()) {
+    case RuleVariant::Freestyle: return think<FreestylePolicy>(ctx, board, stop);
+    case RuleVariant::Standard: return think<StandardPolicy>(ctx, board, stop);
+    case RuleVariant::Renju: break;
     }
+    return think<RenjuPolicy>(ctx, board, stop);
+}
+
+// 难度对应的最大深度与时间限制（取自 SearchParams，可被 setMaxDepth / setTimeLimitMs 覆盖）
+int AIPlayer::depthLimit() const {
+    int maxDepth = params.depthMedium;
+    if (difficulty == 1) maxDepth = params.depthEasy;
+    else if (difficulty == 3) maxDepth = params.depthHard;
+    if (maxDepthOverride > 0) maxDepth = maxDepthOverride;
+    return std::clamp(maxDepth, 1, MAX_HARD_DEPTH);
+}
+
+int AIPlayer::timeLimit() const {
+    int timeLimitMs = params.timeHardMs;
+    if (difficulty == 1) timeLimitMs = params.timeEasyMs;
+    if (difficulty == 2) timeLimitMs = params.timeMediumMs;
+    if (timeLimitOverrideMs > 0) timeLimitMs = timeLimitOverrideMs;
+    return timeLimitMs;
+}
+
+// 搜索的时间上限：有节点预算时由预算决定何时停止，难度的时间上限不再生效，否则负载重的主机会停在
+// 较浅的一轮、走出不同的着法；服务器和工具只留一个安全上限，对局（setBudgetTimeCap）取难度时间上限的若干倍。
+// 显式设置的时间限制（setTimeLimitMs）仍然有效
+int AIPlayer::searchTimeLimit() const {
+    if (timeLimitOverrideMs > 0 || nodeBudget() == 0) return timeLimit();
+    if (budgetTimeCap > 0) return std::min(BUDGET_SAFETY_MS, budgetTimeCap * timeLimit());
+    return BUDGET_SAFETY_MS;
+}
+
+long long AIPlayer::nodeBudget() const {
+    if (nodeLimit != 0) return std::max(0LL, nodeLimit);
+    if (difficulty == 1) return params.nodesEasy;
+    if (difficulty == 2) return params.nodesMedium;
+    return params.nodesHard;
+}
+
+int AIPlayer::noiseLevel() const {
+    if (noiseOverride >= 0) return noiseOverride;
+    if (difficulty == 1) return params.noiseEasy;
+    if (difficulty == 2) return params.noiseMedium;
+    return params.noiseHard;
 }
 
-Action AIPlayer::getAction(const GameContext& ctx, const Board& board, const RuleSet& rules) {
+template <class Rules>
+Action AIPlayer::think(const GameContext& ctx, const Board& board, const StopToken& stop) {
+    TRACE_SCOPE("ai.move");
     Action action;
     action.type = ActionType::Place;
-    action.spent = std::chrono::milliseconds(100); 
+    action.spentMs = 100;
 
     Side mySide = ctx.toMove;
-    Side oppSide = (mySide == Side::Black) ? Side::White : Side::Black;
-    const GomokuRuleSet* gomokuRules = dynamic_cast<const GomokuRuleSet*>(&rules);
 
     // Clone board for simulation
     Board simBoard = board; 
 
-    int maxDepth = 2;
-    if (difficulty == 1) maxDepth = 1;
-    else if (difficulty == 3) maxDepth = 4;
+    int maxDepth = depthLimit();
+    auto startTime = std::chrono::steady_clock::now();
+    int timeLimitMs = searchTimeLimit();
 
-    std::vector<Pos> moves = getCandidates(simBoard);
-    
-    Pos bestMove = {-1, -1};
-    long long bestScore = -std::numeric_limits<long long>::max();
+    SearchContext<Move> sc;
+    sc.quiescence = quiescence;
+    sc.forcedReplies = forcedReplies;
+    sc.stop = stop;
+    sc.nodeLimit = nodeBudget();
+    sc.noise = noiseLevel();
+    sc.noiseSeed = noiseSeed;
+    sc.params = params;
+    if (rootFloor) sc.rootFloor = std::max(*rootFloor, -INF_SCORE);
 
-    // 根节点搜索
-    // 可以在此处添加时间限制检查
-    auto startTime = std::chrono::steady_clock::now();
-    int timeLimitMs = 15000; // 15秒限制
-    if (difficulty == 1) timeLimitMs = 1000;
-    if (difficulty == 2) timeLimitMs = 5000;
+    // 神经网络评估：累加器挂在模拟棋盘上，随 set/clear 增量更新
+    std::optional<NnueAccumulator> accumulator;
+    if (useNnue && NnueNetwork::active()) {
+        sc.net = NnueNetwork::active();
+        accumulator.emplace(*sc.net);
+        accumulator->refresh(simBoard);
+        simBoard.attach(&*accumulator);
+    }
+    sc.deadline = startTime + std::chrono::milliseconds(timeLimitMs);
 
-    for (const auto& p : moves) {
-        // 检查时间
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count() > timeLimitMs) {
-            if (bestMove.r == -1) bestMove = p;
-            break; 
+    PlyBuffers<Move>& root = prepareArena(sc, simBoard);
+    std::vector<Move>& moves = root.moves;
+    moves.clear();
+    uint8_t syms = 1;
+    if (rootSubset.empty()) {
+        syms = rootCandidates(simBoard, ctx, params.candidateRadius, symmetry, moves);
+    } else {
+        // 分布式搜索分到的根着法：协调方已做过候选生成、对称剪枝和排序（上一轮的最佳着法在前），按给定顺序搜
+        for (Move m : rootSubset) {
+            if (simBoard.isEmpty(m)) moves.push_back(m);
         }
+    }
+    if (rootSubset.empty()) orderMoves(moves, root.keys, root.scored, simBoard, mySide);
+
+    Move bestMove = moves.empty() ? Move() : moves[0];
+    stats = SearchStats();
+    stats.rootMoves = (int)moves.size();
+    long long prevScore = 0;
 
-        // 规则：白方第一手必须下在自己的半场（行 >= 7）
-        if (mySide == Side::White && ctx.turnIndex == 1) {
-            if (p.r < 7) continue;
+    // 持久缓存。子集或带下限的结果不是整个局面的结果，不读也不写缓存。
+    // 按时间搜索：键取规范哈希，互为镜像的局面共用一项，着法以规范方向存储；
+    // 命中且深度足够时直接返回，否则从缓存的深度继续加深。
+    // 按节点预算搜索（各难度的默认方式）：着法只由局面和预算决定，而镜像局面的着法顺序不同、结果未必是镜像，
+    // 从较浅的一层接着搜也会改变节点计数，所以键取原始哈希加预算、噪声和深度上限，只存完整搜索的结果，
+    // 命中即原样返回
+    bool cacheable = rootSubset.empty() && !rootFloor && !finalDepthOnly;
+    SearchCache* cache = cacheable ? SearchCache::active() : nullptr;
+    bool budgeted = sc.nodeLimit > 0;
+    bool whiteOpening = ctx.turnIndex == 1;
+    int cacheSym = 0;
+    uint64_t positionKey = (whiteOpening || budgeted) ? simBoard.hash() : simBoard.canonicalHash(&cacheSym);
+    uint64_t cacheKey = rootCacheKey(positionKey, mySide, whiteOpening, Rules::VARIANT, sc);
+    if (budgeted) cacheKey = budgetCacheKey(cacheKey, sc.nodeLimit, maxDepth);
+    // 只搜最后一层（分布式搜索由协调方做迭代加深）：窗口以下限为中心
+    int startDepth = finalDepthOnly ? maxDepth : 1;
+    if (finalDepthOnly && rootFloor) prevScore = sc.rootFloor;
+    uint32_t seededMs = 0;
+    SearchCache::Result cached;
+    if (cache && !moves.empty() && cache->probe(cacheKey, cached)) {
+        // 还原到当前方向；对称剪枝后它可能不是保留的代表，改用同一等价类中的着法
+        cached.move = Board::inverseTransform(cached.move, cacheSym);
+        auto it = moves.end();
+        for (int s = 0; s < 8 && it == moves.end(); ++s) {
+            if (!(syms & (1 << s))) continue;
+            it = std::find(moves.begin(), moves.end(), Board::transform(cached.move, s));
         }
-        
-        // 禁手检查
-        if (mySide == Side::Black && gomokuRules) {
-            std::string reason;
-            if (gomokuRules->isForbidden(simBoard, p, reason)) continue;
+        if (it != moves.end()) {
+            cached.move = *it;
+            std::rotate(moves.begin(), it, it + 1);
+            bestMove = cached.move;
+            prevScore = cached.score;
+            stats.depth = cached.depth;
+            stats.score = cached.score;
+            startDepth = cached.depth + 1;
+            seededMs = cached.searchMs;
+            bool solved = std::llabs(cached.score) >= WIN_SCORE - 100;
+            stats.solved = solved;
+            if (budgeted || cached.depth >= maxDepth || solved) {
+                cache->recordSaved(cached.searchMs);
+                action.move = bestMove;
+                return action;
+            }
         }
+    }
 
-        simBoard.set(p, mySide);
-        long long score = minimax(simBoard, maxDepth - 1, -std::numeric_limits<long long>::max(), std::numeric_limits<long long>::max(), false, mySide, oppSide, gomokuRules);
-        simBoard.clear(p);
+    long long completedMs = deepen<Rules>(sc, simBoard, moves, mySide, startDepth, maxDepth, startTime, timeLimitMs, bestMove, prevScore, stats);
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = p;
-        }
+    stats.nodes = sc.nodes;
+    stats.qnodes = sc.qnodes;
+    stats.forcedNodes = sc.forcedNodes;
+    stats.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    stats.timeCut = budgeted && sc.clockStopped && !stop.stopRequested();
+
+    if (cache) {
+        if (seededMs > 0) cache->recordSaved(seededMs);
+        // 记录到达该深度的总耗时，包括缓存起点之前省下的部分。
+        // 预算搜索连第一轮都没搜完时着法也由预算决定，照样存；被时钟或取消打断时结果不可复现，不存
+        bool store = budgeted ? !sc.clockStopped : stats.depth >= startDepth;
+        if (store) cache->store(cacheKey, {Board::transform(bestMove, cacheSym), stats.depth, stats.score, (uint32_t)(completedMs + seededMs)});
     }
 
-    action.pos = bestMove;
+    // 被外部取消且没有任何一轮完成：没有可信的着法
+    if (stop.stopRequested() && stats.depth == 0) {
+        action.type = ActionType::Cancelled;
+        return action;
+    }
+    action.move = bestMove;
     return action;
 }
+
+// 与 think 相同的根着法与顺序，供分布式搜索切分
+std::vector<Move> AIPlayer::rootMoves(const GameContext& ctx, const Board& board) const {
+    std::vector<Move> moves;
+    rootCandidates(board, ctx, params.candidateRadius, symmetry, moves);
+    std::vector<int> keys;
+    std::vector<ScoredMove<Move>> scored;
+    orderMoves(moves, keys, scored, board, ctx.toMove);
+    return moves;
+}
+
+// 无限棋盘（自由规则）：与 think 相同的迭代加深，但没有白方首手限制、对称剪枝、
+// 持久缓存和神经网络；每个节点只搜排序前 SPARSE_MAX_BRANCH 个着法
+Cell AIPlayer::getSparseMove(const SparseBoard& board, Side toMove, const StopToken& stop) {
+    TRACE_SCOPE("ai.move");
+    SparseBoard simBoard = board;
+    auto startTime = std::chrono::steady_clock::now();
+    int timeLimitMs = searchTimeLimit();
+
+    SearchContext<Cell> sc;
+    sc.quiescence = quiescence;
+    sc.forcedReplies = forcedReplies;
+    sc.stop = stop;
+    sc.nodeLimit = nodeBudget();
+    sc.noise = noiseLevel();
+    sc.noiseSeed = noiseSeed;
+    sc.params = params;
+    sc.deadline = startTime + std::chrono::milliseconds(timeLimitMs);
+
+    PlyBuffers<Cell>& root = prepareArena(sc, simBoard);
+    generateMoves(simBoard, toMove, params.candidateRadius, root);
+    std::vector<Cell>& moves = root.moves;
+
+    Cell bestMove = moves.empty() ? Cell() : moves[0];
+    stats = SearchStats();
+    stats.rootMoves = (int)moves.size();
+    long long prevScore = 0;
+    deepen<FreestylePolicy>(sc, simBoard, moves, toMove, 1, depthLimit(), startTime, timeLimitMs, bestMove, prevScore, stats);
+
+    stats.nodes = sc.nodes;
+    stats.qnodes = sc.qnodes;
+    stats.forcedNodes = sc.forcedNodes;
+    stats.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    stats.timeCut = sc.nodeLimit > 0 && sc.clockStopped && !stop.stopRequested();
+    return bestMove;
+}
+
+// 小棋盘：解库中的局面直接取库中着法（查表即得）；库外的局面在时间限制内
+// 现场精确求解，求解未完成时退回线势最大的空点
+int AIPlayer::getSmallBoardMove(const SmallBoard& board, const StopToken& stop) {
+    TRACE_SCOPE("ai.move");
+    auto startTime = std::chrono::steady_clock::now();
+    stats = SearchStats();
+    if (board.isFull()) return -1;
+
+    int cells[SmallBoard::MAX_CELLS];
+    int move = -1, value = 0;
+    bool proven = true;
+    if (board.winningCells(board.toMove(), cells) > 0) {
+        move = cells[0];
+        value = 1;
+    } else if (!solution || !solution->probe(board, value, move)) {
+        SmallBoardSolver solver(SMALL_BOARD_TABLE_MB);
+        int result = solver.solve(board, move, stop, startTime + std::chrono::milliseconds(timeLimit()));
+        stats.nodes = solver.stats().nodes;
+        proven = result >= -1;
+        value = proven ? result : 0;
+        if (!proven) move = -1;
+    }
+
+    // 库中没有着法（已输或胜负已定）或求解未完成：选线势最大的空点
+    if (move < 0) {
+        int bestWeight = -1;
+        for (int cell = 0; cell < board.cells(); ++cell) {
+            if (!board.isEmpty(cell)) continue;
+            int weight = board.potential(cell);
+            if (weight > bestWeight) {
+                bestWeight = weight;
+                move = cell;
+            }
+        }
+    }
+    stats.depth = proven ? board.cells() - board.stones() : 0;
+    stats.score = value;
+    stats.rootMoves = 1;
+    stats.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    return move;
+}
+
+// 多主变例分析：每一层对所有根着法搜索，窗口下界取当前第 N 好的分数，
+// 低于它的着法很快失败低出；进入前 N 的着法分数是精确值。
+AIPlayer::Analysis AIPlayer::analyze(const GameContext& ctx, const Board& board, const RuleSet& rules, int lineCount, int timeLimitMs,
+                                     const StopToken& stop, const std::function<void(const Analysis&)>& onDepth) {
+    switch (rules.variant()) {
+    case RuleVariant::Freestyle: return analyzeWith<FreestylePolicy>(ctx, board, lineCount, timeLimitMs, stop, onDepth);
+    case RuleVariant::Standard: return analyzeWith<StandardPolicy>(ctx, board, lineCount, timeLimitMs, stop, onDepth);
+    case RuleVariant::Renju: break;
+    }
+    return analyzeWith<RenjuPolicy>(ctx, board, lineCount, timeLimitMs, stop, onDepth);
+}
+
+template <class Rules>
+AIPlayer::Analysis AIPlayer::analyzeWith(const GameContext& ctx, const Board& board, int lineCount, int timeLimitMs,
+                                         const StopToken& stop, const std::function<void(const Analysis&)>& onDepth) {
+    Side mySide = ctx.toMove;
+    Side oppSide = opponentOf(mySide);
+    Board simBoard = board;
+
+    SearchContext<Move> sc;
+    sc.quiescence = quiescence;
+    sc.forcedReplies = forcedReplies;
+    sc.stop = stop;
+    sc.nodeLimit = std::max(0LL, nodeLimit);   // 提示分析按时间，不用难度的预算和噪声
+    sc.params = params;
+    std::unique_ptr<NnueAccumulator> accumulator;
+    if (useNnue && NnueNetwork::active()) {
+        sc.net = NnueNetwork::active();
+        accumulator = std::make_unique<NnueAccumulator>(*sc.net);
+        accumulator->refresh(simBoard);
+        simBoard.attach(accumulator.get());
+    }
+    sc.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimitMs);
+
+    std::vector<Move> moves;
+    rootCandidates(simBoard, ctx, params.candidateRadius, false, moves);
+    std::vector<int> keys;
+    std::vector<ScoredMove<Move>> scored;
+    orderMoves(moves, keys, scored, simBoard, mySide);
+    prepareArena(sc, simBoard);
+
+    Analysis result;
+    for (int depth = 1; depth <= MAX_HARD_DEPTH && !moves.empty(); ++depth) {
+        std::vector<PvLine> lines;
+        for (const auto& p : moves) {
+            long long alpha = ((int)lines.size() >= lineCount) ? lines.back().score : -INF_SCORE;
+            PvLine line{p, 0, {p}};
+            if (isWinningMove<Rules>(simBoard, p, mySide)) {
+                line.score = WIN_SCORE - 1;
+            } else {
+                simBoard.set(p, mySide);
+                if (Rules::isForbidden(simBoard, p.pos(), mySide)) {
+                    simBoard.clear(p);
+                    continue;
+                }
+                line.score = -searchAs<Rules>(oppSide, sc, simBoard, depth - 1, -INF_SCORE, -alpha, 1);
+                simBoard.clear(p);
+                if (sc.aborted) break;
+                for (int i = 0; i < sc.pvLength[1]; ++i) line.pv.push_back(sc.pv[1][i]);
+            }
+            if (line.score <= alpha) continue; // 不在前 N 之内（只是上界）
+            if (std::llabs(line.score) >= WIN_SCORE - 100) line.forced = (line.score > 0) ? 1 : -1;
+
+            auto at = std::find_if(lines.begin(), lines.end(), [&](const PvLine& l) { return l.score < line.score; });
+            lines.insert(at, std::move(line));
+            if ((int)lines.size() > lineCount) lines.pop_back();
+        }
+        if (sc.aborted) break; // 未完成的一层不可信
+
+        result.depth = depth;
+        result.lines = lines;
+        if (onDepth) onDepth(result);
+
+        // 下一层先搜本层的前 N 个着法
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+            auto m = std::find(moves.begin(), moves.end(), it->move);
+            std::rotate(moves.begin(), m, m + 1);
+        }
+        if (!lines.empty() && std::llabs(lines.front().score) >= WIN_SCORE - 100) break;
+    }
+    return result;
+}
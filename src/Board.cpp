@@ -1,14 +1,99 @@
 #include "../include/Board.h"
+#include "../include/Nnue.h"
+#include <utility>
+
+// Fixed-seed splitmix64 so that hashes are identical in every run and build
+static std::array<uint64_t, Board::SIZE * Board::SIZE * 2> makeZobristTable() {
+    std::array<uint64_t, Board::SIZE * Board::SIZE * 2> table{};
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& key : table) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        key = z ^ (z >> 31);
+    }
+    return table;
+}
+
+uint64_t Board::zobristKey(Move m, Side s) {
+    static const auto table = makeZobristTable();
+    if (s == Side::None) return 0;
+    return table[m.index * 2 + (s == Side::Black ? 0 : 1)];
+}
+
+// imageKeys()[sym][key]: the key of the stone whose image under sym is there,
+// so set() can keep the hash of every mirror image of the position
+static const std::array<std::array<uint64_t, Board::SIZE * Board::SIZE * 2>, 8>& imageKeys() {
+    static const auto table = [] {
+        std::array<std::array<uint64_t, Board::SIZE * Board::SIZE * 2>, 8> keys{};
+        for (int sym = 0; sym < 8; ++sym) {
+            for (int i = 0; i < Board::SIZE * Board::SIZE; ++i) {
+                Move image = Board::transform(Move::fromIndex(i), sym);
+                keys[sym][i * 2] = Board::zobristKey(image, Side::Black);
+                keys[sym][i * 2 + 1] = Board::zobristKey(image, Side::White);
+            }
+        }
+        return keys;
+    }();
+    return table;
+}
+
+Move Board::transform(Move m, int sym) {
+    int r = m.row(), c = m.col();
+    if (sym & 4) std::swap(r, c);
+    if (sym & 1) c = SIZE - 1 - c;
+    if (sym & 2) r = SIZE - 1 - r;
+    return Move::at(r, c);
+}
+
+Move Board::inverseTransform(Move m, int sym) {
+    int r = m.row(), c = m.col();
+    if (sym & 2) r = SIZE - 1 - r;
+    if (sym & 1) c = SIZE - 1 - c;
+    if (sym & 4) std::swap(r, c);
+    return Move::at(r, c);
+}
+
+uint8_t Board::symmetries() const {
+    uint8_t mask = 1;
+    for (int sym = 1; sym < 8; ++sym) {
+        bool same = true;
+        for (int i = 0; i < SIZE * SIZE && same; ++i) {
+            if (cells[i] != Side::None) same = cells[transform(Move::fromIndex(i), sym).index] == cells[i];
+        }
+        if (same) mask |= (uint8_t)(1 << sym);
+    }
+    return mask;
+}
+
+uint64_t Board::canonicalHash(int* sym) const {
+    int bestSym = 0;
+    for (int s = 1; s < 8; ++s) {
+        if (images[s] < images[bestSym]) bestSym = s;
+    }
+    if (sym) *sym = bestSym;
+    return images[bestSym];
+}
 
 Board::Board() {
     reset();
 }
 
+Board::Board(const Board& other) : cells(other.cells), stoneCount(other.stoneCount), images(other.images) {}
+
+Board& Board::operator=(const Board& other) {
+    cells = other.cells;
+    stoneCount = other.stoneCount;
+    images = other.images;
+    if (accumulator) accumulator->refresh(*this);
+    return *this;
+}
+
 void Board::reset() {
-    for (auto& row : grid) {
-        row.fill(Side::None);
-    }
+    cells.fill(Side::None);
     stoneCount = 0;
+    images.fill(0);
+    if (accumulator) accumulator->refresh(*this);
 }
 
 bool Board::isValid(Pos p) const {
@@ -16,7 +101,7 @@ bool Board::isValid(Pos p) const {
 }
 
 bool Board::isEmpty(Pos p) const {
-    return isValid(p) && grid[p.r][p.c] == Side::None;
+    return isValid(p) && cells[p.r * SIZE + p.c] == Side::None;
 }
 
 bool Board::isFull() const {
@@ -25,18 +110,28 @@ bool Board::isFull() const {
 
 Side Board::get(Pos p) const {
     if (!isValid(p)) return Side::None;
-    return grid[p.r][p.c];
+    return cells[p.r * SIZE + p.c];
 }
 
 void Board::set(Pos p, Side s) {
-    if (isValid(p)) {
-        if (grid[p.r][p.c] == Side::None && s != Side::None) {
-            stoneCount++;
-        } else if (grid[p.r][p.c] != Side::None && s == Side::None) {
-            stoneCount--;
-        }
-        grid[p.r][p.c] = s;
+    if (isValid(p)) set(Move(p), s);
+}
+
+void Board::set(Move m, Side s) {
+    Side& cell = cells[m.index];
+    if (cell == s) return;
+    if (cell == Side::None) {
+        stoneCount++;
+    } else if (s == Side::None) {
+        stoneCount--;
+    }
+    const auto& keys = imageKeys();
+    for (int sym = 0; sym < 8; ++sym) {
+        if (cell != Side::None) images[sym] ^= keys[sym][m.index * 2 + (cell == Side::Black ? 0 : 1)];
+        if (s != Side::None) images[sym] ^= keys[sym][m.index * 2 + (s == Side::Black ? 0 : 1)];
     }
+    if (accumulator) accumulator->update(m, cell, s);
+    cell = s;
 }
 
 void Board::clear(Pos p) {
@@ -0,0 +1,116 @@
+#include "../include/EvalWeights.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static const char* PATTERN_NAMES[PAT_COUNT] = {
+    "five", "open_four", "four", "open_three", "three", "open_two", "two", "single"
+};
+
+const char* EvalWeights::patternName(int pattern) {
+    return PATTERN_NAMES[pattern];
+}
+
+EvalWeights& EvalWeights::active() {
+    static EvalWeights weights;
+    return weights;
+}
+
+bool EvalWeights::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    EvalWeights loaded = *this;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string key;
+        long long value;
+        if (!(iss >> key >> value)) return false;
+
+        bool known = false;
+        if (key == "order.attack_factor") {
+            loaded.attackFactor = (int)value;
+            known = true;
+        }
+        for (int k = 0; k < PAT_COUNT && !known; ++k) {
+            if (key == std::string("board.") + PATTERN_NAMES[k]) {
+                loaded.board[k] = value;
+                known = true;
+            } else if (key == std::string("order.") + PATTERN_NAMES[k]) {
+                loaded.order[k] = (int)value;
+                known = true;
+            }
+        }
+        if (!known) return false;
+    }
+    *this = loaded;
+    return true;
+}
+
+bool EvalWeights::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "# Gomoku evaluation weights\n";
+    for (int k = 0; k < PAT_COUNT; ++k) out << "board." << PATTERN_NAMES[k] << " " << board[k] << "\n";
+    for (int k = 0; k < PAT_COUNT; ++k) out << "order." << PATTERN_NAMES[k] << " " << order[k] << "\n";
+    out << "order.attack_factor " << attackFactor << "\n";
+    return (bool)out;
+}
+
+uint64_t EvalWeights::fingerprint() const {
+    // FNV-1a over the values
+    uint64_t h = 0xCBF29CE484222325ULL;
+    auto mix = [&h](long long v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= (uint64_t)(v >> (i * 8)) & 0xFF;
+            h *= 0x100000001B3ULL;
+        }
+    };
+    for (int k = 0; k < PAT_COUNT; ++k) mix(board[k]);
+    for (int k = 0; k < PAT_COUNT; ++k) mix(order[k]);
+    mix(attackFactor);
+    return h;
+}
+
+bool EvalWeights::loadDefault() {
+    const char* env = std::getenv("GOMOKU_WEIGHTS");
+    if (env && active().load(env)) return true;
+    return active().load("../weights/eval.txt");
+}
+
+void extractEvalFeatures(const Board& board, Side mySide, Side oppSide, int features[PAT_COUNT]) {
+    for (int k = 0; k < PAT_COUNT; ++k) features[k] = 0;
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+    // 扫描整个棋盘（效率较低）
+    // 只扫描有棋子的线
+    // 使用简化的评估，只评估棋盘对 mySide 与 oppSide 的“潜力”。
+    auto countPos = [&](Pos p, Side side, int sign) {
+        for (auto& d : dirs) {
+            int count = 1;
+            int r, c;
+            // 正向
+            r = p.r + d[0]; c = p.c + d[1];
+            while (board.isValid({r, c}) && board.get({r, c}) == side) { count++; r += d[0]; c += d[1]; }
+            bool open1 = board.isValid({r, c}) && board.isEmpty({r, c});
+            // 反向
+            r = p.r - d[0]; c = p.c - d[1];
+            while (board.isValid({r, c}) && board.get({r, c}) == side) { count++; r -= d[0]; c -= d[1]; }
+            bool open2 = board.isValid({r, c}) && board.isEmpty({r, c});
+
+            int pattern = classifyRun(count, open1, open2);
+            if (pattern >= 0) features[pattern] += sign;
+        }
+    };
+
+    for (int r = 0; r < Board::SIZE; ++r) {
+        for (int c = 0; c < Board::SIZE; ++c) {
+            Pos p = {r, c};
+            Side s = board.get(p);
+            if (s == mySide) countPos(p, mySide, 1);
+            else if (s == oppSide) countPos(p, oppSide, -1);
+        }
+    }
+}
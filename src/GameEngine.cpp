@@ -2,8 +2,14 @@
 #include "../include/GomokuRuleSet.h"
 #include "../include/HumanPlayer.h"
 #include "../include/AIPlayer.h"
+#include "../include/MctsPlayer.h"
+#include "../include/GameRecord.h"
+#include "../include/Trace.h"
+#include <cstdlib>
 #include <iostream>
 #include <future>
+#include <atomic>
+#include <mutex>
 #include <thread>
 #include <conio.h> // For _kbhit, _getch
 #include <fstream>
@@ -12,16 +18,40 @@
 #include <filesystem>
 namespace fs = std::filesystem;
 
-GameEngine::GameEngine() {
-    rules = std::make_unique<GomokuRuleSet>();
+static const int HINT_LINES = 3;            // Suggestions shown by 'hint'
+static const int HINT_BUDGET_MS = 10000;    // Analysis stops after this, well inside the step time
+static const int AI_TIME_CAP = 3;           // An AI move stops at 3x its level's time limit even if its node budget is not spent
+
+// Player codes as stored in the journal: 0 = human, 4 = MCTS, otherwise the AI difficulty
+static std::unique_ptr<Player> makePlayer(int code) {
+    if (code == 0) return std::make_unique<HumanPlayer>();
+    if (code == 4) return std::make_unique<MctsPlayer>();
+    auto ai = std::make_unique<AIPlayer>(code);
+    ai->setBudgetTimeCap(AI_TIME_CAP);
+    return ai;
 }
 
+GameEngine::GameEngine() : session(std::make_shared<GomokuRuleSet>()), journal(MoveJournal::defaultPath()) {
+    // Spectators connect to $GOMOKU_SPECTATE (a UNIX socket path) and follow the game read-only
+    const char* spectatePath = std::getenv("GOMOKU_SPECTATE");
+    if (spectatePath && *spectatePath) {
+        spectatorServer = std::make_unique<SpectatorServer>(spectators, spectatePath);
+        if (!spectatorServer->start()) {
+            spectatorServer.reset();
+            spectateError = std::string("Spectating is off: cannot listen on ") + spectatePath;
+        }
+    }
+}
+
+GameEngine::~GameEngine() = default;
+
 void GameEngine::setup() {
     while (true) {
         // 清空终端
         std::cout << "\033[2J\033[H";
         
         std::cout << "Gomoku terminal demo\n";
+        if (!spectateError.empty()) std::cout << spectateError << "\n";
         std::cout << "Select Mode:\n";
         std::cout << "1. Human vs Human\n";
         std::cout << "2. Human vs AI (Human is Black)\n";
@@ -48,6 +78,7 @@ void GameEngine::setup() {
             std::cout << "1. Easy (Fast)\n";
             std::cout << "2. Medium (Balanced)\n";
             std::cout << "3. Hard (Slow)\n";
+            std::cout << "4. MCTS (Parallel, all cores)\n";
             std::cout << "Choice: ";
             if (!(std::cin >> aiLevel)) {
                 std::cin.clear();
@@ -57,40 +88,43 @@ void GameEngine::setup() {
             std::cin.ignore();
         }
 
-        if (choice == 1) {
-            blackPlayer = std::make_unique<HumanPlayer>();
-            whitePlayer = std::make_unique<HumanPlayer>();
-        } else if (choice == 2) {
-            blackPlayer = std::make_unique<HumanPlayer>();
-            whitePlayer = std::make_unique<AIPlayer>(aiLevel);
-        } else {
-            blackPlayer = std::make_unique<AIPlayer>(aiLevel);
-            whitePlayer = std::make_unique<HumanPlayer>();
-        }
+        if (aiLevel < 1 || aiLevel > 4) aiLevel = 2;
+        blackCode = (choice == 3) ? aiLevel : 0;
+        whiteCode = (choice == 2) ? aiLevel : 0;
+        blackPlayer = makePlayer(blackCode);
+        whitePlayer = makePlayer(whiteCode);
 
-        board.reset();
-        rules->initGame(ctx, board);
+        session.start();
         break;
     }
 }
 
 void GameEngine::run() {
+    const Board& board = session.getBoard();
+    GameContext& ctx = session.getContext();
     bool appRunning = true;
     bool needSetup = true;
+    bool resumed = resumeInterrupted();
 
     while (appRunning) {
-        if (needSetup) {
+        if (resumed) {
+            // Board, context and clock come from the journal; keep appending to it
+        } else if (needSetup) {
             setup();
         } else {
-            board.reset();
-            rules->initGame(ctx, board);
+            session.start();
         }
 
         bool running = true;
-    std::string message = "Game Start!";
+    std::string message = resumed ? "Game resumed." : "Game Start!";
     
-    auto gameStart = std::chrono::steady_clock::now();
-    ctx.totalGameDurationSeconds = 1800; // 30 分钟
+    auto gameStart = std::chrono::steady_clock::now() - std::chrono::seconds(resumed ? ctx.elapsedGameSeconds : 0);
+    if (!resumed) {
+        ctx.totalGameDurationSeconds = 1800; // 30 分钟
+        journal.begin(blackCode, whiteCode, ctx);
+    }
+    resumed = false;
+    spectators.publishBoard(ctx, board);
 
     while (running) {
         // 全局计时
@@ -115,6 +149,7 @@ void GameEngine::run() {
             
             if (otChoice == 1) ctx.totalGameDurationSeconds += 300;
             else ctx.totalGameDurationSeconds += 600;
+            journal.clock(ctx);
             
             message = "Overtime Started!";
             // Reset loop to re-check time and render
@@ -126,6 +161,7 @@ void GameEngine::run() {
         
         Action action;
         bool actionReceived = false;
+        bool aiTimeCut = false;     // The AI's move was stopped by AI_TIME_CAP, not by its node budget
         
         if (isHuman) {
             // 轮询等待玩家输入
@@ -133,6 +169,15 @@ void GameEngine::run() {
             auto periodStart = std::chrono::steady_clock::now();
             const int timeLimitSeconds = 15;
             int lastRemaining = -1;
+
+            // 'hint' starts a multi-PV analysis on a background thread; each
+            // completed depth bumps hintVersion and the loop below redraws
+            StopSource hintStop;
+            std::future<void> hintTask;
+            std::mutex hintMutex;
+            AIPlayer::Analysis hintResult;
+            std::atomic<int> hintVersion{0};
+            int shownHintVersion = 0;
             
             while (!actionReceived) {
                 auto now = std::chrono::steady_clock::now();
@@ -147,14 +192,41 @@ void GameEngine::run() {
                 if (remaining != lastRemaining || (ctx.elapsedGameSeconds % 60 == 0)) { // 至少每秒更新一次
                     std::string timeMsg = message + " [step time left: " + std::to_string(remaining) + "s]";
                     renderer.render(ctx, board, timeMsg, currentInput);
+                    if (remaining != lastRemaining) spectators.publishClock(ctx, remaining);
                     lastRemaining = remaining;
                 }
 
                 // Check input
+                if (hintVersion != shownHintVersion) {
+                    std::lock_guard<std::mutex> lock(hintMutex);
+                    renderer.setHints(hintResult.lines, hintResult.depth);
+                    shownHintVersion = hintVersion;
+                    lastRemaining = -1;
+                }
+
                 if (_kbhit()) {
+                    TRACE_SCOPE("engine.input");
                     int ch = _getch();
                     if (ch == '\r' || ch == '\n') {
                         action = HumanPlayer::parseCommand(currentInput);
+                        if (action.type == ActionType::Hint) {
+                            if (!hintTask.valid()) {
+                                StopToken token = hintStop.token();
+                                hintTask = std::async(std::launch::async, [&, token]() {
+                                    AIPlayer analyst(3);
+                                    analyst.analyze(ctx, board, session.getRules(), HINT_LINES, HINT_BUDGET_MS, token,
+                                                    [&](const AIPlayer::Analysis& analysis) {
+                                        std::lock_guard<std::mutex> lock(hintMutex);
+                                        hintResult = analysis;
+                                        hintVersion++;
+                                    });
+                                });
+                            }
+                            message = "Analysing...";
+                            currentInput.clear();
+                            lastRemaining = -1;
+                            continue;
+                        }
                         actionReceived = true;
                         std::cout << "\n";
                     } else if (ch == '\b' || ch == 127) {
@@ -172,9 +244,11 @@ void GameEngine::run() {
                 
                 if (elapsed >= timeLimitSeconds && !actionReceived) {
                      // 超时
-                    Outcome outcome = rules->onTimeout(ctx, ctx.toMove);
+                    Outcome outcome = session.timeout();
+                    journal.timeout(ctx);
                     message = outcome.reason;
                     if (outcome.status == GameStatus::TimeoutLose) {
+                        spectators.publishEnd(outcome);
                         renderer.render(ctx, board, "超时判负! " + message, currentInput);
                         running = false;
                         std::cout << "\n游戏结束 (超时). 按回车键退出。\n";
@@ -189,80 +263,108 @@ void GameEngine::run() {
                 
                 std::this_thread::sleep_for(std::chrono::milliseconds(50));
             }
+
+            hintStop.requestStop();
+            if (hintTask.valid()) hintTask.wait();
+            renderer.clearHints();
         } else {
             // AI Logic (Async)
-            renderer.render(ctx, board, message + " (AI Thinking...)", "");
-            
-            auto future = std::async(std::launch::async, [&]() {
-                return currentPlayer->getAction(ctx, board, *rules);
+            // The search runs in the background with a stop token: the game
+            // clock running out, Esc (quit) or a typed 'undo' stops it within
+            // a few milliseconds instead of waiting for the full think time.
+            TRACE_SCOPE("engine.ai_turn");
+            renderer.render(ctx, board, message + " (AI Thinking... Esc to quit)", "");
+
+            StopSource stopSource;
+            StopToken stopToken = stopSource.token();
+            auto future = std::async(std::launch::async, [&, stopToken]() {
+                return currentPlayer->getAction(ctx, board, session.getRules(), stopToken);
             });
-            
-            // We can just wait for AI, assuming AI is fast enough or doesn't need strict timeout enforcement like Human
-            // Or we can enforce timeout for AI too if needed.
-            // For now, just wait.
+
+            std::string currentInput = "";
+            bool quitRequested = false;
+            bool undoRequested = false;
+            long long lastClock = ctx.elapsedGameSeconds;
+            while (future.wait_for(std::chrono::milliseconds(20)) != std::future_status::ready) {
+                ctx.elapsedGameSeconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - gameStart).count();
+                if (ctx.elapsedGameSeconds != lastClock) {
+                    lastClock = ctx.elapsedGameSeconds;
+                    spectators.publishClock(ctx, -1); // No step clock for the AI
+                }
+                if (ctx.elapsedGameSeconds >= ctx.totalGameDurationSeconds) {
+                    stopSource.requestStop(); // Take the best move so far; overtime follows
+                }
+
+                if (_kbhit()) {
+                    int ch = _getch();
+                    if (ch == 27) {
+                        quitRequested = true;
+                        stopSource.requestStop();
+                    } else if (ch == '\r' || ch == '\n') {
+                        if (HumanPlayer::parseCommand(currentInput).type == ActionType::Undo) {
+                            undoRequested = true;
+                            stopSource.requestStop();
+                        }
+                        currentInput.clear();
+                        renderer.render(ctx, board, message + " (AI Thinking... Esc to quit)", currentInput);
+                    } else if (ch == '\b' || ch == 127) {
+                        if (!currentInput.empty()) currentInput.pop_back();
+                        renderer.render(ctx, board, message + " (AI Thinking... Esc to quit)", currentInput);
+                    } else if (ch >= 32 && ch <= 126) {
+                        currentInput += (char)ch;
+                        renderer.render(ctx, board, message + " (AI Thinking... Esc to quit)", currentInput);
+                    }
+                }
+            }
             action = future.get();
+
+            if (quitRequested) {
+                renderer.render(ctx, board, "Game abandoned.");
+                running = false;
+            } else if (undoRequested) {
+                // The AI has not moved yet: take back the human's last move only. Before the
+                // human has moved, the only stone is the automatic Tengen, which stays.
+                if (ctx.history.size() <= 1) {
+                    message = "Nothing to undo: you have not moved yet.";
+                    continue;
+                }
+                Action undo{ActionType::Undo, Move(), 0};
+                GameSession::MoveResult result = submitAction(undo, 1);
+                message = result.message;
+                spectators.publishBoard(ctx, board);
+                continue;
+            } else if (action.type == ActionType::Cancelled) {
+                continue; // Stopped by the game clock before any move was found; overtime is handled above
+            }
+            auto* ai = dynamic_cast<AIPlayer*>(currentPlayer);
+            aiTimeCut = ai && ai->lastStats().timeCut;
             actionReceived = true;
         }
 
         if (!running) break;
 
+        int undoPlies = 1;
         if (action.type == ActionType::Undo) {
-            // Undo Logic
-            int undoSteps = 0;
             bool isPvE = (blackPlayer->name() == "AI" || whitePlayer->name() == "AI");
-            
-            if (isPvE) {
-                // In PvE, undo 2 steps to get back to human turn
-                // Unless only 1 move has been made (e.g. Black Human played, then undo immediately before White AI moves? 
-                // No, AI moves immediately. So usually we are at turnIndex N.
-                // If it's Human's turn, it means AI just moved? No.
-                // Wait. If it is Human's turn, the LAST move was AI.
-                // So if Human says "undo", they want to undo AI's move AND their own previous move.
-                undoSteps = 2;
-            } else {
-                // PvP: Undo 1 step
-                undoSteps = 1;
-            }
-
-            if (ctx.history.size() < undoSteps) {
-                message = "Cannot undo: Not enough history.";
-                continue;
-            }
-
-            for (int i = 0; i < undoSteps; ++i) {
-                auto last = ctx.history.back();
-                ctx.history.pop_back();
-                if (last.second.type == ActionType::Place && last.second.pos.has_value()) {
-                    board.clear(last.second.pos.value());
-                }
-                // Revert context
-                ctx.turnIndex--;
-                ctx.toMove = (ctx.toMove == Side::Black) ? Side::White : Side::Black;
-                // Reset warnings/phase if needed? 
-                // Simplifying: Just keep warnings. Phase might need revert if we crossed opening.
-                if (ctx.turnIndex <= 2) ctx.phase = Phase::Opening;
-                else ctx.phase = Phase::Normal;
-                ctx.pendingForbidden = false; // Clear pending claim
-            }
-            
-            message = "Undo successful.";
-            continue;
+            // In PvE it is the human's turn, so the last move was the AI's:
+            // undo it together with the human's previous move.
+            undoPlies = isPvE ? 2 : 1;
         }
 
         // 落子后的判定逻辑
-        std::string reason;
-        if (!rules->validateAction(ctx, board, ctx.toMove, action, reason)) {
-            message = "Invalid Action: " + reason;
+        GameSession::MoveResult result = submitAction(action, undoPlies);
+        if (!result.applied) {
+            message = (action.type == ActionType::Undo) ? result.message : "Invalid Action: " + result.message;
+            if (action.type == ActionType::Undo) spectators.publishBoard(ctx, board);
             continue;
         }
 
-        Side justMoved = ctx.toMove;
-
-        rules->applyAction(ctx, board, justMoved, action);
-        ctx.history.push_back(std::make_pair(justMoved, action));
-
-        Outcome outcome = rules->evaluateAfterAction(ctx, board, justMoved, action);
-        
+        const Outcome& outcome = result.outcome;
+        if (action.type == ActionType::Place) spectators.publishMove(ctx, board, ctx.history.back());
+        else spectators.publishBoard(ctx, board);
+        if (outcome.status == GameStatus::Win || outcome.status == GameStatus::Draw || outcome.status == GameStatus::Forbidden) {
+            spectators.publishEnd(outcome);
+        }
         if (outcome.status == GameStatus::Win) {
             renderer.render(ctx, board, "WINNER: " + (outcome.winner == Side::Black ? std::string("Black") : std::string("White")) + " (" + outcome.reason + ")");
             running = false;
@@ -274,12 +376,12 @@ void GameEngine::run() {
              running = false;
         } else if (outcome.status == GameStatus::PendingClaim) {
             message = "WARNING: Black played a forbidden move (" + outcome.reason + "). White can 'claim' to win! Type 'claim' to put up your hands.";
-            ctx.phase = Phase::PendingClaim;
-            ctx.pendingForbidden = true;
         } else {
-            message = "";
+            message = aiTimeCut ? "The AI ran out of time before finishing its search; it may play below its level on this machine." : "";
         }
     }
+        // The game is over (or abandoned): nothing left to resume
+        journal.end(ctx);
     
         // Post-game menu
         bool inMenu = true;
@@ -321,7 +423,48 @@ void GameEngine::run() {
     }
 }
 
+// An unfinished game in the journal (crash, kill, closed terminal): offer to continue it
+bool GameEngine::resumeInterrupted() {
+    std::vector<MoveJournal::Record> records;
+    if (!MoveJournal::load(journal.path(), records) || MoveJournal::finished(records)) return false;
+
+    int moves = 0;
+    for (const auto& record : records) {
+        if (record.kind == MoveJournal::Kind::Action) moves++;
+    }
+    std::cout << "An unfinished game was found (" << moves << " actions). Resume it? [y/n]: ";
+    std::string answer;
+    std::getline(std::cin, answer);
+    if (answer.empty() || (answer[0] != 'y' && answer[0] != 'Y')) return false;
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = MoveJournal::replay(records, session);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+    if (!ok || session.finished()) {
+        std::cout << "The journal could not be resumed; starting a new game.\n";
+        session.start();
+        return false;
+    }
+    blackCode = records.front().arg & 0x0F;
+    whiteCode = records.front().arg >> 4;
+    blackPlayer = makePlayer(blackCode);
+    whitePlayer = makePlayer(whiteCode);
+    std::cout << "Restored " << moves << " actions in " << micros << " us.\n";
+    return true;
+}
+
+GameSession::MoveResult GameEngine::submitAction(const Action& action, int undoPlies) {
+    GameContext& ctx = session.getContext();
+    Side side = ctx.toMove;
+    size_t before = ctx.history.size();
+    GameSession::MoveResult result = session.submit(action, undoPlies);
+    if (result.applied || ctx.history.size() != before) journal.action(side, action, undoPlies, ctx);
+    return result;
+}
+
 void GameEngine::saveGameRecord() {
+    const Board& board = session.getBoard();
+    const GameContext& ctx = session.getContext();
     // Save to ../match so it is a sibling of build directory
     std::string dir = "../match";
     if (!fs::exists(dir)) {
@@ -336,61 +479,14 @@ void GameEngine::saveGameRecord() {
 
     std::ofstream outfile(filename);
     if (outfile.is_open()) {
-        outfile << "Gomoku Game Record\n";
-        outfile << "Date: " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "\n";
-        outfile << "Black: " << (blackPlayer ? blackPlayer->name() : "Unknown") << "\n";
-        outfile << "White: " << (whitePlayer ? whitePlayer->name() : "Unknown") << "\n";
-        
-        outfile << "\n--- Move History ---\n";
-        int moveNum = 1;
-        for (const auto& move : ctx.history) {
-            outfile << moveNum++ << ". " << (move.first == Side::Black ? "Black" : "White");
-            if (move.second.type == ActionType::Place && move.second.pos.has_value()) {
-                outfile << " (" << move.second.pos->r << "," << move.second.pos->c << ")";
-            } else if (move.second.type == ActionType::Resign) {
-                outfile << " Resigns";
-            } else if (move.second.type == ActionType::ClaimForbidden) {
-                outfile << " Claims Forbidden";
-            }
-            outfile << " [" << move.second.spent.count() << "ms]\n";
-        }
-
-        outfile << "\n--- Final Board ---\n";
-        outfile << "   ";
-        for (int c = 0; c < Board::SIZE; ++c) outfile << (char)('A' + c) << " ";
-        outfile << "\n";
-        
-        auto getGridChar = [](int r, int c) -> std::string {
-            if (r == 0) {
-                if (c == 0) return "┌";
-                if (c == Board::SIZE - 1) return "┐";
-                return "┬";
-            }
-            if (r == Board::SIZE - 1) {
-                if (c == 0) return "└";
-                if (c == Board::SIZE - 1) return "┘";
-                return "┴";
-            }
-            if (c == 0) return "├";
-            if (c == Board::SIZE - 1) return "┤";
-            if (r == 7 && c == 7) return "╋";
-            return "┼";
-        };
-
-        for (int r = 0; r < Board::SIZE; ++r) {
-            outfile << (r + 1 < 10 ? " " : "") << (r + 1) << " ";
-            for (int c = 0; c < Board::SIZE; ++c) {
-                Side s = board.get({r, c});
-                std::string symbol;
-                if (s == Side::Black) symbol = "○";
-                else if (s == Side::White) symbol = "●";
-                else symbol = getGridChar(r, c);
-                
-                outfile << symbol;
-                if (c < Board::SIZE - 1) outfile << "─";
-            }
-            outfile << "\n";
-        }
+        std::ostringstream date;
+        date << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+        GameRecord record;
+        record.date = date.str();
+        record.black = blackPlayer ? blackPlayer->name() : "Unknown";
+        record.white = whitePlayer ? whitePlayer->name() : "Unknown";
+        record.moves = ctx.history;
+        writeGameRecord(outfile, record, board);
         outfile.close();
         std::cout << "Game saved to " << filename << "\n";
     } else {
@@ -442,36 +538,11 @@ void GameEngine::loadAndReplay() {
     }
 
     // Parse moves
-    std::vector<std::pair<Side, Pos>> moves;
-    std::string line;
-    bool inHistory = false;
-    while (std::getline(infile, line)) {
-        if (line.find("--- Move History ---") != std::string::npos) {
-            inHistory = true;
-            continue;
-        }
-        if (line.find("--- Final Board ---") != std::string::npos) {
-            break;
-        }
-        if (inHistory && !line.empty()) {
-            // Format: "1. Black (7,7) [0ms]"
-            // Simple parsing
-            size_t openParen = line.find('(');
-            size_t comma = line.find(',');
-            size_t closeParen = line.find(')');
-            
-            if (openParen != std::string::npos && comma != std::string::npos && closeParen != std::string::npos) {
-                std::string rStr = line.substr(openParen + 1, comma - openParen - 1);
-                std::string cStr = line.substr(comma + 1, closeParen - comma - 1);
-                
-                try {
-                    int r = std::stoi(rStr);
-                    int c = std::stoi(cStr);
-                    Side s = (line.find("Black") != std::string::npos) ? Side::Black : Side::White;
-                    moves.push_back({s, {r, c}});
-                } catch (...) {}
-            }
-        }
+    GameRecord record;
+    readGameRecord(infile, record);
+    std::vector<HistoryEntry> moves;
+    for (const auto& move : record.moves) {
+        if (move.type() == ActionType::Place && !move.move.isNone()) moves.push_back(move);
     }
     infile.close();
 
@@ -485,13 +556,13 @@ void GameEngine::loadAndReplay() {
         replayBoard.reset();
         for (int i = 0; i < currentStep; ++i) {
             if (i < moves.size()) {
-                replayBoard.set(moves[i].second, moves[i].first);
+                replayBoard.set(moves[i].move, moves[i].side());
             }
         }
 
         // Render
         GameContext dummyCtx; // Just for rendering
-        dummyCtx.toMove = (currentStep < moves.size()) ? moves[currentStep].first : Side::None;
+        dummyCtx.toMove = (currentStep < moves.size()) ? moves[currentStep].side() : Side::None;
 
         // manually render or reuse renderer with a custom message.
         std::string msg = "Replay Mode: Step " + std::to_string(currentStep) + "/" + std::to_string(moves.size());
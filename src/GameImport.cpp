@@ -0,0 +1,376 @@
+#include "../include/GameImport.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+const char* importFormatName(ImportFormat format) {
+    switch (format) {
+    case ImportFormat::Record: return "record";
+    case ImportFormat::Psq: return "psq";
+    case ImportFormat::RenLib: return "renlib";
+    case ImportFormat::MoveList: return "moves";
+    }
+    return "?";
+}
+
+bool GameReader::openFile(const std::string& path) {
+    // A larger stream buffer than the default; must be set before open
+    buffer.resize(1 << 16);
+    in.rdbuf()->pubsetbuf(buffer.data(), (std::streamsize)buffer.size());
+    in.open(path, std::ios::binary);
+    if (!in.is_open()) failure = "cannot open file";
+    return in.is_open();
+}
+
+bool GameReader::readLine(std::string& line, bool& tooLong) {
+    tooLong = false;
+    line.resize(MAX_LINE);
+    in.getline(&line[0], (std::streamsize)MAX_LINE);
+    std::streamsize n = in.gcount();
+    if (n == 0 && in.fail()) return false;
+    bytes += (uint64_t)n;
+
+    size_t length = (size_t)n;
+    if (in.eof()) {
+        in.clear(std::ios::eofbit);     // Last line without an end
+    } else if (in.fail()) {
+        // No line end within MAX_LINE: keep the start, skip the rest
+        tooLong = true;
+        in.clear();
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        bytes += (uint64_t)in.gcount();
+    } else {
+        length--;                       // The '\n' was counted but not stored
+    }
+    line.resize(length);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+}
+
+static void addPlace(GameRecord& record, int r, int c) {
+    Side side = (record.moves.size() % 2 == 0) ? Side::Black : Side::White;
+    record.moves.push_back(HistoryEntry(side, Action{ActionType::Place, Move::at(r, c), 0}));
+}
+
+namespace {
+
+class RecordReader : public GameReader {
+public:
+    explicit RecordReader(const std::string& path) {
+        if (!openFile(path)) return;
+        std::error_code ec;
+        fileSize = fs::file_size(path, ec);
+    }
+
+    bool next(ImportedGame& game) override {
+        game = ImportedGame();
+        if (!in.is_open() || !readGameRecord(in, game.record)) {
+            bytes = fileSize;
+            return false;
+        }
+        std::streamoff pos = in.tellg();
+        bytes = pos >= 0 ? (uint64_t)pos : fileSize;
+        return true;
+    }
+
+private:
+    uint64_t fileSize = 0;
+};
+
+class PsqReader : public GameReader {
+public:
+    explicit PsqReader(const std::string& path) { openFile(path); }
+
+    bool next(ImportedGame& game) override {
+        game = ImportedGame();
+        if (!in.is_open()) return false;
+        bool started = false, inMoves = false, tooLong = false;
+        int names = 0;
+        std::string line;
+        while (pending || readLine(line, tooLong)) {
+            if (pending) {
+                line.swap(header);
+                pending = false;
+            }
+            if (tooLong) game.problem = "line too long";
+
+            if (line.rfind("Piskvork", 0) == 0) {
+                if (started) {
+                    // The next game's header: keep it for the next call
+                    header.swap(line);
+                    pending = true;
+                    return true;
+                }
+                started = inMoves = true;
+                int width = 0, height = 0;
+                size_t space = line.find(' ');
+                if (space == std::string::npos || std::sscanf(line.c_str() + space, " %dx%d", &width, &height) != 2) {
+                    game.problem = "unreadable header";
+                } else if (width != Board::SIZE || height != Board::SIZE) {
+                    game.boardSize = std::max(width, height);
+                }
+                continue;
+            }
+
+            int x, y, ms = 0;
+            if (!started && !line.empty()) started = inMoves = true;   // No header: moves right away
+            if (inMoves && std::sscanf(line.c_str(), "%d,%d,%d", &x, &y, &ms) >= 2) {
+                addPlace(game.record, y - 1, x - 1);
+                if (ms > 0) game.record.moves.back().spentMs = (uint16_t)std::min(ms, 0xFFFF);
+                continue;
+            }
+            inMoves = false;
+            // After the moves: the two player names, then result codes and other numbers
+            if (line.empty() || std::isdigit((unsigned char)line[0]) || line[0] == '-') continue;
+            if (names == 0) game.record.black = line;
+            else if (names == 1) game.record.white = line;
+            names++;
+        }
+        return started;
+    }
+
+private:
+    std::string header;
+    bool pending = false;
+};
+
+class MoveListReader : public GameReader {
+public:
+    explicit MoveListReader(const std::string& path) { openFile(path); }
+
+    bool next(ImportedGame& game) override {
+        if (!in.is_open()) return false;
+        std::string line;
+        bool tooLong = false;
+        while (readLine(line, tooLong)) {
+            game = ImportedGame();
+            if (tooLong) game.problem = "line too long";
+            parse(line, game);
+            if (!game.record.moves.empty() || !game.problem.empty()) return true;
+        }
+        return false;
+    }
+
+private:
+    static void parse(const std::string& line, ImportedGame& game) {
+        const char* p = line.c_str();
+        while (*p && *p != '#') {
+            if (std::strncmp(p, "1/2-1/2", 7) == 0) {
+                game.result = ImportedGame::Result::Draw;
+                p += 7;
+            } else if (std::strncmp(p, "1-0", 3) == 0) {
+                game.result = ImportedGame::Result::BlackWins;
+                p += 3;
+            } else if (std::strncmp(p, "0-1", 3) == 0) {
+                game.result = ImportedGame::Result::WhiteWins;
+                p += 3;
+            } else if (std::isalpha((unsigned char)*p)) {
+                int col = std::tolower((unsigned char)*p++) - 'a';
+                int row = 0, digits = 0;
+                while (std::isdigit((unsigned char)*p)) {
+                    row = row * 10 + (*p++ - '0');
+                    if (++digits > 2) break;
+                }
+                if (digits == 0 || digits > 2) {
+                    if (game.problem.empty()) game.problem = "unreadable move";
+                    return;
+                }
+                addPlace(game.record, row - 1, col);
+            } else if (std::isdigit((unsigned char)*p)) {
+                while (std::isdigit((unsigned char)*p)) p++;    // A move number
+            } else {
+                p++;                                            // Separators
+            }
+        }
+    }
+};
+
+// RenLib library: a 20-byte header, then the tree in preorder, one node per
+// two bytes: the move (0 = none; low nibble column from 1, high nibble row)
+// and flags. A node with DOWN is followed by its first child, one with RIGHT
+// has a next sibling after its subtree. Comments follow their node as
+// zero-terminated text padded to an even length.
+class RenLibReader : public GameReader {
+public:
+    explicit RenLibReader(const std::string& path) {
+        if (!openFile(path)) return;
+        unsigned char head[20];
+        if (!in.read(reinterpret_cast<char*>(head), sizeof(head)) || head[0] != 0xFF || std::memcmp(head + 1, "RenLib", 6) != 0) {
+            failure = "not a RenLib file";
+            done = true;
+            return;
+        }
+        bytes = sizeof(head);
+    }
+
+    bool next(ImportedGame& game) override {
+        unsigned char node[2];
+        while (!done && read(node, 2)) {
+            uint8_t flags = node[1];
+            if (flags & EXTENSION) {
+                unsigned char extra[2];
+                if (!read(extra, 2)) break;
+            }
+            if ((flags & (COMMENT | OLD_COMMENT)) && !skipText()) break;
+
+            if (path.size() > MAX_DEPTH) {
+                failure = "tree deeper than a game";
+                break;
+            }
+            if (flags & RIGHT) siblings.push_back(path.size());
+            path.push_back((flags & NO_MOVE) ? 0 : node[0]);
+            if (flags & DOWN) continue;
+
+            // A leaf: the path from the root is one game
+            game = ImportedGame();
+            for (uint8_t pos : path) {
+                if (pos == 0) continue;
+                if ((pos & 0x0F) == 0) game.problem = "unreadable move";
+                addPlace(game.record, pos >> 4, (pos & 0x0F) - 1);
+            }
+            if (siblings.empty()) {
+                done = true;
+            } else {
+                path.resize(siblings.back());
+                siblings.pop_back();
+            }
+            if (!game.record.moves.empty()) return true;
+        }
+        done = true;
+        return false;
+    }
+
+private:
+    static const uint8_t DOWN = 0x80, RIGHT = 0x40, OLD_COMMENT = 0x20, COMMENT = 0x08, NO_MOVE = 0x02, EXTENSION = 0x01;
+    static const size_t MAX_DEPTH = Board::SIZE * Board::SIZE + 1;
+
+    std::vector<uint8_t> path;          // Moves from the root to the current node
+    std::vector<size_t> siblings;       // Depths of open nodes that have a next sibling
+    bool done = false;
+
+    bool read(unsigned char* data, size_t n) {
+        if (!in.read(reinterpret_cast<char*>(data), (std::streamsize)n)) {
+            if (in.gcount() != 0) failure = "truncated file";
+            return false;
+        }
+        bytes += n;
+        return true;
+    }
+
+    bool skipText() {
+        unsigned char pair[2];
+        do {
+            if (!read(pair, 2)) {
+                failure = "truncated comment";
+                return false;
+            }
+        } while (pair[0] != 0 && pair[1] != 0);
+        return true;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<GameReader> GameReader::open(const std::string& path, ImportFormat format) {
+    switch (format) {
+    case ImportFormat::Record: return std::make_unique<RecordReader>(path);
+    case ImportFormat::Psq: return std::make_unique<PsqReader>(path);
+    case ImportFormat::RenLib: return std::make_unique<RenLibReader>(path);
+    case ImportFormat::MoveList: return std::make_unique<MoveListReader>(path);
+    }
+    return nullptr;
+}
+
+ImportFormat GameReader::detect(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    for (char& ch : ext) ch = (char)std::tolower((unsigned char)ch);
+    if (ext == ".psq") return ImportFormat::Psq;
+    if (ext == ".lib") return ImportFormat::RenLib;
+
+    std::ifstream file(path, std::ios::binary);
+    char head[256] = {};
+    file.read(head, sizeof(head) - 1);
+    if ((unsigned char)head[0] == 0xFF && std::strncmp(head + 1, "RenLib", 6) == 0) return ImportFormat::RenLib;
+    std::string start(head);
+    if (start.rfind("Piskvork", 0) == 0) return ImportFormat::Psq;
+    if (start.find("Gomoku Game Record") != std::string::npos || start.find("--- Move History ---") != std::string::npos) {
+        return ImportFormat::Record;
+    }
+    return ImportFormat::MoveList;
+}
+
+bool validateImportedGame(GameSession& session, ImportedGame& game, std::string& reason) {
+    using Result = ImportedGame::Result;
+    if (!game.problem.empty()) {
+        reason = game.problem;
+        return false;
+    }
+    if (game.boardSize != Board::SIZE) {
+        reason = "board is not 15x15";
+        return false;
+    }
+    const std::vector<HistoryEntry>& moves = game.record.moves;
+    if (moves.empty() || moves[0].side() != Side::Black || moves[0].type() != ActionType::Place || moves[0].move != Move::at(7, 7)) {
+        reason = "does not open at Tengen";
+        return false;
+    }
+
+    // Tengen is fixed by every symmetry; pick the first one that puts White's reply on its half
+    int sym = 0;
+    if (moves.size() > 1 && moves[1].type() == ActionType::Place && !moves[1].move.isNone()) {
+        while (Board::transform(moves[1].move, sym).row() < 7) sym++;
+    }
+
+    session.start();    // Places Tengen
+    const GameContext& ctx = session.getContext();
+    GameSession::MoveResult last;
+    last.outcome.status = GameStatus::Ongoing;
+    for (size_t i = 1; i < moves.size(); ++i) {
+        if (session.finished()) {
+            reason = "moves after the end of the game";
+            return false;
+        }
+        if (moves[i].side() != ctx.toMove) {
+            reason = "moves out of turn";
+            return false;
+        }
+        Action action = moves[i].action();
+        if (action.type == ActionType::Place && !action.move.isNone()) action.move = Board::transform(action.move, sym);
+        last = session.submit(action);
+        if (!last.applied) {
+            reason = last.message;
+            return false;
+        }
+    }
+
+    // Left on a forbidden move: White claims it
+    if (!session.finished() && ctx.phase == Phase::PendingClaim) {
+        if (game.result == Result::BlackWins) {
+            reason = "stated result contradicts the board";
+            return false;
+        }
+        last = session.submit(Action{ActionType::ClaimForbidden, Move(), 0});
+    }
+
+    if (session.finished()) {
+        Result shown = Result::Draw;
+        if (last.outcome.winner) shown = (*last.outcome.winner == Side::Black) ? Result::BlackWins : Result::WhiteWins;
+        if (game.result != Result::Unknown && game.result != shown) {
+            reason = "stated result contradicts the board";
+            return false;
+        }
+    } else if (game.result == Result::BlackWins || game.result == Result::WhiteWins) {
+        // Resignation is the only way our format records a win without five;
+        // a win on time by the side to move cannot be written, so those keep just the moves
+        Side loser = (game.result == Result::BlackWins) ? Side::White : Side::Black;
+        if (ctx.toMove == loser) session.submit(Action{ActionType::Resign, Move(), 0});
+    }
+
+    game.record.moves = ctx.history;
+    return true;
+}
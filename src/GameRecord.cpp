@@ -0,0 +1,125 @@
+#include "../include/GameRecord.h"
+#include "../include/Board.h"
+#include <string>
+
+bool readGameRecord(std::istream& in, GameRecord& record) {
+    record = GameRecord();
+    std::string line;
+    bool inHistory = false;
+    bool foundHistory = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find("--- Move History ---") != std::string::npos) {
+            inHistory = foundHistory = true;
+            continue;
+        }
+        if (line.find("--- Final Board ---") != std::string::npos) {
+            break;
+        }
+        if (!inHistory) {
+            if (line.rfind("Date: ", 0) == 0) record.date = line.substr(6);
+            else if (line.rfind("Black: ", 0) == 0) record.black = line.substr(7);
+            else if (line.rfind("White: ", 0) == 0) record.white = line.substr(7);
+            continue;
+        }
+        if (line.empty()) continue;
+
+        // Format: "1. Black (7,7) [0ms]", "9. White Resigns [0ms]", "4. White Claims Forbidden [0ms]"
+        Side side = (line.find("Black") != std::string::npos) ? Side::Black : Side::White;
+        Action action{ActionType::Place, Move(), 0};
+
+        size_t openBracket = line.find('[');
+        size_t ms = line.find("ms]");
+        if (openBracket != std::string::npos && ms != std::string::npos && ms > openBracket) {
+            try {
+                action.spentMs = (uint32_t)std::stoul(line.substr(openBracket + 1, ms - openBracket - 1));
+            } catch (...) {}
+        }
+
+        size_t openParen = line.find('(');
+        size_t comma = line.find(',');
+        size_t closeParen = line.find(')');
+        if (openParen != std::string::npos && comma != std::string::npos && closeParen != std::string::npos) {
+            try {
+                int r = std::stoi(line.substr(openParen + 1, comma - openParen - 1));
+                int c = std::stoi(line.substr(comma + 1, closeParen - comma - 1));
+                action.move = Move::at(r, c);
+                if (action.move.isNone()) continue;
+            } catch (...) {
+                continue;
+            }
+        } else if (line.find("Resigns") != std::string::npos) {
+            action.type = ActionType::Resign;
+        } else if (line.find("Claims Forbidden") != std::string::npos) {
+            action.type = ActionType::ClaimForbidden;
+        } else {
+            continue;
+        }
+        record.moves.push_back(HistoryEntry(side, action));
+    }
+    return foundHistory;
+}
+
+static const char* gridChar(int r, int c) {
+    if (r == 0) {
+        if (c == 0) return "┌";
+        if (c == Board::SIZE - 1) return "┐";
+        return "┬";
+    }
+    if (r == Board::SIZE - 1) {
+        if (c == 0) return "└";
+        if (c == Board::SIZE - 1) return "┘";
+        return "┴";
+    }
+    if (c == 0) return "├";
+    if (c == Board::SIZE - 1) return "┤";
+    if (r == 7 && c == 7) return "╋";
+    return "┼";
+}
+
+void writeGameRecord(std::ostream& out, const GameRecord& record, const Board& board) {
+    // Built in one string and written once: the importer writes millions of these
+    std::string text;
+    text.reserve(2048 + record.moves.size() * 24);
+    text += "Gomoku Game Record\n";
+    text += "Date: " + record.date + "\n";
+    text += "Black: " + record.black + "\n";
+    text += "White: " + record.white + "\n";
+
+    text += "\n--- Move History ---\n";
+    int moveNum = 1;
+    for (const auto& move : record.moves) {
+        text += std::to_string(moveNum++);
+        text += (move.side() == Side::Black) ? ". Black" : ". White";
+        if (move.type() == ActionType::Place && !move.move.isNone()) {
+            text += " (" + std::to_string(move.move.row()) + "," + std::to_string(move.move.col()) + ")";
+        } else if (move.type() == ActionType::Resign) {
+            text += " Resigns";
+        } else if (move.type() == ActionType::ClaimForbidden) {
+            text += " Claims Forbidden";
+        }
+        text += " [" + std::to_string(move.spentMs) + "ms]\n";
+    }
+
+    text += "\n--- Final Board ---\n";
+    text += "   ";
+    for (int c = 0; c < Board::SIZE; ++c) {
+        text += (char)('A' + c);
+        text += ' ';
+    }
+    text += "\n";
+
+    for (int r = 0; r < Board::SIZE; ++r) {
+        if (r + 1 < 10) text += ' ';
+        text += std::to_string(r + 1) + " ";
+        for (int c = 0; c < Board::SIZE; ++c) {
+            Side s = board.get(Pos{r, c});
+            if (s == Side::Black) text += "○";
+            else if (s == Side::White) text += "●";
+            else text += gridChar(r, c);
+            if (c < Board::SIZE - 1) text += "─";
+        }
+        text += "\n";
+    }
+    out << text;
+}
@@ -0,0 +1,85 @@
+#include "../include/GameSession.h"
+
+GameSession::GameSession(std::shared_ptr<const RuleSet> rules) : rules(std::move(rules)) {
+    start();
+}
+
+void GameSession::start() {
+    board.reset();
+    ctx = GameContext();
+    rules->initGame(ctx, board);
+    over = false;
+}
+
+GameSession::MoveResult GameSession::submit(const Action& action, int undoPlies) {
+    MoveResult result;
+    result.outcome.status = GameStatus::Ongoing;
+
+    if (over) {
+        result.message = "Game is over.";
+        return result;
+    }
+
+    if (action.type == ActionType::Undo) {
+        if (undo(undoPlies, result.message)) result.message = "Undo successful.";
+        return result;
+    }
+
+    if (!rules->validateAction(ctx, board, ctx.toMove, action, result.message)) {
+        return result;
+    }
+
+    Side justMoved = ctx.toMove;
+    rules->applyAction(ctx, board, justMoved, action);
+    ctx.history.push_back(HistoryEntry(justMoved, action));
+    result.applied = true;
+
+    result.outcome = rules->evaluateAfterAction(ctx, board, justMoved, action);
+    switch (result.outcome.status) {
+    case GameStatus::Win:
+    case GameStatus::Draw:
+    case GameStatus::Forbidden:
+        over = true;
+        break;
+    case GameStatus::PendingClaim:
+        ctx.phase = Phase::PendingClaim;
+        ctx.pendingForbidden = true;
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+Outcome GameSession::timeout() {
+    Outcome outcome = rules->onTimeout(ctx, ctx.toMove);
+    if (outcome.status == GameStatus::TimeoutLose) over = true;
+    return outcome;
+}
+
+bool GameSession::undo(int plies, std::string& message) {
+    // history[0] is the Tengen stone placed by initGame: part of the setup, not a move anyone can take back
+    if ((int)ctx.history.size() - 1 < plies) {
+        message = "Cannot undo: Not enough history.";
+        return false;
+    }
+
+    for (int i = 0; i < plies; ++i) {
+        auto last = ctx.history.back();
+        ctx.history.pop_back();
+        if (last.type() == ActionType::Place && !last.move.isNone()) {
+            board.clear(last.move);
+        }
+        // Revert context
+        ctx.turnIndex--;
+        ctx.toMove = (ctx.toMove == Side::Black) ? Side::White : Side::Black;
+        // Reset warnings/phase if needed? 
+        // Simplifying: Just keep warnings. Phase might need revert if we crossed opening.
+        if (ctx.turnIndex <= 2) ctx.phase = Phase::Opening;
+        else ctx.phase = Phase::Normal;
+        ctx.pendingForbidden = false; // Clear pending claim
+    }
+    ctx.lastAction.reset();
+    if (!ctx.history.empty()) ctx.lastAction = ctx.history.back().action();
+    return true;
+}
@@ -4,9 +4,8 @@
 #include <algorithm>
 #include <cctype>
 
-Action HumanPlayer::getAction(const GameContext& ctx, const Board& board, const RuleSet& rules) {
+Action HumanPlayer::getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop) {
     Action action;
-    action.spent = std::chrono::milliseconds(0); 
 
     std::string input;
     if (!std::getline(std::cin, input)) {
@@ -18,15 +17,13 @@ Action HumanPlayer::getAction(const GameContext& ctx, const Board& board, const
 
 Action HumanPlayer::parseCommand(const std::string& input) {
     Action action;
-    action.spent = std::chrono::milliseconds(0);
 
     std::string lower = input;
     // Trim
     size_t first = lower.find_first_not_of(" \t\n\r");
     if (first == std::string::npos) {
         // Empty
-        action.type = ActionType::Place;
-        action.pos = {-1, -1};
+        action.type = ActionType::Place; // No move: rejected by the rules
         return action;
     }
     size_t last = lower.find_last_not_of(" \t\n\r");
@@ -50,6 +47,10 @@ Action HumanPlayer::parseCommand(const std::string& input) {
         action.type = ActionType::Undo;
         return action;
     }
+    if (lower == "hint") {
+        action.type = ActionType::Hint;
+        return action;
+    }
 
     // Parse coordinate: Letter + Number (e.g., H8 or 8H)
     int r = -1, c = -1;
@@ -62,7 +63,6 @@ Action HumanPlayer::parseCommand(const std::string& input) {
     
     if (letters.empty() || digits.empty()) {
         action.type = ActionType::Place;
-        action.pos = {-1, -1}; 
         return action;
     }
     
@@ -74,7 +74,7 @@ Action HumanPlayer::parseCommand(const std::string& input) {
     }
     
     action.type = ActionType::Place;
-    action.pos = {r, c};
+    action.move = Move::at(r, c);
     
     return action;
 }
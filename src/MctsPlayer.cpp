@@ -0,0 +1,328 @@
+#include "../include/MctsPlayer.h"
+#include "../include/EvalWeights.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// 每个节点表示“mover 刚在 move 处落子”后的局面
+// 价值以 mover 的视角累计：胜 2，和 1，负 0
+// 紧凑布局：32 字节，两个节点占一条缓存行
+struct MctsNode {
+    Move move;
+    Side mover = Side::None;
+    int8_t terminal = -1;          // 终局时 mover 的结果 (0/1/2)，否则 -1
+    float prior = 0.0f;
+    std::atomic<int> visits{0};
+    std::atomic<int> virtualLoss{0};
+    std::atomic<int> value{0};     // 不超过 2 * visits
+    std::atomic<int> firstChild{-1};
+    std::atomic<int> childCount{0};
+    std::atomic<int> state{0};     // 0 = 未展开, 1 = 正在展开, 2 = 已展开
+};
+static_assert(sizeof(MctsNode) == 32, "MctsNode layout");
+
+const float PUCT_C = 1.5f;
+const int VIRTUAL_LOSS = 3;
+const int MAX_PLAYOUT_MOVES = 60;
+
+static Side opponentOf(Side s) {
+    return (s == Side::Black) ? Side::White : Side::Black;
+}
+
+// 先验：与 AIPlayer 的着法排序相同的棋型分（进攻 + 防守）
+static int priorScore(const Board& board, Pos p, Side side) {
+    const auto& order = EvalWeights::active().order;
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int s = 0;
+    for (Side who : {side, opponentOf(side)}) {
+        int mult = (who == side) ? EvalWeights::active().attackFactor : 1;
+        for (auto& d : dirs) {
+            int fwd = board.countConsecutive(p, d[0], d[1], who);
+            int bwd = board.countConsecutive(p, -d[0], -d[1], who);
+            bool open1 = board.isEmpty({p.r + (fwd + 1) * d[0], p.c + (fwd + 1) * d[1]});
+            bool open2 = board.isEmpty({p.r - (bwd + 1) * d[0], p.c - (bwd + 1) * d[1]});
+            int pattern = classifyRun(1 + fwd + bwd, open1, open2);
+            if (pattern >= 0) s += order[pattern] * mult;
+        }
+    }
+    return s;
+}
+
+// 随机对局中扫描用的快速成五检测（p 为空点，或刚落下的子）
+template <class Rules>
+static bool makesFive(const Board& board, Pos p, Side side) {
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        int count = 1 + board.countConsecutive(p, d[0], d[1], side) + board.countConsecutive(p, -d[0], -d[1], side);
+        if (Rules::isWinningRun(count, side)) return true;
+    }
+    return false;
+}
+
+// 按规则评估在 m 点落子（已落下）的结果：Win 为成五，PendingClaim 为黑方禁手
+// 与 PolicyRuleSet::evaluateAfterAction 的判定顺序相同
+template <class Rules>
+static GameStatus moveStatus(const Board& board, Side side, Move m) {
+    if (makesFive<Rules>(board, m.pos(), side)) return GameStatus::Win;
+    if (Rules::isForbidden(board, m.pos(), side)) return GameStatus::PendingClaim;
+    if (board.isFull()) return GameStatus::Draw;
+    return GameStatus::Ongoing;
+}
+
+MctsPlayer::MctsPlayer(int timeLimitMs, int threads, size_t arenaNodes)
+    : timeLimitMs(timeLimitMs), threads(threads), arenaCapacity(arenaNodes) {}
+
+MctsPlayer::~MctsPlayer() = default;
+
+int MctsPlayer::allocate(int count) {
+    size_t start = arenaUsed.fetch_add(count);
+    if (start + count > arenaCapacity) return -1;
+    return (int)start;
+}
+
+template <class Rules>
+void MctsPlayer::expand(MctsNode& node, const Board& board, Side toMove, bool whiteFirstMove) {
+    std::vector<std::pair<int, Move>> moves;
+    for (int r = 0; r < Board::SIZE; ++r) {
+        for (int c = 0; c < Board::SIZE; ++c) {
+            Pos p = {r, c};
+            if (!board.isEmpty(p)) continue;
+            if (whiteFirstMove && p.r < 7) continue;
+            bool neighbor = board.get({7, 7}) == Side::None && r == 7 && c == 7;
+            for (int dr = -2; dr <= 2 && !neighbor; ++dr) {
+                for (int dc = -2; dc <= 2 && !neighbor; ++dc) {
+                    Pos n = {r + dr, c + dc};
+                    if (board.isValid(n) && !board.isEmpty(n)) neighbor = true;
+                }
+            }
+            if (neighbor) moves.push_back({priorScore(board, p, toMove), Move(p)});
+        }
+    }
+
+    int first = moves.empty() ? -1 : allocate((int)moves.size());
+    if (first < 0) {
+        node.state.store(moves.empty() ? 2 : 0); // 内存池用完：保持叶节点
+        return;
+    }
+
+    double total = 0;
+    for (auto& m : moves) total += m.first + 1.0;
+    Board scratch = board;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        MctsNode& child = arena[first + i];
+        child.move = moves[i].second;
+        child.mover = toMove;
+        child.prior = (float)((moves[i].first + 1.0) / total);
+        scratch.set(child.move, toMove);
+        GameStatus status = moveStatus<Rules>(scratch, toMove, child.move);
+        if (status == GameStatus::Win) child.terminal = 2;
+        else if (status == GameStatus::PendingClaim) child.terminal = 0; // 白方立即举手
+        else if (status == GameStatus::Draw) child.terminal = 1;
+        scratch.clear(child.move);
+    }
+    node.childCount.store((int)moves.size());
+    node.firstChild.store(first);
+    node.state.store(2);
+}
+
+// 随机对局：能赢就赢，必须挡就挡，否则在邻近空点中随机落子
+// 实际落下的每一手都按规则判定胜负和禁手
+template <class Rules>
+int MctsPlayer::playout(Board& board, Side toMove, uint32_t& rng) const {
+    Side rootMover = opponentOf(toMove); // 叶节点的 mover
+    Side side = toMove;
+    std::vector<Move> moves;
+    for (int ply = 0; ply < MAX_PLAYOUT_MOVES; ++ply) {
+        moves.clear();
+        Move forced;
+        bool winning = false;
+        for (int r = 0; r < Board::SIZE && !winning; ++r) {
+            for (int c = 0; c < Board::SIZE && !winning; ++c) {
+                Pos p = {r, c};
+                if (!board.isEmpty(p)) continue;
+                bool neighbor = false;
+                for (int dr = -1; dr <= 1 && !neighbor; ++dr) {
+                    for (int dc = -1; dc <= 1 && !neighbor; ++dc) {
+                        Pos n = {r + dr, c + dc};
+                        if (board.isValid(n) && !board.isEmpty(n)) neighbor = true;
+                    }
+                }
+                if (!neighbor) continue;
+                moves.push_back(Move(p));
+                if (makesFive<Rules>(board, p, side)) {
+                    forced = p; // 己方成五优先于防守
+                    winning = true;
+                } else if (makesFive<Rules>(board, p, opponentOf(side))) {
+                    forced = p;
+                }
+            }
+        }
+        if (moves.empty()) return 1;
+
+        Move p = forced;
+        if (p.isNone()) {
+            rng = rng * 1664525u + 1013904223u;
+            p = moves[(rng >> 8) % moves.size()];
+        }
+        board.set(p, side);
+        GameStatus status = moveStatus<Rules>(board, side, p);
+        if (status == GameStatus::Win) return (side == rootMover) ? 2 : 0;
+        if (status == GameStatus::PendingClaim) return (side == rootMover) ? 0 : 2;
+        if (status == GameStatus::Draw) return 1;
+        side = opponentOf(side);
+    }
+    return 1;
+}
+
+template <class Rules>
+void MctsPlayer::worker(const Board& rootBoard, Side rootSide, bool whiteFirstMove,
+                        std::chrono::steady_clock::time_point deadline, const StopToken& stop, std::atomic<long long>& playouts) {
+    uint32_t rng = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+    std::vector<MctsNode*> path;
+
+    while (std::chrono::steady_clock::now() < deadline && !stop.stopRequested()) {
+        for (int batch = 0; batch < 16; ++batch) {
+            Board board = rootBoard;
+            Side toMove = rootSide;
+            MctsNode* node = &arena[0];
+            path.clear();
+            path.push_back(node);
+            node->virtualLoss += VIRTUAL_LOSS;
+
+            // 选择：PUCT，虚拟损失让其他线程避开同一条路径
+            int result = -1;
+            while (true) {
+                if (node->terminal >= 0) {
+                    result = node->terminal;
+                    break;
+                }
+                if (node->state.load() != 2) {
+                    int expected = 0;
+                    if (node->state.compare_exchange_strong(expected, 1)) {
+                        expand<Rules>(*node, board, toMove, whiteFirstMove && node == &arena[0]);
+                    }
+                    break; // 新展开或正由其他线程展开：从这里开始随机对局
+                }
+                int first = node->firstChild.load();
+                int count = node->childCount.load();
+                if (first < 0 || count == 0) break;
+
+                int parentVisits = node->visits.load() + node->virtualLoss.load();
+                float sqrtParent = std::sqrt((float)parentVisits + 1.0f);
+                MctsNode* best = nullptr;
+                float bestScore = -1e30f;
+                for (int i = 0; i < count; ++i) {
+                    MctsNode& child = arena[first + i];
+                    int n = child.visits.load();
+                    int vl = child.virtualLoss.load();
+                    float q = (n + vl > 0) ? (float)child.value.load() / (2.0f * (n + vl)) : 0.5f;
+                    float u = PUCT_C * child.prior * sqrtParent / (1.0f + n + vl);
+                    if (q + u > bestScore) {
+                        bestScore = q + u;
+                        best = &child;
+                    }
+                }
+                node = best;
+                node->virtualLoss += VIRTUAL_LOSS;
+                path.push_back(node);
+                board.set(node->move, node->mover);
+                toMove = opponentOf(node->mover);
+            }
+
+            // 模拟
+            if (result < 0) {
+                if (node == &arena[0]) {
+                    result = 1;
+                } else {
+                    result = playout<Rules>(board, toMove, rng);
+                }
+            }
+
+            // 回传：result 是叶节点 mover 的结果，沿路径交替翻转
+            int r = result;
+            for (size_t i = path.size(); i-- > 0;) {
+                MctsNode* n = path[i];
+                n->visits++;
+                n->value += r;
+                n->virtualLoss -= VIRTUAL_LOSS;
+                r = 2 - r;
+            }
+            playouts++;
+        }
+    }
+}
+
+Action MctsPlayer::getAction(const GameContext& ctx, const Board& board, const RuleSet& rules, const StopToken& stop) {
+    Action action;
+    action.type = ActionType::Place;
+    action.spentMs = 100;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (!arena) arena.reset(new MctsNode[arenaCapacity]);
+    // 重置已用节点（原子成员不能整体赋值）
+    size_t used = std::min(arenaUsed.load(), arenaCapacity);
+    for (size_t i = 0; i < used; ++i) {
+        MctsNode& n = arena[i];
+        n.move = Move();
+        n.mover = Side::None;
+        n.prior = 0.0f;
+        n.visits = 0;
+        n.virtualLoss = 0;
+        n.value = 0;
+        n.firstChild = -1;
+        n.childCount = 0;
+        n.state = 0;
+        n.terminal = -1;
+    }
+    arenaUsed = 1; // 0 号为根节点
+    arena[0].mover = opponentOf(ctx.toMove);
+
+    bool whiteFirstMove = (ctx.toMove == Side::White && ctx.turnIndex == 1);
+    int threadCount = threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    auto deadline = startTime + std::chrono::milliseconds(timeLimitMs);
+    std::atomic<long long> playouts{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            switch (rules.variant()) {
+            case RuleVariant::Freestyle: worker<FreestylePolicy>(board, ctx.toMove, whiteFirstMove, deadline, stop, playouts); break;
+            case RuleVariant::Standard: worker<StandardPolicy>(board, ctx.toMove, whiteFirstMove, deadline, stop, playouts); break;
+            case RuleVariant::Renju: worker<RenjuPolicy>(board, ctx.toMove, whiteFirstMove, deadline, stop, playouts); break;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    // 选访问次数最多的子节点；立即获胜的着法优先
+    MctsNode& root = arena[0];
+    Move bestMove = (root.childCount.load() > 0) ? arena[root.firstChild.load()].move : Move();
+    int bestVisits = -1;
+    for (int i = 0; i < root.childCount.load(); ++i) {
+        MctsNode& child = arena[root.firstChild.load() + i];
+        if (child.terminal == 2) {
+            bestMove = child.move;
+            break;
+        }
+        if (child.terminal == 0) continue;
+        if (child.visits.load() > bestVisits) {
+            bestVisits = child.visits.load();
+            bestMove = child.move;
+        }
+    }
+
+    stats.playouts = playouts.load();
+    stats.nodes = (long long)std::min(arenaUsed.load(), arenaCapacity);
+    stats.threads = threadCount;
+    stats.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    // 被取消时若根节点还未展开，则没有可用的着法
+    if (bestMove.isNone() && stop.stopRequested()) {
+        action.type = ActionType::Cancelled;
+        return action;
+    }
+    action.move = bestMove;
+    return action;
+}
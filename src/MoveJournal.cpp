@@ -0,0 +1,266 @@
+#include "../include/MoveJournal.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static_assert(sizeof(MoveJournal::Record) == 16, "journal records must stay 16 bytes");
+
+static uint16_t recordChecksum(MoveJournal::Record record) {
+    // FNV-1a over the record with the checksum field zeroed, folded to 16 bits
+    record.check = 0;
+    unsigned char bytes[sizeof(record)];
+    std::memcpy(bytes, &record, sizeof(record));
+    uint32_t h = 2166136261u;
+    for (unsigned char b : bytes) {
+        h ^= b;
+        h *= 16777619u;
+    }
+    uint16_t c = (uint16_t)(h ^ (h >> 16));
+    return c ? c : 1;
+}
+
+static MoveJournal::Record makeRecord(MoveJournal::Kind kind, const GameContext& ctx) {
+    MoveJournal::Record record{};      // Zeroed, padding included: the checksum covers every byte
+    record.kind = kind;
+    record.elapsedSeconds = (uint32_t)std::max(0LL, ctx.elapsedGameSeconds);
+    record.totalSeconds = (uint32_t)std::max(0LL, ctx.totalGameDurationSeconds);
+    return record;
+}
+
+MoveJournal::MoveJournal(std::string path, int syncIntervalMs)
+    : filePath(std::move(path)), syncInterval(syncIntervalMs) {
+    openFile();
+    writer = std::thread([this]() { writerLoop(); });
+}
+
+MoveJournal::~MoveJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (writer.joinable()) writer.join();
+#ifdef _WIN32
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+#else
+    if (fd >= 0) close(fd);
+#endif
+}
+
+void MoveJournal::begin(int blackCode, int whiteCode, const GameContext& ctx) {
+    Record record = makeRecord(Kind::Start, ctx);
+    record.arg = (uint8_t)((blackCode & 0x0F) | (whiteCode & 0x0F) << 4);
+    {
+        // A new game replaces the previous one, including anything still queued
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        truncateRequested = true;
+    }
+    append(record, false);
+}
+
+void MoveJournal::action(Side side, const Action& action, int undoPlies, const GameContext& ctx) {
+    Record record = makeRecord(Kind::Action, ctx);
+    record.arg = (uint8_t)undoPlies;
+    record.entry = HistoryEntry(side, action);
+    append(record, false);
+}
+
+void MoveJournal::timeout(const GameContext& ctx) {
+    append(makeRecord(Kind::Timeout, ctx), false);
+}
+
+void MoveJournal::clock(const GameContext& ctx) {
+    append(makeRecord(Kind::Clock, ctx), false);
+}
+
+void MoveJournal::end(const GameContext& ctx) {
+    append(makeRecord(Kind::End, ctx), true);
+}
+
+void MoveJournal::append(Record record, bool syncNow) {
+    record.check = recordChecksum(record);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(record);
+        appended++;
+        counters.records++;
+        if (syncNow) syncRequested = true;
+    }
+    cv.notify_one();
+}
+
+void MoveJournal::sync() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appended;
+    syncRequested = true;
+    cv.notify_one();
+    synced.wait(lock, [&]() { return durable >= target; });
+}
+
+MoveJournal::Stats MoveJournal::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void MoveJournal::writerLoop() {
+    std::vector<Record> batch;
+    auto lastSync = std::chrono::steady_clock::now();
+    bool unsynced = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto pending = [&]() { return stopping || syncRequested || truncateRequested || !queue.empty(); };
+        if (unsynced) cv.wait_until(lock, lastSync + syncInterval, pending);
+        else cv.wait(lock, pending);
+
+        bool truncate = std::exchange(truncateRequested, false);
+        bool syncNow = std::exchange(syncRequested, false) || stopping;
+        bool stop = stopping;
+        uint64_t target = appended;
+        batch.swap(queue);
+        lock.unlock();
+
+        // Disk work happens outside the lock, so the game loop can keep appending
+        bool wrote = false;
+        if (truncate) truncateFile();
+        if (!batch.empty()) {
+            writeAll(batch.data(), batch.size() * sizeof(Record));
+            batch.clear();
+            unsynced = wrote = true;
+        }
+        long long syncMicros = -1;
+        auto now = std::chrono::steady_clock::now();
+        if (unsynced && (syncNow || now - lastSync >= syncInterval)) {
+            syncFile();
+            lastSync = std::chrono::steady_clock::now();
+            syncMicros = std::chrono::duration_cast<std::chrono::microseconds>(lastSync - now).count();
+            unsynced = false;
+        }
+
+        lock.lock();
+        if (wrote) counters.writes++;
+        if (syncMicros >= 0) {
+            counters.syncs++;
+            counters.syncMicros += syncMicros;
+        }
+        if (!unsynced) {
+            durable = target;
+            synced.notify_all();
+        }
+        if (stop && queue.empty()) break;
+    }
+}
+
+bool MoveJournal::openFile() {
+    std::error_code ec;
+    fs::path parent = fs::path(filePath).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    fileHandle = file;
+    return true;
+#else
+    fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    return fd >= 0;
+#endif
+}
+
+// Without a file the journal still accepts records; they are dropped
+bool MoveJournal::writeAll(const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+#ifdef _WIN32
+    if (!fileHandle) return false;
+    LARGE_INTEGER zero{};
+    SetFilePointerEx((HANDLE)fileHandle, zero, nullptr, FILE_END);
+    while (bytes > 0) {
+        DWORD written = 0;
+        if (!WriteFile((HANDLE)fileHandle, p, (DWORD)bytes, &written, nullptr) || written == 0) return false;
+        p += written;
+        bytes -= written;
+    }
+#else
+    if (fd < 0) return false;
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= (size_t)n;
+    }
+#endif
+    return true;
+}
+
+void MoveJournal::truncateFile() {
+#ifdef _WIN32
+    if (!fileHandle) return;
+    LARGE_INTEGER zero{};
+    SetFilePointerEx((HANDLE)fileHandle, zero, nullptr, FILE_BEGIN);
+    SetEndOfFile((HANDLE)fileHandle);
+#else
+    if (fd >= 0) (void)!ftruncate(fd, 0);  // O_APPEND: the next write starts at 0
+#endif
+}
+
+void MoveJournal::syncFile() {
+#ifdef _WIN32
+    if (fileHandle) FlushFileBuffers((HANDLE)fileHandle);
+#else
+    if (fd >= 0) fsync(fd);
+#endif
+}
+
+bool MoveJournal::load(const std::string& path, std::vector<Record>& records) {
+    records.clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    Record record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        // A torn or unwritten tail ends the journal
+        if (record.kind < Kind::Start || record.kind > Kind::End || record.check != recordChecksum(record)) break;
+        if (record.kind == Kind::Start) records.clear();
+        else if (records.empty()) break;
+        records.push_back(record);
+        if (record.kind == Kind::End) break;
+    }
+    return !records.empty();
+}
+
+bool MoveJournal::replay(const std::vector<Record>& records, GameSession& session) {
+    session.start();
+    GameContext& ctx = session.getContext();
+    for (const auto& record : records) {
+        if (record.kind == Kind::Action) {
+            if (record.entry.side() != ctx.toMove) return false;
+            size_t before = ctx.history.size();
+            GameSession::MoveResult result = session.submit(record.entry.action(), record.arg);
+            if (!result.applied && ctx.history.size() == before) return false;
+        } else if (record.kind == Kind::Timeout) {
+            session.timeout();
+        }
+        ctx.elapsedGameSeconds = record.elapsedSeconds;
+        ctx.totalGameDurationSeconds = record.totalSeconds;
+    }
+    return true;
+}
+
+std::string MoveJournal::defaultPath() {
+    const char* env = std::getenv("GOMOKU_JOURNAL");
+    return (env && *env) ? env : "../match/current.journal";
+}
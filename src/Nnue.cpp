@@ -0,0 +1,192 @@
+#include "../include/Nnue.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static std::unique_ptr<NnueNetwork> activeNetwork;
+
+static const char NNUE_MAGIC[4] = {'G', 'N', 'U', 'E'};
+static const uint32_t NNUE_VERSION = 1;
+
+// 特征编号：从 perspective 一方看，己方子为 0，对方子为 1
+static int featureIndex(Move m, Side stone, Side perspective) {
+    return m.index * 2 + (stone == perspective ? 0 : 1);
+}
+
+bool NnueNetwork::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[4];
+    uint32_t version = 0, hidden = 0, l2 = 0;
+    in.read(magic, 4);
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&hidden), sizeof(hidden));
+    in.read(reinterpret_cast<char*>(&l2), sizeof(l2));
+    if (!in || std::memcmp(magic, NNUE_MAGIC, 4) != 0 || version != NNUE_VERSION || hidden != HIDDEN || l2 != L2) {
+        return false;
+    }
+
+    auto net = std::make_unique<NnueNetwork>();
+    net->ftWeights.resize((size_t)INPUTS * HIDDEN);
+    in.read(reinterpret_cast<char*>(&net->scale), sizeof(net->scale));
+    in.read(reinterpret_cast<char*>(net->ftBias), sizeof(net->ftBias));
+    in.read(reinterpret_cast<char*>(net->ftWeights.data()), net->ftWeights.size() * sizeof(int16_t));
+    in.read(reinterpret_cast<char*>(net->l2Bias), sizeof(net->l2Bias));
+    in.read(reinterpret_cast<char*>(net->l2Weights), sizeof(net->l2Weights));
+    in.read(reinterpret_cast<char*>(&net->outBias), sizeof(net->outBias));
+    in.read(reinterpret_cast<char*>(net->outWeights), sizeof(net->outWeights));
+    if (!in) return false;
+
+    activeNetwork = std::move(net);
+    return true;
+}
+
+bool NnueNetwork::loadDefault() {
+    const char* env = std::getenv("GOMOKU_NNUE");
+    if (env && load(env)) return true;
+    return load("../nnue/gomoku.nnue");
+}
+
+const NnueNetwork* NnueNetwork::active() {
+    return activeNetwork.get();
+}
+
+bool NnueNetwork::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) return false;
+    uint32_t version = NNUE_VERSION, hidden = HIDDEN, l2 = L2;
+    out.write(NNUE_MAGIC, 4);
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&hidden), sizeof(hidden));
+    out.write(reinterpret_cast<const char*>(&l2), sizeof(l2));
+    out.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+    out.write(reinterpret_cast<const char*>(ftBias), sizeof(ftBias));
+    out.write(reinterpret_cast<const char*>(ftWeights.data()), ftWeights.size() * sizeof(int16_t));
+    out.write(reinterpret_cast<const char*>(l2Bias), sizeof(l2Bias));
+    out.write(reinterpret_cast<const char*>(l2Weights), sizeof(l2Weights));
+    out.write(reinterpret_cast<const char*>(&outBias), sizeof(outBias));
+    out.write(reinterpret_cast<const char*>(outWeights), sizeof(outWeights));
+    return (bool)out;
+}
+
+void NnueNetwork::initRandom(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> small(-16, 16);
+    scale = 100;
+    ftWeights.resize((size_t)INPUTS * HIDDEN);
+    for (auto& w : ftBias) w = (int16_t)small(rng);
+    for (auto& w : ftWeights) w = (int16_t)small(rng);
+    for (auto& b : l2Bias) b = small(rng);
+    for (auto& row : l2Weights) for (auto& w : row) w = (int8_t)small(rng);
+    outBias = small(rng);
+    for (auto& w : outWeights) w = (int8_t)small(rng);
+}
+
+// uint8 激活 x int8 权重的点积
+static int32_t dotU8I8(const uint8_t* in, const int8_t* w, int n) {
+#if defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__SSSE3__)
+    __m128i sum = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a, b), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(__SSE2__)
+    // x86-64 基线：扩展为 int16 后用 madd
+    __m128i sum = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+        __m128i sign = _mm_cmpgt_epi8(zero, b);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, sign)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, sign)));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < n; ++i) sum += (int32_t)in[i] * w[i];
+    return sum;
+#endif
+}
+
+long long NnueNetwork::evaluate(const NnueAccumulator& acc, Side toMove) const {
+    // 第一层：截断 ReLU 到 [0, 127]，己方视角在前
+    alignas(32) uint8_t input[2 * HIDDEN];
+    Side opp = (toMove == Side::Black) ? Side::White : Side::Black;
+    const int16_t* own = acc.values(toMove);
+    const int16_t* their = acc.values(opp);
+    for (int i = 0; i < HIDDEN; ++i) {
+        input[i] = (uint8_t)std::clamp<int>(own[i], 0, 127);
+        input[HIDDEN + i] = (uint8_t)std::clamp<int>(their[i], 0, 127);
+    }
+
+    // 第二层
+    alignas(32) uint8_t hidden[L2];
+    for (int j = 0; j < L2; ++j) {
+        int32_t v = l2Bias[j] + dotU8I8(input, l2Weights[j], 2 * HIDDEN);
+        hidden[j] = (uint8_t)std::clamp<int32_t>(v >> 6, 0, 127);
+    }
+
+    // 输出层
+    int32_t out = outBias + dotU8I8(hidden, outWeights, L2);
+    return std::clamp((long long)out * scale, -MAX_EVAL, MAX_EVAL);
+}
+
+void NnueAccumulator::refresh(const Board& board) {
+    for (int persp = 0; persp < 2; ++persp) {
+        std::copy(net.ftBias, net.ftBias + NnueNetwork::HIDDEN, acc[persp]);
+    }
+    for (int i = 0; i < Board::SIZE * Board::SIZE; ++i) {
+        Move m = Move::fromIndex(i);
+        Side s = board.get(m);
+        if (s != Side::None) update(m, Side::None, s);
+    }
+}
+
+void NnueAccumulator::update(Move m, Side before, Side after) {
+    if (before != Side::None) {
+        addFeature(0, featureIndex(m, before, Side::Black), -1);
+        addFeature(1, featureIndex(m, before, Side::White), -1);
+    }
+    if (after != Side::None) {
+        addFeature(0, featureIndex(m, after, Side::Black), 1);
+        addFeature(1, featureIndex(m, after, Side::White), 1);
+    }
+}
+
+void NnueAccumulator::addFeature(int perspective, int feature, int sign) {
+    const int16_t* column = net.ftWeights.data() + (size_t)feature * NnueNetwork::HIDDEN;
+    int16_t* values = acc[perspective];
+    // 编译器会将此循环向量化
+    if (sign > 0) {
+        for (int i = 0; i < NnueNetwork::HIDDEN; ++i) values[i] += column[i];
+    } else {
+        for (int i = 0; i < NnueNetwork::HIDDEN; ++i) values[i] -= column[i];
+    }
+}
@@ -1,4 +1,5 @@
 #include "../include/Renderer.h"
+#include "../include/Trace.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -7,7 +8,28 @@ void Renderer::clearScreen() {
     // Do nothing here, handled in render with ANSI codes
 }
 
+void Renderer::setHints(const std::vector<PvLine>& lines, int depth) {
+    hints = lines;
+    hintDepth = depth;
+}
+
+void Renderer::clearHints() {
+    hints.clear();
+    hintDepth = 0;
+}
+
+static std::string cellName(Move m) {
+    return std::string(1, (char)('A' + m.col())) + std::to_string(m.row() + 1);
+}
+
+static std::string hintScore(const PvLine& line) {
+    if (line.forced > 0) return "win";
+    if (line.forced < 0) return "loss";
+    return (line.score >= 0 ? "+" : "") + std::to_string(line.score);
+}
+
 void Renderer::render(const GameContext& ctx, const Board& board, const std::string& message, const std::string& currentInput) {
+    TRACE_SCOPE("render");
     std::stringstream ss;
     
     // Move cursor to home (0,0)
@@ -43,8 +65,8 @@ void Renderer::render(const GameContext& ctx, const Board& board, const std::str
             Side s = board.get(p);
             
             bool isLast = false;
-            if (ctx.lastAction.has_value() && ctx.lastAction->type == ActionType::Place && ctx.lastAction->pos.has_value()) {
-                if (ctx.lastAction->pos.value() == p) isLast = true;
+            if (ctx.lastAction.has_value() && ctx.lastAction->type == ActionType::Place && ctx.lastAction->move == Move(p)) {
+                isLast = true;
             }
 
             std::string symbol;
@@ -56,7 +78,17 @@ void Renderer::render(const GameContext& ctx, const Board& board, const std::str
                 symbol = getGridChar(r, c);
             }
 
-            if (isLast) {
+            int hintRank = 0;
+            if (s == Side::None) {
+                for (size_t i = 0; i < hints.size(); ++i) {
+                    if (hints[i].move == Move(p)) hintRank = (int)i + 1;
+                }
+            }
+
+            if (hintRank > 0) {
+                // 提示点：亮绿色序号
+                ss << "\033[1;32m" << (hintRank < 10 ? std::to_string(hintRank) : "+") << "\033[0m";
+            } else if (isLast) {
                 // 最后一步特殊显示：使用亮洋红色 (Bold Magenta)
                 ss << "\033[1;35m" << symbol << "\033[0m"; 
             } else {
@@ -78,11 +110,21 @@ void Renderer::render(const GameContext& ctx, const Board& board, const std::str
     ss << "Global Time: " << (elapsed / 60) << ":" << std::setw(2) << std::setfill('0') << (elapsed % 60) 
        << " / " << (total / 60) << ":" << std::setw(2) << std::setfill('0') << (total % 60) << "\033[K\n";
 
-    ss << "Warnings - Black: " << ctx.blackTimeoutWarnings << "/3 | White: " << ctx.whiteTimeoutWarnings << "/3\033[K\n";
+    ss << "Warnings - Black: " << (int)ctx.blackTimeoutWarnings << "/3 | White: " << (int)ctx.whiteTimeoutWarnings << "/3\033[K\n";
     if (ctx.phase == Phase::PendingClaim) {
         ss << "STATUS: PENDING CLAIM! White can type 'claim' to win.\033[K\n";
     }
     
+    if (!hints.empty()) {
+        ss << std::setfill(' ') << "Hints (depth " << hintDepth << "):\033[K\n";
+        for (size_t i = 0; i < hints.size(); ++i) {
+            ss << "  \033[1;32m" << (i + 1) << "\033[0m " << std::left << std::setw(4) << cellName(hints[i].move) << std::right
+               << " " << std::setw(14) << hintScore(hints[i]) << "  ";
+            for (const auto& m : hints[i].pv) ss << cellName(m) << " ";
+            ss << "\033[K\n";
+        }
+    }
+
     if (!message.empty()) {
         ss << "Message: " << message << "\033[K\n";
     }
@@ -0,0 +1,266 @@
+#include "../include/SearchCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static const char CACHE_MAGIC[8] = {'G', 'S', 'C', 'A', 'C', 'H', 'E', '1'};
+static const uint32_t CACHE_VERSION = 1;
+static const int BUCKET_SIZE = 4;
+
+struct SearchCache::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t capacity;
+    uint32_t generation;    // Bumped on every open; ages older entries
+    uint8_t reserved[36];
+};
+
+struct SearchCache::Entry {
+    uint64_t key;           // 0 = empty
+    int64_t score;
+    uint32_t searchMs;
+    uint8_t move;           // Move::index
+    uint8_t depth;
+    uint16_t generation;
+    uint32_t check;         // Checksum of all fields above; a torn write fails it
+    uint32_t reserved;
+};
+
+
+static std::unique_ptr<SearchCache> activeCache;
+
+static uint32_t entryChecksum(uint64_t key, int64_t score, uint32_t searchMs, uint8_t move, uint8_t depth, uint16_t generation) {
+    uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)score + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+    h ^= ((uint64_t)searchMs << 32 | (uint64_t)move << 24 | (uint64_t)depth << 16 | generation) * 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    uint32_t c = (uint32_t)(h ^ (h >> 32));
+    return c ? c : 1;
+}
+
+SearchCache::~SearchCache() {
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        stopping = true;
+    }
+    flushCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    flush();
+    unmap();
+}
+
+bool SearchCache::open(const std::string& path, size_t capacity) {
+    std::unique_ptr<SearchCache> cache(new SearchCache());
+    if (!cache->map(path, capacity)) return false;
+    cache->flusher = std::thread([c = cache.get()]() { c->flushLoop(); });
+    activeCache = std::move(cache);
+    return true;
+}
+
+bool SearchCache::openDefault() {
+    const char* env = std::getenv("GOMOKU_CACHE");
+    std::string path = env ? env : "../cache/search.cache";
+    fs::path parent = fs::path(path).parent_path();
+    std::error_code ec;
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    return open(path);
+}
+
+SearchCache* SearchCache::active() {
+    return activeCache.get();
+}
+
+void SearchCache::closeActive() {
+    activeCache.reset();
+}
+
+bool SearchCache::map(const std::string& path, size_t capacity) {
+    size_t cap = BUCKET_SIZE;
+    while (cap < capacity) cap <<= 1;
+
+    // Reuse an existing file's capacity when its header is intact
+    bool reuse = false;
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        Header existing{};
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (f) {
+            size_t n = std::fread(&existing, sizeof(existing), 1, f);
+            std::fclose(f);
+            uintmax_t fileSize = fs::file_size(path, ec);
+            if (n == 1 && std::memcmp(existing.magic, CACHE_MAGIC, 8) == 0 && existing.version == CACHE_VERSION &&
+                existing.entrySize == sizeof(Entry) && existing.capacity >= BUCKET_SIZE &&
+                (existing.capacity & (existing.capacity - 1)) == 0 &&
+                fileSize == sizeof(Header) + existing.capacity * sizeof(Entry)) {
+                cap = (size_t)existing.capacity;
+                reuse = true;
+            }
+        }
+    }
+    mappedBytes = sizeof(Header) + cap * sizeof(Entry);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              reuse ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)mappedBytes >> 32),
+                                        (DWORD)(mappedBytes & 0xFFFFFFFF), nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, mappedBytes);
+    if (!base) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | (reuse ? 0 : O_TRUNC), 0644);
+    if (fd < 0) return false;
+    if (!reuse && ftruncate(fd, (off_t)mappedBytes) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    void* base = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+#endif
+
+    header = static_cast<Header*>(base);
+    entries = reinterpret_cast<Entry*>(static_cast<char*>(base) + sizeof(Header));
+    entryCount = cap;
+
+    if (!reuse) {
+        // New file: the mapping is zero-filled (all entries empty); the header goes in last
+        Header fresh{};
+        std::memcpy(fresh.magic, CACHE_MAGIC, 8);
+        fresh.version = CACHE_VERSION;
+        fresh.entrySize = sizeof(Entry);
+        fresh.capacity = cap;
+        fresh.generation = 0;
+        *header = fresh;
+    }
+    header->generation++;
+    dirty = true;
+    return true;
+}
+
+void SearchCache::unmap() {
+    if (!header) return;
+#ifdef _WIN32
+    UnmapViewOfFile(header);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+#else
+    munmap(header, mappedBytes);
+    ::close(fd);
+    fd = -1;
+#endif
+    header = nullptr;
+    entries = nullptr;
+}
+
+bool SearchCache::probe(uint64_t key, Result& out) {
+    counters.probes++;
+    if (key == 0) key = 1;
+    size_t bucket = (size_t)key & (entryCount - 1) & ~(size_t)(BUCKET_SIZE - 1);
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        Entry e;
+        std::memcpy(&e, &entries[bucket + i], sizeof(Entry)); // Copy first: another thread may be writing it
+        if (e.key != key) continue;
+        if (e.check != entryChecksum(e.key, e.score, e.searchMs, e.move, e.depth, e.generation)) continue;
+
+        out.move = Move::fromIndex(e.move);
+        out.depth = e.depth;
+        out.score = e.score;
+        out.searchMs = e.searchMs;
+        counters.hits++;
+        return true;
+    }
+    return false;
+}
+
+void SearchCache::store(uint64_t key, const Result& result) {
+    if (key == 0) key = 1;
+    uint16_t gen = (uint16_t)header->generation;
+    size_t bucket = (size_t)key & (entryCount - 1) & ~(size_t)(BUCKET_SIZE - 1);
+
+    // Same key, else an empty or corrupt slot, else the shallowest, oldest entry
+    int victim = -1;
+    int victimPriority = 1 << 30;
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        const Entry& e = entries[bucket + i];
+        bool valid = e.key != 0 && e.check == entryChecksum(e.key, e.score, e.searchMs, e.move, e.depth, e.generation);
+        if (valid && e.key == key) {
+            if (e.depth > result.depth) return; // Keep the deeper result
+            victim = i;
+            break;
+        }
+        int priority = valid ? (int)e.depth * 4 - (int)(uint16_t)(gen - e.generation) : -(1 << 20);
+        if (priority < victimPriority) {
+            victimPriority = priority;
+            victim = i;
+        }
+    }
+
+    Entry e{};
+    e.key = key;
+    e.score = result.score;
+    e.searchMs = result.searchMs;
+    e.move = result.move.index;
+    e.depth = (uint8_t)std::min(result.depth, 255);
+    e.generation = gen;
+    e.check = entryChecksum(e.key, e.score, e.searchMs, e.move, e.depth, e.generation);
+    std::memcpy(&entries[bucket + victim], &e, sizeof(Entry));
+    counters.stores++;
+    dirty = true;
+}
+
+void SearchCache::flush() {
+    if (!header) return;
+#ifdef _WIN32
+    FlushViewOfFile(header, 0);
+#else
+    msync(header, mappedBytes, MS_SYNC);
+#endif
+    dirty = false;
+}
+
+void SearchCache::flushLoop() {
+    std::unique_lock<std::mutex> lock(flushMutex);
+    while (!stopping) {
+        flushCv.wait_for(lock, std::chrono::seconds(2));
+        if (stopping || !dirty.exchange(false)) continue;
+        // Start write-back of dirty pages without waiting for it
+#ifdef _WIN32
+        FlushViewOfFile(header, 0);
+#else
+        msync(header, mappedBytes, MS_ASYNC);
+#endif
+    }
+}
@@ -0,0 +1,95 @@
+#include "../include/SearchParams.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static const SearchParams::ParamInfo PARAMS[] = {
+    {"candidate_radius", &SearchParams::candidateRadius, 1, 4, true},
+    {"nodes.easy", &SearchParams::nodesEasy, 0, 1000000000, false},
+    {"nodes.medium", &SearchParams::nodesMedium, 0, 1000000000, false},
+    {"nodes.hard", &SearchParams::nodesHard, 0, 1000000000, false},
+    {"noise.easy", &SearchParams::noiseEasy, 0, 100000000, false},
+    {"noise.medium", &SearchParams::noiseMedium, 0, 100000000, false},
+    {"noise.hard", &SearchParams::noiseHard, 0, 100000000, false},
+    {"depth.easy", &SearchParams::depthEasy, 1, SearchParams::MAX_DEPTH, false},
+    {"depth.medium", &SearchParams::depthMedium, 1, SearchParams::MAX_DEPTH, false},
+    {"depth.hard", &SearchParams::depthHard, 1, SearchParams::MAX_DEPTH, false},
+    {"time.easy_ms", &SearchParams::timeEasyMs, 10, 600000, false},
+    {"time.medium_ms", &SearchParams::timeMediumMs, 10, 600000, false},
+    {"time.hard_ms", &SearchParams::timeHardMs, 10, 600000, false},
+    {"aspiration_window", &SearchParams::aspirationWindow, 100, 1000000, true},
+    {"lmr.min_depth", &SearchParams::lmrMinDepth, 2, SearchParams::MAX_DEPTH, true},
+    {"lmr.min_moves", &SearchParams::lmrMinMoves, 1, 32, true},
+    {"lmr.quiet_threshold", &SearchParams::quietThreshold, 1, 100000, true},
+    {"qs.max_ply", &SearchParams::qsMaxPly, 0, SearchParams::MAX_QS_PLY, true},
+};
+static const int PARAM_COUNT = sizeof(PARAMS) / sizeof(PARAMS[0]);
+
+int SearchParams::count() {
+    return PARAM_COUNT;
+}
+
+const SearchParams::ParamInfo& SearchParams::info(int index) {
+    return PARAMS[index];
+}
+
+int SearchParams::find(const std::string& name) {
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        if (name == PARAMS[i].name) return i;
+    }
+    return -1;
+}
+
+SearchParams& SearchParams::active() {
+    static SearchParams params;
+    return params;
+}
+
+bool SearchParams::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    SearchParams loaded = *this;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string key;
+        long long value;
+        if (!(iss >> key >> value)) return false;
+
+        int index = find(key);
+        if (index < 0 || value < PARAMS[index].min || value > PARAMS[index].max) return false;
+        loaded[index] = (int)value;
+    }
+    *this = loaded;
+    return true;
+}
+
+bool SearchParams::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "# Gomoku search parameters\n";
+    for (int i = 0; i < PARAM_COUNT; ++i) out << PARAMS[i].name << " " << (*this)[i] << "\n";
+    return (bool)out;
+}
+
+uint64_t SearchParams::fingerprint() const {
+    // FNV-1a over the values; depth and time limits only decide how far a search gets
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        if (!PARAMS[i].tunable) continue;
+        int v = (*this)[i];
+        for (int b = 0; b < 4; ++b) {
+            h ^= (uint64_t)(v >> (b * 8)) & 0xFF;
+            h *= 0x100000001B3ULL;
+        }
+    }
+    return h;
+}
+
+bool SearchParams::loadDefault() {
+    const char* env = std::getenv("GOMOKU_PARAMS");
+    if (env && active().load(env)) return true;
+    return active().load("../weights/search.txt");
+}
@@ -0,0 +1,270 @@
+#include "../include/SmallBoard.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Everything that only depends on size and run length, shared by all boards
+struct SmallBoard::Geometry {
+    int size = 0;
+    int inRow = 0;
+    int cells = 0;
+    int lines = 0;
+    std::vector<uint8_t> lineCells;         // inRow cells per line
+    std::vector<uint16_t> cellLineStart;    // cellLines[cellLineStart[i] .. cellLineStart[i + 1]) are the lines through cell i
+    std::vector<uint16_t> cellLines;
+    uint8_t sym[8][MAX_CELLS];
+    uint8_t inverse[8][MAX_CELLS];
+    uint64_t zobrist[2][MAX_CELLS];
+};
+
+static std::shared_ptr<const SmallBoard::Geometry> makeGeometry(int size, int inRow);
+
+static std::shared_ptr<const SmallBoard::Geometry> geometryFor(int size, int inRow) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const SmallBoard::Geometry>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& geo = cache[{size, inRow}];
+    if (!geo) geo = makeGeometry(size, inRow);
+    return geo;
+}
+
+static std::shared_ptr<const SmallBoard::Geometry> makeGeometry(int size, int inRow) {
+    auto geo = std::make_shared<SmallBoard::Geometry>();
+    geo->size = size;
+    geo->inRow = inRow;
+    geo->cells = size * size;
+
+    const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    std::vector<std::vector<uint16_t>> through(geo->cells);
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            for (auto& d : dirs) {
+                int endR = r + d[0] * (inRow - 1), endC = c + d[1] * (inRow - 1);
+                if (endR < 0 || endR >= size || endC < 0 || endC >= size) continue;
+                for (int i = 0; i < inRow; ++i) {
+                    int cell = (r + d[0] * i) * size + (c + d[1] * i);
+                    geo->lineCells.push_back((uint8_t)cell);
+                    through[cell].push_back((uint16_t)geo->lines);
+                }
+                geo->lines++;
+            }
+        }
+    }
+    for (int i = 0; i < geo->cells; ++i) {
+        geo->cellLineStart.push_back((uint16_t)geo->cellLines.size());
+        geo->cellLines.insert(geo->cellLines.end(), through[i].begin(), through[i].end());
+    }
+    geo->cellLineStart.push_back((uint16_t)geo->cellLines.size());
+
+    for (int s = 0; s < 8; ++s) {
+        for (int i = 0; i < geo->cells; ++i) {
+            int r = i / size, c = i % size;
+            if (s & 4) std::swap(r, c);
+            if (s & 1) c = size - 1 - c;
+            if (s & 2) r = size - 1 - r;
+            int image = r * size + c;
+            geo->sym[s][i] = (uint8_t)image;
+            geo->inverse[s][image] = (uint8_t)i;
+        }
+    }
+
+    // Fixed-seed splitmix64, different per variant, so keys can be stored in solution files
+    uint64_t x = 0x9E3779B97F4A7C15ULL * (uint64_t)(size * 16 + inRow);
+    for (int side = 0; side < 2; ++side) {
+        for (int i = 0; i < SmallBoard::MAX_CELLS; ++i) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            geo->zobrist[side][i] = z ^ (z >> 31);
+        }
+    }
+    return geo;
+}
+
+SmallBoard::SmallBoard(int size, int inRow) {
+    size = std::clamp(size, 3, MAX_SIZE);
+    geo = geometryFor(size, std::clamp(inRow, 3, size));
+    lineCount[0].fill(0);
+    lineCount[1].fill(0);
+    open[0] = open[1] = geo->lines;
+    openByCount[0][0] = openByCount[1][0] = geo->lines;
+}
+
+int SmallBoard::size() const { return geo->size; }
+int SmallBoard::inRow() const { return geo->inRow; }
+int SmallBoard::cells() const { return geo->cells; }
+
+Side SmallBoard::get(int cell) const {
+    uint64_t bit = 1ULL << (cell & 63);
+    if (bits[0][cell >> 6] & bit) return Side::Black;
+    if (bits[1][cell >> 6] & bit) return Side::White;
+    return Side::None;
+}
+
+bool SmallBoard::play(int cell) {
+    const int s = stoneCount & 1, o = s ^ 1;
+    const int k = geo->inRow;
+    bits[s][cell >> 6] |= 1ULL << (cell & 63);
+    for (int sym = 0; sym < 8; ++sym) hashes[sym] ^= geo->zobrist[s][geo->sym[sym][cell]];
+    stoneCount++;
+
+    bool won = false;
+    for (int i = geo->cellLineStart[cell]; i < geo->cellLineStart[cell + 1]; ++i) {
+        int line = geo->cellLines[i];
+        int mine = lineCount[s][line], theirs = lineCount[o][line];
+        if (mine == 0) {
+            open[o]--;                          // The first stone of s closes the line to o
+            openByCount[o][theirs]--;
+            if (theirs == k - 1) near[o]--;
+        }
+        if (theirs == 0) {
+            openByCount[s][mine]--;
+            openByCount[s][mine + 1]++;
+            if (mine == k - 2) near[s]++;
+            else if (mine == k - 1) {
+                near[s]--;
+                won = true;
+            }
+        }
+        lineCount[s][line] = (uint8_t)(mine + 1);
+    }
+    return won;
+}
+
+void SmallBoard::undo(int cell) {
+    stoneCount--;
+    const int s = stoneCount & 1, o = s ^ 1;
+    const int k = geo->inRow;
+    bits[s][cell >> 6] &= ~(1ULL << (cell & 63));
+    for (int sym = 0; sym < 8; ++sym) hashes[sym] ^= geo->zobrist[s][geo->sym[sym][cell]];
+
+    for (int i = geo->cellLineStart[cell]; i < geo->cellLineStart[cell + 1]; ++i) {
+        int line = geo->cellLines[i];
+        int mine = --lineCount[s][line], theirs = lineCount[o][line];
+        if (mine == 0) {
+            open[o]++;
+            openByCount[o][theirs]++;
+            if (theirs == k - 1) near[o]++;
+        }
+        if (theirs == 0) {
+            openByCount[s][mine + 1]--;
+            openByCount[s][mine]++;
+            if (mine == k - 2) near[s]--;
+            else if (mine == k - 1) near[s]++;
+        }
+    }
+}
+
+int SmallBoard::winningCells(Side side, int* out) const {
+    const int s = (int)side, o = s ^ 1;
+    const int k = geo->inRow;
+    int count = 0;
+    if (near[s] == 0) return 0;
+    for (int line = 0; line < geo->lines; ++line) {
+        if (lineCount[s][line] != k - 1 || lineCount[o][line] != 0) continue;
+        const uint8_t* cellsOf = &geo->lineCells[(size_t)line * k];
+        for (int i = 0; i < k; ++i) {
+            if (get(cellsOf[i]) != Side::None) continue;
+            if (std::find(out, out + count, (int)cellsOf[i]) == out + count) out[count++] = cellsOf[i];
+            break;
+        }
+    }
+    return count;
+}
+
+bool SmallBoard::canWin(Side side) const {
+    const int s = (int)side;
+    const int k = geo->inRow;
+    int empty = geo->cells - stoneCount;
+    int movesLeft = (side == toMove()) ? (empty + 1) / 2 : empty / 2;
+    for (int count = k - 1; count >= 0 && k - count <= movesLeft; --count) {
+        if (openByCount[s][count] > 0) return true;
+    }
+    return false;
+}
+
+bool SmallBoard::live(int cell) const {
+    for (int i = geo->cellLineStart[cell]; i < geo->cellLineStart[cell + 1]; ++i) {
+        int line = geo->cellLines[i];
+        if (lineCount[0][line] == 0 || lineCount[1][line] == 0) return true;
+    }
+    return false;
+}
+
+int SmallBoard::potential(int cell, bool defend) const {
+    const int s = stoneCount & 1, o = s ^ 1;
+    const int ownShift = defend ? 0 : 1, blockShift = defend ? 5 : 0;
+    int weight = 0;
+    for (int i = geo->cellLineStart[cell]; i < geo->cellLineStart[cell + 1]; ++i) {
+        int line = geo->cellLines[i];
+        int mine = lineCount[s][line], theirs = lineCount[o][line];
+        if (theirs == 0) weight += 1 << (2 * mine + ownShift);
+        if (mine == 0) weight += 1 << (2 * theirs + blockShift);
+    }
+    return weight;
+}
+
+uint64_t SmallBoard::canonicalHash(int* sym) const {
+    int best = 0;
+    for (int s = 1; s < 8; ++s) {
+        if (hashes[s] < hashes[best]) best = s;
+    }
+    if (sym) *sym = best;
+    return hashes[best];
+}
+
+int SmallBoard::transform(int cell, int sym) const {
+    return geo->sym[sym][cell];
+}
+
+int SmallBoard::inverseTransform(int cell, int sym) const {
+    return geo->inverse[sym][cell];
+}
+
+uint8_t SmallBoard::symmetries() const {
+    uint8_t mask = 1;
+    for (int s = 1; s < 8; ++s) {
+        if (hashes[s] == hashes[0]) mask |= (uint8_t)(1 << s);
+    }
+    return mask;
+}
+
+std::string SmallBoard::cellName(int cell) const {
+    if (cell < 0 || cell >= cells()) return "--";
+    return std::string(1, (char)('a' + cell % size())) + std::to_string(cell / size() + 1);
+}
+
+int SmallBoard::parseCell(const std::string& text) const {
+    if (text.size() < 2 || !std::isalpha((unsigned char)text[0])) return -1;
+    int c = std::tolower((unsigned char)text[0]) - 'a';
+    int r = 0;
+    for (size_t i = 1; i < text.size(); ++i) {
+        if (!std::isdigit((unsigned char)text[i])) return -1;
+        r = r * 10 + (text[i] - '0');
+    }
+    r--;
+    if (r < 0 || r >= size() || c < 0 || c >= size()) return -1;
+    return r * size() + c;
+}
+
+std::string SmallBoard::toString() const {
+    std::string out = "   ";
+    for (int c = 0; c < size(); ++c) {
+        out += (char)('A' + c);
+        out += ' ';
+    }
+    out += "\n";
+    for (int r = 0; r < size(); ++r) {
+        if (r + 1 < 10) out += ' ';
+        out += std::to_string(r + 1) + " ";
+        for (int c = 0; c < size(); ++c) {
+            Side s = get(r * size() + c);
+            out += (s == Side::Black) ? "X " : (s == Side::White) ? "O " : ". ";
+        }
+        out += "\n";
+    }
+    return out;
+}
@@ -0,0 +1,485 @@
+#include "../include/SmallBoardSolver.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+// Shared transposition table: 16-byte slots in 4-way buckets. A slot holds
+// key ^ data next to data, so a slot torn by a concurrent write fails the key
+// check instead of returning another position's result.
+class SmallBoardSolver::Table {
+public:
+    enum Bound : uint8_t { Upper = 1, Lower = 2, Exact = 3 };
+
+    explicit Table(size_t megabytes) {
+        size_t count = 4;
+        while (count * 2 * sizeof(Slot) <= (megabytes << 20)) count *= 2;
+        slots.reset(new Slot[count]);
+        slotCount = count;
+        bucketMask = count / 4 - 1;
+    }
+
+    bool probe(uint64_t key, int& value, Bound& bound, int& cell) const {
+        const Slot* bucket = &slots[(key & bucketMask) * 4];
+        for (int i = 0; i < 4; ++i) {
+            uint64_t data = bucket[i].data.load(std::memory_order_relaxed);
+            if (data == 0 || (bucket[i].check.load(std::memory_order_relaxed) ^ data) != key) continue;
+            decode(data, value, bound, cell);
+            return true;
+        }
+        return false;
+    }
+
+    // Replaces the same position, else the slot whose result took the least work
+    void store(uint64_t key, int value, Bound bound, int cell, int work) {
+        Slot* bucket = &slots[(key & bucketMask) * 4];
+        Slot* victim = &bucket[0];
+        int victimWork = 64;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t data = bucket[i].data.load(std::memory_order_relaxed);
+            if (data == 0 || (bucket[i].check.load(std::memory_order_relaxed) ^ data) == key) {
+                victim = &bucket[i];
+                break;
+            }
+            int slotWork = (int)(data >> 12) & 63;
+            if (slotWork < victimWork) {
+                victim = &bucket[i];
+                victimWork = slotWork;
+            }
+        }
+        uint64_t data = (uint64_t)(value + 1) | (uint64_t)bound << 2 | (uint64_t)(cell & 0xFF) << 4 | (uint64_t)std::min(work, 63) << 12;
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < slotCount; ++i) {
+            uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+            if (data == 0) continue;
+            int value, cell;
+            Bound bound;
+            decode(data, value, bound, cell);
+            f(slots[i].check.load(std::memory_order_relaxed) ^ data, value, bound, cell);
+        }
+    }
+
+    double usage() const {
+        size_t used = 0;
+        for (size_t i = 0; i < slotCount; ++i) used += slots[i].data.load(std::memory_order_relaxed) != 0;
+        return (double)used / slotCount;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};     // value + 1: 2 bits, bound: 2, cell: 8, log2 of the work: 6
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount = 0;
+    size_t bucketMask = 0;
+
+    static void decode(uint64_t data, int& value, Bound& bound, int& cell) {
+        value = (int)(data & 3) - 1;
+        bound = (Bound)((data >> 2) & 3);
+        cell = (int)(data >> 4) & 0xFF;
+    }
+};
+
+struct SmallBoardSolver::Worker {
+    long long nodes = 0;
+    long long reported = 0;
+    bool aborted = false;
+    StopToken stop;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::atomic<long long>* sharedNodes = nullptr;
+
+    void poll() {
+        if (stop.stopRequested() || std::chrono::steady_clock::now() >= deadline) aborted = true;
+        if (sharedNodes) {
+            *sharedNodes += nodes - reported;
+            reported = nodes;
+        }
+    }
+};
+
+struct SmallBoardSolver::TreeNode {
+    std::vector<int> path;          // Moves from the root
+    uint64_t key = 0;
+    int sym = 0;                    // Symmetry that gives the canonical hash
+    bool solved = false;
+    int value = 0;
+    int best = -1;                  // In the orientation of path
+    std::vector<std::pair<int, int>> children;     // Move and node index; -1: the move wins at once
+};
+
+static int log2Work(long long nodes) {
+    int bits = 0;
+    while (nodes > 1) {
+        nodes >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+SmallBoardSolver::SmallBoardSolver(size_t tableMegabytes) : table(new Table(tableMegabytes)) {}
+
+SmallBoardSolver::~SmallBoardSolver() {
+    delete table;
+}
+
+double SmallBoardSolver::tableUsage() const {
+    return table->usage();
+}
+
+// Moves worth searching, best first: the single block against an opponent
+// win (all of them if there are several, for the caller to see the loss),
+// else every empty cell on an open line, one per mirror-image class
+int SmallBoardSolver::generate(SmallBoard& board, int* moves, int ttMove, bool defend) const {
+    Side opp = (board.toMove() == Side::Black) ? Side::White : Side::Black;
+    if (board.nearWins(opp) > 0) return board.winningCells(opp, moves);
+
+    uint8_t syms = board.symmetries();
+    int scores[SmallBoard::MAX_CELLS];
+    int n = 0;
+    for (int cell = 0; cell < board.cells(); ++cell) {
+        if (!board.isEmpty(cell) || !board.live(cell)) continue;
+        bool mirrored = false;
+        for (int s = 1; s < 8 && !mirrored; ++s) {
+            if ((syms >> s & 1) && board.transform(cell, s) < cell) mirrored = true;
+        }
+        if (mirrored) continue;
+
+        int score = (cell == ttMove) ? INT_MAX : board.potential(cell, defend);
+        int i = n++;
+        for (; i > 0 && scores[i - 1] < score; --i) {
+            moves[i] = moves[i - 1];
+            scores[i] = scores[i - 1];
+        }
+        moves[i] = cell;
+        scores[i] = score;
+    }
+    return n;
+}
+
+int SmallBoardSolver::search(Worker& w, SmallBoard& board, int alpha, int beta, int* bestOut) {
+    if ((++w.nodes & 4095) == 0) w.poll();
+    if (w.aborted) return 0;
+    if (bestOut) *bestOut = -1;
+
+    Side me = board.toMove();
+    Side opp = (me == Side::Black) ? Side::White : Side::Black;
+    int moves[SmallBoard::MAX_CELLS];
+    if (board.nearWins(me) > 0) {
+        if (bestOut) {
+            board.winningCells(me, moves);
+            *bestOut = moves[0];
+        }
+        return 1;
+    }
+    if (board.isFull()) return 0;
+
+    // A side without an open line it can still fill cannot win any more
+    int upper = board.canWin(me) ? 1 : 0;
+    int lower = board.canWin(opp) ? -1 : 0;
+    if (upper == lower || upper <= alpha) return upper;
+    if (lower >= beta) return lower;
+    alpha = std::max(alpha, lower);
+    beta = std::min(beta, upper);
+
+    int sym;
+    uint64_t key = board.canonicalHash(&sym);
+    int ttMove = -1;
+    int value, cell;
+    Table::Bound bound;
+    if (table->probe(key, value, bound, cell)) {
+        if (cell < board.cells()) ttMove = board.inverseTransform(cell, sym);
+        bool cut = bound == Table::Exact || (bound == Table::Lower && value >= beta) || (bound == Table::Upper && value <= alpha);
+        if (cut && (!bestOut || ttMove >= 0)) {
+            if (bestOut) *bestOut = ttMove;
+            return value;
+        }
+        if (bound == Table::Lower) alpha = std::max(alpha, value);
+        else if (bound == Table::Upper) beta = std::min(beta, value);
+    }
+
+    // Where a draw is not yet secured the side to move defends: one block per
+    // attack proves the draw, and blocking moves find it far sooner
+    int n = generate(board, moves, ttMove, alpha < 0);
+    if (n == 0) return 0;
+    if (board.nearWins(opp) > 0 && n > 1) {
+        // Two cells win for the opponent and only one can be blocked
+        table->store(key, -1, Table::Exact, board.transform(moves[0], sym), 0);
+        if (bestOut) *bestOut = moves[0];
+        return -1;
+    }
+
+    const long long startNodes = w.nodes;
+    const int searchAlpha = alpha;
+    int bestValue = -2, best = moves[0];
+    for (int i = 0; i < n; ++i) {
+        int move = moves[i];
+        int v = board.play(move) ? 1 : -search(w, board, -beta, -alpha, nullptr);
+        board.undo(move);
+        if (w.aborted) return 0;
+        if (v > bestValue) {
+            bestValue = v;
+            best = move;
+            if (v > alpha) {
+                alpha = v;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+
+    Table::Bound result = (bestValue <= searchAlpha) ? Table::Upper : (bestValue >= beta) ? Table::Lower : Table::Exact;
+    table->store(key, bestValue, result, board.transform(best, sym), log2Work(w.nodes - startNodes));
+    if (bestOut) *bestOut = best;
+    return bestValue;
+}
+
+// Two null-window searches, "does the side to move win?" then "does it
+// lose?", so each node of either one is clearly attacking or defending
+int SmallBoardSolver::exact(Worker& w, SmallBoard& board, int* best) {
+    int value = search(w, board, 0, 1, best);
+    if (value <= 0 && !w.aborted) value = search(w, board, -1, 0, best);
+    return value;
+}
+
+int SmallBoardSolver::solve(const SmallBoard& board, int& best, const StopToken& stop, std::chrono::steady_clock::time_point deadline) {
+    auto start = std::chrono::steady_clock::now();
+    Worker w;
+    w.stop = stop;
+    w.deadline = deadline;
+    SmallBoard work = board;
+    int value = exact(w, work, &best);
+    counters = Stats();
+    counters.nodes = w.nodes;
+    counters.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return w.aborted ? -2 : value;
+}
+
+void SmallBoardSolver::buildTree(const SmallBoard& root, int splitPly) {
+    tree.clear();
+    tree.emplace_back();
+    std::unordered_map<uint64_t, int> index;
+    int moves[SmallBoard::MAX_CELLS];
+
+    // Breadth first, so every node comes after its parents
+    for (size_t i = 0; i < tree.size(); ++i) {
+        SmallBoard board = root;
+        for (int move : tree[i].path) board.play(move);
+        tree[i].key = board.canonicalHash(&tree[i].sym);
+
+        Side me = board.toMove();
+        Side opp = (me == Side::Black) ? Side::White : Side::Black;
+        int upper = board.canWin(me) ? 1 : 0;
+        int lower = board.canWin(opp) ? -1 : 0;
+        if (board.nearWins(me) > 0) {
+            board.winningCells(me, moves);
+            tree[i].solved = true;
+            tree[i].value = 1;
+            tree[i].best = moves[0];
+            continue;
+        }
+        if (board.isFull() || upper == lower) {
+            tree[i].solved = true;
+            tree[i].value = board.isFull() ? 0 : upper;
+            continue;
+        }
+        if ((int)tree[i].path.size() >= splitPly) continue;
+
+        int n = generate(board, moves, -1);
+        if (board.nearWins(opp) > 0 && n > 1) {
+            tree[i].solved = true;
+            tree[i].value = -1;
+            tree[i].best = moves[0];
+            continue;
+        }
+        for (int m = 0; m < n; ++m) {
+            if (board.play(moves[m])) {
+                tree[i].children.push_back({moves[m], -1});
+            } else {
+                auto found = index.emplace(board.canonicalHash(), (int)tree.size());
+                if (found.second) {
+                    TreeNode child;
+                    child.path = tree[i].path;
+                    child.path.push_back(moves[m]);
+                    tree.push_back(std::move(child));
+                }
+                tree[i].children.push_back({moves[m], found.first->second});
+            }
+            board.undo(moves[m]);
+        }
+    }
+}
+
+int SmallBoardSolver::solveParallel(const SmallBoard& board, int threads, int splitPly, int& best,
+                                    const std::function<void(long long, long long, long long)>& progress) {
+    auto start = std::chrono::steady_clock::now();
+    counters = Stats();
+    buildTree(board, std::max(0, splitPly));
+
+    std::vector<int> jobs;
+    for (size_t i = 0; i < tree.size(); ++i) {
+        if (!tree[i].solved && tree[i].children.empty()) jobs.push_back((int)i);
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<long long> done{0};
+    std::atomic<long long> nodes{0};
+    auto worker = [&]() {
+        Worker w;
+        w.sharedNodes = &nodes;
+        for (size_t j = next++; j < jobs.size(); j = next++) {
+            TreeNode& node = tree[jobs[j]];
+            SmallBoard leaf = board;
+            for (int move : node.path) leaf.play(move);
+            node.value = exact(w, leaf, &node.best);
+            node.solved = true;
+            done++;
+        }
+        nodes += w.nodes - w.reported;
+    };
+    std::vector<std::thread> pool;
+    int threadCount = std::max(1, std::min(threads, (int)jobs.size()));
+    for (int t = 0; t < threadCount; ++t) pool.emplace_back(worker);
+    auto lastReport = start;
+    while (done.load() < (long long)jobs.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (progress && std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(5)) {
+            lastReport = std::chrono::steady_clock::now();
+            progress(done.load(), (long long)jobs.size(), nodes.load());
+        }
+    }
+    for (auto& t : pool) t.join();
+
+    // Back the leaf values up the tree
+    for (size_t i = tree.size(); i-- > 0;) {
+        TreeNode& node = tree[i];
+        if (node.children.empty()) continue;
+        node.value = -2;
+        for (const auto& child : node.children) {
+            int v = (child.second < 0) ? 1 : -tree[child.second].value;
+            if (v > node.value) {
+                node.value = v;
+                node.best = child.first;
+            }
+        }
+        node.solved = true;
+    }
+
+    roots.clear();
+    for (const auto& child : tree[0].children) {
+        roots.push_back({child.first, (child.second < 0) ? 1 : -tree[child.second].value});
+    }
+    std::stable_sort(roots.begin(), roots.end(), [](const RootMove& a, const RootMove& b) { return a.value > b.value; });
+
+    counters.nodes = nodes.load();
+    counters.jobs = (long long)jobs.size();
+    counters.treePositions = (long long)tree.size();
+    counters.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = tree[0].best;
+    return tree[0].value;
+}
+
+bool SmallBoardSolver::writeBook(const std::string& path, const SmallBoard& board, size_t* written) const {
+    // Tree positions first: on equal keys the sort keeps them over table entries
+    std::vector<SolutionBook::Entry> entries;
+    for (const auto& node : tree) {
+        if (!node.solved) continue;
+        uint8_t cell = (node.best >= 0) ? (uint8_t)board.transform(node.best, node.sym) : 255;
+        entries.push_back({node.key, cell, (int8_t)node.value});
+    }
+    // Table entries whose value is proven: exact ones, wins as lower bounds, losses as upper bounds
+    table->forEach([&](uint64_t key, int value, Table::Bound bound, int cell) {
+        if (bound == Table::Exact || (bound == Table::Lower && value == 1)) entries.push_back({key, (uint8_t)cell, (int8_t)value});
+        else if (bound == Table::Upper && value == -1) entries.push_back({key, 255, -1});
+    });
+    if (!SolutionBook::write(path, board.size(), board.inRow(), entries)) return false;
+    if (written) *written = entries.size();
+    return true;
+}
+
+static const char BOOK_MAGIC[8] = {'G', 'M', 'K', 'S', 'O', 'L', 'V', '1'};
+
+bool SolutionBook::write(const std::string& path, int size, int inRow, std::vector<Entry>& entries) {
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key == b.key; }), entries.end());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    unsigned char header[24] = {};
+    std::memcpy(header, BOOK_MAGIC, 8);
+    header[8] = (unsigned char)size;
+    header[9] = (unsigned char)inRow;
+    uint64_t count = entries.size();
+    for (int i = 0; i < 8; ++i) header[16 + i] = (unsigned char)(count >> (8 * i));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    std::vector<unsigned char> chunk;
+    chunk.reserve(10 * 65536);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        for (int b = 0; b < 8; ++b) chunk.push_back((unsigned char)(entries[i].key >> (8 * b)));
+        chunk.push_back(entries[i].cell);
+        chunk.push_back((unsigned char)entries[i].value);
+        if (chunk.size() >= 10 * 65536 || i + 1 == entries.size()) {
+            out.write(reinterpret_cast<const char*>(chunk.data()), (std::streamsize)chunk.size());
+            chunk.clear();
+        }
+    }
+    return (bool)out;
+}
+
+bool SolutionBook::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    unsigned char header[24];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || std::memcmp(header, BOOK_MAGIC, 8) != 0) return false;
+    uint64_t count = 0;
+    for (int i = 0; i < 8; ++i) count |= (uint64_t)header[16 + i] << (8 * i);
+    if (header[8] < 3 || header[8] > SmallBoard::MAX_SIZE || count > (1ULL << 36)) return false;
+
+    std::vector<uint64_t> k;
+    std::vector<uint8_t> c;
+    std::vector<int8_t> v;
+    k.reserve(count);
+    c.reserve(count);
+    v.reserve(count);
+    std::vector<unsigned char> chunk(10 * 65536);
+    uint64_t remaining = count;
+    while (remaining > 0) {
+        size_t n = (size_t)std::min<uint64_t>(remaining, 65536);
+        if (!in.read(reinterpret_cast<char*>(chunk.data()), (std::streamsize)(n * 10))) return false;
+        for (size_t i = 0; i < n; ++i) {
+            const unsigned char* p = &chunk[i * 10];
+            uint64_t key = 0;
+            for (int b = 0; b < 8; ++b) key |= (uint64_t)p[b] << (8 * b);
+            k.push_back(key);
+            c.push_back(p[8]);
+            v.push_back((int8_t)p[9]);
+        }
+        remaining -= n;
+    }
+    boardSize = header[8];
+    runLength = header[9];
+    keys.swap(k);
+    cells.swap(c);
+    values.swap(v);
+    return true;
+}
+
+bool SolutionBook::probe(const SmallBoard& board, int& value, int& best) const {
+    if (!matches(board)) return false;
+    int sym;
+    uint64_t key = board.canonicalHash(&sym);
+    auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) return false;
+    size_t i = (size_t)(it - keys.begin());
+    value = values[i];
+    best = (cells[i] < board.cells()) ? board.inverseTransform(cells[i], sym) : -1;
+    if (best >= 0 && !board.isEmpty(best)) best = -1;
+    return true;
+}
@@ -0,0 +1,409 @@
+#include "../include/SparseBoard.h"
+#include <algorithm>
+#include <utility>
+
+static const int DIRS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int nibbleShift(int side, int dir) {
+    return 4 * (side * 4 + dir);
+}
+
+// For the cell line[at]: the most stones (not counting the cell) each side
+// has in a window of 5 cells through it that holds no opposing stone.
+// line[at - 4] .. line[at + 4] must be valid.
+static uint32_t windowNibbles(const Side* line, int at, int dir) {
+    uint32_t nibbles = 0;
+    for (int side = 0; side < 2; ++side) {
+        int best = 0;
+        for (int start = at - 4; start <= at; ++start) {
+            int own = 0;
+            bool blocked = false;
+            for (int k = start; k < start + 5 && !blocked; ++k) {
+                if (k == at || line[k] == Side::None) continue;
+                if (line[k] == (Side)side) own++;
+                else blocked = true;
+            }
+            if (!blocked) best = std::max(best, own);
+        }
+        nibbles |= (uint32_t)best << nibbleShift(side, dir);
+    }
+    return nibbles;
+}
+
+static bool rowOrder(Cell a, Cell b) {
+    return a.r != b.r ? a.r < b.r : a.c < b.c;
+}
+
+// ---- CellTable ----
+
+SparseBoard::CellTable::CellTable(size_t capacity) : slots(capacity, Slot{0, CellInfo()}) {}
+
+size_t SparseBoard::CellTable::home(uint64_t key) const {
+    return mix(key) & (slots.size() - 1);
+}
+
+SparseBoard::CellInfo* SparseBoard::CellTable::find(uint64_t key) {
+    size_t mask = slots.size() - 1;
+    for (size_t i = home(key);; i = (i + 1) & mask) {
+        if (slots[i].key == key) return &slots[i].info;
+        if (slots[i].key == 0) return nullptr;
+    }
+}
+
+const SparseBoard::CellInfo* SparseBoard::CellTable::find(uint64_t key) const {
+    return const_cast<CellTable*>(this)->find(key);
+}
+
+SparseBoard::CellInfo& SparseBoard::CellTable::insert(uint64_t key) {
+    if ((used + 1) * 2 > slots.size()) grow();
+    size_t mask = slots.size() - 1;
+    size_t i = home(key);
+    for (; slots[i].key != 0; i = (i + 1) & mask) {
+        if (slots[i].key == key) return slots[i].info;
+    }
+    slots[i] = Slot{key, CellInfo()};
+    used++;
+    return slots[i].info;
+}
+
+void SparseBoard::CellTable::erase(uint64_t key) {
+    size_t mask = slots.size() - 1;
+    size_t i = home(key);
+    while (slots[i].key != key) {
+        if (slots[i].key == 0) return;
+        i = (i + 1) & mask;
+    }
+    // Backward shift: pull later entries of the probe chain into the hole so
+    // lookups never need tombstones
+    for (size_t j = (i + 1) & mask; slots[j].key != 0; j = (j + 1) & mask) {
+        size_t h = home(slots[j].key);
+        bool movable = (j > i) ? (h <= i || h > j) : (h <= i && h > j);
+        if (movable) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i] = Slot{0, CellInfo()};
+    used--;
+}
+
+void SparseBoard::CellTable::clear() {
+    std::fill(slots.begin(), slots.end(), Slot{0, CellInfo()});
+    used = 0;
+}
+
+void SparseBoard::CellTable::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{0, CellInfo()});
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const auto& s : old) {
+        if (!s.key) continue;
+        size_t i = home(s.key);
+        while (slots[i].key != 0) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+}
+
+// ---- SparseBoard ----
+
+SparseBoard::SparseBoard() {
+    reset();
+}
+
+void SparseBoard::reset() {
+    cells.clear();
+    stoneList.clear();
+    threatList.clear();
+    box = Box();
+    boxStale = false;
+    zobrist = 0;
+    for (auto& side : patternCounts) std::fill(side, side + PAT_COUNT, 0);
+}
+
+Side SparseBoard::get(Pos p) const {
+    const CellInfo* info = cells.find(pack(p.r, p.c));
+    return info ? info->side : Side::None;
+}
+
+int SparseBoard::countConsecutive(Pos p, int dr, int dc, Side side) const {
+    int count = 0;
+    int r = p.r + dr;
+    int c = p.c + dc;
+    while (get({r, c}) == side) {
+        count++;
+        r += dr;
+        c += dc;
+    }
+    return count;
+}
+
+void SparseBoard::set(Cell m, Side s) {
+    Side old = get(m);
+    if (old == s) return;
+
+    for (int dir = 0; dir < 4; ++dir) addRuns(m, dir, -1);
+    if (old != Side::None) {
+        zobrist ^= mix(pack(m.r, m.c) * 2 + (uint64_t)old);
+        remove(m);
+    }
+    if (s != Side::None) {
+        zobrist ^= mix(pack(m.r, m.c) * 2 + (uint64_t)s);
+        place(m, s);
+    }
+    for (int dir = 0; dir < 4; ++dir) addRuns(m, dir, 1);
+}
+
+void SparseBoard::place(Cell m, Side s) {
+    CellInfo& info = cells.insert(pack(m.r, m.c));
+    unlistThreat(info);
+    info.side = s;
+    info.index = (uint32_t)stoneList.size();
+    stoneList.push_back(m);
+    if (stoneList.size() == 1) {
+        box = Box{m.r, m.c, m.r, m.c};
+        boxStale = false;
+    } else if (!boxStale) {
+        box.minR = std::min(box.minR, m.r);
+        box.maxR = std::max(box.maxR, m.r);
+        box.minC = std::min(box.minC, m.c);
+        box.maxC = std::max(box.maxC, m.c);
+    }
+
+    // Existing candidates first, then the new ones (built from scratch, so
+    // they already see this stone)
+    updateLines(m);
+    for (int dr = -2; dr <= 2; ++dr) {
+        for (int dc = -2; dc <= 2; ++dc) {
+            if (dr == 0 && dc == 0) continue;
+            Cell q = Cell::at(m.r + dr, m.c + dc);
+            CellInfo& near = cells.insert(pack(q.r, q.c));
+            if (near.nearby++ == 0 && near.side == Side::None) refreshCell(q, near);
+        }
+    }
+}
+
+void SparseBoard::remove(Cell m) {
+    uint64_t key = pack(m.r, m.c);
+    CellInfo* info = cells.find(key);
+    info->side = Side::None;
+
+    // Swap-remove from the stone list
+    Cell last = stoneList.back();
+    stoneList[info->index] = last;
+    if (last != m) cells.find(pack(last.r, last.c))->index = info->index;
+    stoneList.pop_back();
+    info->index = 0;
+    if (m.r == box.minR || m.r == box.maxR || m.c == box.minC || m.c == box.maxC) boxStale = true;
+
+    updateLines(m);
+    for (int dr = -2; dr <= 2; ++dr) {
+        for (int dc = -2; dc <= 2; ++dc) {
+            if (dr == 0 && dc == 0) continue;
+            uint64_t nk = pack(m.r + dr, m.c + dc);
+            CellInfo* near = cells.find(nk);
+            if (--near->nearby == 0 && near->side == Side::None) {
+                unlistThreat(*near);
+                cells.erase(nk);
+            }
+        }
+    }
+    // The cell itself stays a candidate if other stones are near it
+    info = cells.find(key);
+    if (info->nearby == 0) cells.erase(key);
+    else refreshCell(m, *info);
+}
+
+// The stone at m was added or removed: update the window counts of the
+// candidates within 4 along each line, and the pattern of each empty cell
+// whose run in that direction reaches m
+void SparseBoard::updateLines(Cell m) {
+    for (int dir = 0; dir < 4; ++dir) {
+        int dr = DIRS[dir][0], dc = DIRS[dir][1];
+        Side line[17];  // m - 8d .. m + 8d
+        for (int i = -8; i <= 8; ++i) line[i + 8] = get(Pos{m.r + i * dr, m.c + i * dc});
+        uint32_t mask = ~(15u << nibbleShift(0, dir) | 15u << nibbleShift(1, dir));
+        for (int i = -4; i <= 4; ++i) {
+            if (i == 0 || line[i + 8] != Side::None) continue;
+            Cell q = Cell::at(m.r + i * dr, m.c + i * dc);
+            CellInfo* info = cells.find(pack(q.r, q.c));
+            if (info) setWindows(q, *info, (info->windows & mask) | windowNibbles(line, i + 8, dir));
+        }
+        // The affected cells are the first empty ones after a run of a single colour
+        for (int step : {-1, 1}) {
+            Pos q = {m.r + step * dr, m.c + step * dc};
+            Side run = get(q);
+            if (run != Side::None) {
+                while (get(q) == run) { q.r += step * dr; q.c += step * dc; }
+                if (get(q) != Side::None) continue;
+            }
+            CellInfo* info = cells.find(pack(q.r, q.c));
+            if (info) refreshPattern(Cell(q), *info, dir);
+        }
+    }
+}
+
+// Same as AIPlayer's point pattern: the run a stone at q would join, by how many ends are open
+void SparseBoard::refreshPattern(Cell q, CellInfo& info, int dir) const {
+    int dr = DIRS[dir][0], dc = DIRS[dir][1];
+    for (int side = 0; side < 2; ++side) {
+        int fwd = countConsecutive(q.pos(), dr, dc, (Side)side);
+        int bwd = countConsecutive(q.pos(), -dr, -dc, (Side)side);
+        bool open1 = isEmpty(Pos{q.r + (fwd + 1) * dr, q.c + (fwd + 1) * dc});
+        bool open2 = isEmpty(Pos{q.r - (bwd + 1) * dr, q.c - (bwd + 1) * dc});
+        int pattern = classifyRun(1 + fwd + bwd, open1, open2);
+        int shift = nibbleShift(side, dir);
+        info.patterns = (info.patterns & ~(15u << shift)) | (uint32_t)(pattern >= 0 ? pattern : NO_PATTERN) << shift;
+    }
+}
+
+void SparseBoard::refreshCell(Cell q, CellInfo& info) {
+    uint32_t windows = 0;
+    for (int dir = 0; dir < 4; ++dir) {
+        Side line[9];   // q - 4d .. q + 4d
+        for (int i = -4; i <= 4; ++i) line[i + 4] = get(Pos{q.r + i * DIRS[dir][0], q.c + i * DIRS[dir][1]});
+        windows |= windowNibbles(line, 4, dir);
+        refreshPattern(q, info, dir);
+    }
+    setWindows(q, info, windows);
+}
+
+// Stores the window counts of the empty cell q and keeps threatList in step
+void SparseBoard::setWindows(Cell q, CellInfo& info, uint32_t windows) {
+    info.windows = windows;
+    bool threat = false;
+    for (int k = 0; k < 8 && !threat; ++k) threat = ((windows >> (4 * k)) & 15) >= 3;
+    if (threat && info.index == 0) {
+        threatList.push_back(q);
+        info.index = (uint32_t)threatList.size();
+    } else if (!threat) {
+        unlistThreat(info);
+    }
+}
+
+void SparseBoard::unlistThreat(CellInfo& info) {
+    if (info.side != Side::None || info.index == 0) return;
+    Cell last = threatList.back();
+    threatList[info.index - 1] = last;
+    cells.find(pack(last.r, last.c))->index = info.index;
+    threatList.pop_back();
+    info.index = 0;
+}
+
+// Adds sign x the features of every run that passes through m - d, m or m + d
+// (the only runs a change at m can create, merge, split or reopen)
+void SparseBoard::addRuns(Cell m, int dir, int sign) {
+    int dr = DIRS[dir][0], dc = DIRS[dir][1];
+    Pos starts[3];
+    int seen = 0;
+    for (int i = -1; i <= 1; ++i) {
+        Pos q = {m.r + i * dr, m.c + i * dc};
+        Side side = get(q);
+        if (side == Side::None) continue;
+        int back = countConsecutive(q, -dr, -dc, side);
+        Pos start = {q.r - back * dr, q.c - back * dc};
+        if (std::find(starts, starts + seen, start) != starts + seen) continue;
+        starts[seen++] = start;
+
+        int count = 1 + back + countConsecutive(q, dr, dc, side);
+        bool open1 = isEmpty(Pos{start.r - dr, start.c - dc});
+        bool open2 = isEmpty(Pos{start.r + count * dr, start.c + count * dc});
+        int pattern = classifyRun(count, open1, open2);
+        // Like evaluateBoard, every stone of the run counts once per direction
+        if (pattern >= 0) patternCounts[(int)side][pattern] += sign * count;
+    }
+}
+
+SparseBoard::Box SparseBoard::bounds() const {
+    if (boxStale) {
+        // A stone on the edge of the box was removed; rescan the stones
+        box = Box();
+        if (!stoneList.empty()) box = Box{stoneList[0].r, stoneList[0].c, stoneList[0].r, stoneList[0].c};
+        for (Cell m : stoneList) {
+            box.minR = std::min(box.minR, m.r);
+            box.maxR = std::max(box.maxR, m.r);
+            box.minC = std::min(box.minC, m.c);
+            box.maxC = std::max(box.maxC, m.c);
+        }
+        boxStale = false;
+    }
+    return box;
+}
+
+void SparseBoard::candidates(std::vector<Cell>& out) const {
+    out.clear();
+    if (stoneList.empty()) {
+        out.push_back(Cell::at(0, 0));
+        return;
+    }
+    cells.forEach([&](uint64_t key, const CellInfo& info) {
+        if (info.side == Side::None) out.push_back(unpack(key));
+    });
+    // Table order depends on the insertion history; sort so equal positions
+    // always produce the same move order
+    std::sort(out.begin(), out.end(), rowOrder);
+}
+
+void SparseBoard::orderedCandidates(Side toMove, size_t limit, std::vector<Cell>& moves, std::vector<int>& keys) const {
+    moves.clear();
+    keys.clear();
+    if (stoneList.empty()) {
+        moves.push_back(Cell::at(0, 0));
+        keys.push_back(0);
+        return;
+    }
+    const auto& weights = EvalWeights::active();
+    auto pointScore = [&](uint32_t patterns, int side) {
+        int s = 0;
+        for (int dir = 0; dir < 4; ++dir) {
+            uint32_t pattern = (patterns >> nibbleShift(side, dir)) & 15;
+            if (pattern != NO_PATTERN) s += weights.order[pattern];
+        }
+        return s;
+    };
+
+    int my = (int)toMove;
+    std::vector<std::pair<int, Cell>>& scored = scoredScratch;
+    scored.clear();
+    cells.forEach([&](uint64_t key, const CellInfo& info) {
+        if (info.side != Side::None) return;
+        int score = pointScore(info.patterns, my) * weights.attackFactor + pointScore(info.patterns, 1 - my);
+        scored.push_back({score, unpack(key)});
+    });
+    size_t n = std::min(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : rowOrder(a.second, b.second);
+    });
+    for (size_t i = 0; i < n; ++i) {
+        moves.push_back(scored[i].second);
+        keys.push_back(scored[i].first);
+    }
+}
+
+void SparseBoard::threatCandidates(std::vector<Cell>& out) const {
+    out.assign(threatList.begin(), threatList.end());
+    std::sort(out.begin(), out.end(), rowOrder);
+}
+
+void SparseBoard::features(Side mySide, int out[PAT_COUNT]) const {
+    int my = (int)mySide, opp = 1 - my;
+    for (int k = 0; k < PAT_COUNT; ++k) out[k] = patternCounts[my][k] - patternCounts[opp][k];
+}
+
+long long SparseBoard::evaluate(Side mySide) const {
+    int features[PAT_COUNT];
+    this->features(mySide, features);
+    const auto& weights = EvalWeights::active().board;
+    long long score = 0;
+    for (int k = 0; k < PAT_COUNT; ++k) score += weights[k] * features[k];
+    return score;
+}
+
+size_t SparseBoard::memoryBytes() const {
+    return sizeof(*this) + cells.bytes() + (stoneList.capacity() + threatList.capacity()) * sizeof(Cell);
+}
@@ -0,0 +1,88 @@
+#include "../include/SpectatorFeed.h"
+#include <algorithm>
+
+static char sideChar(Side s) {
+    return s == Side::Black ? 'b' : 'w';
+}
+
+static std::string boardBody(const GameContext& ctx, const Board& board) {
+    std::string body;
+    body.reserve(4 + Board::SIZE * Board::SIZE);
+    body += sideChar(ctx.toMove);
+    body += ' ';
+    for (int i = 0; i < Board::SIZE * Board::SIZE; ++i) {
+        Side s = board.get(Move::fromIndex(i));
+        body += (s == Side::Black) ? 'x' : (s == Side::White) ? 'o' : '.';
+    }
+    return body;
+}
+
+SpectatorFeed::SpectatorFeed(size_t capacity) : capacity(capacity), ring(capacity) {}
+
+void SpectatorFeed::publish(SpectatorFrame::Kind kind, const char* tag, const std::string& body, const std::string& snapshot) {
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t seq = nextSeq++;
+        std::string prefix = " " + std::to_string(seq) + " ";
+        ring[seq % capacity] = std::make_shared<const SpectatorFrame>(SpectatorFrame{seq, kind, tag + prefix + body + "\n"});
+        if (kind == SpectatorFrame::Kind::Board) latestBoard = ring[seq % capacity];
+        else if (!snapshot.empty()) latestBoard = std::make_shared<const SpectatorFrame>(SpectatorFrame{seq, SpectatorFrame::Kind::Board, "BOARD" + prefix + snapshot + "\n"});
+        notify = listener;
+    }
+    if (notify) notify();
+}
+
+void SpectatorFeed::publishBoard(const GameContext& ctx, const Board& board) {
+    publish(SpectatorFrame::Kind::Board, "BOARD", boardBody(ctx, board));
+}
+
+void SpectatorFeed::publishMove(const GameContext& ctx, const Board& board, const HistoryEntry& entry) {
+    std::string body;
+    body += sideChar(entry.side());
+    body += " " + std::to_string(entry.move.row()) + " " + std::to_string(entry.move.col()) + " " + std::to_string(entry.spentMs);
+    publish(SpectatorFrame::Kind::Move, "MOVE", body, boardBody(ctx, board));
+}
+
+void SpectatorFeed::publishClock(const GameContext& ctx, int stepSecondsLeft) {
+    std::string body;
+    body += sideChar(ctx.toMove);
+    body += " " + std::to_string(stepSecondsLeft) + " " + std::to_string(ctx.elapsedGameSeconds) + " " + std::to_string(ctx.totalGameDurationSeconds);
+    publish(SpectatorFrame::Kind::Clock, "CLOCK", body);
+}
+
+void SpectatorFeed::publishEnd(const Outcome& outcome) {
+    std::string winner = "draw";
+    if (outcome.winner.has_value()) winner = (*outcome.winner == Side::Black) ? "black" : "white";
+    publish(SpectatorFrame::Kind::End, "END", winner + " " + outcome.reason);
+}
+
+uint64_t SpectatorFeed::read(Cursor& cursor, std::vector<SpectatorFramePtr>& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t oldest = nextSeq > capacity ? nextSeq - capacity : 0;
+    uint64_t skipped = 0;
+    if (!cursor.synced || cursor.next < oldest) {
+        if (!latestBoard) {
+            cursor.next = nextSeq; // Nothing to resync from yet; follow live frames
+        } else {
+            // Frames between the snapshot and the oldest kept one can only be clock updates
+            uint64_t resume = std::max(latestBoard->seq + 1, oldest);
+            out.push_back(latestBoard);
+            if (cursor.synced) skipped = resume - cursor.next;
+            cursor.next = resume;
+        }
+        cursor.synced = true;
+    }
+    for (; cursor.next < nextSeq; ++cursor.next) out.push_back(ring[cursor.next % capacity]);
+    return skipped;
+}
+
+uint64_t SpectatorFeed::published() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextSeq;
+}
+
+void SpectatorFeed::setListener(std::function<void()> l) {
+    std::lock_guard<std::mutex> lock(mutex);
+    listener = std::move(l);
+}
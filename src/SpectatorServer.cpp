@@ -0,0 +1,215 @@
+#include "../include/SpectatorServer.h"
+#include <cstdio>
+#include <cstring>
+
+// The few calls that differ between Winsock and POSIX sockets; the server
+// itself is written once against these
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <afunix.h>
+
+static bool startNetworking() {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+}
+static void stopNetworking() { WSACleanup(); }
+static void closeSocket(SOCKET s) { closesocket(s); }
+static void setNonBlocking(SOCKET s) {
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+}
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static bool interrupted() { return WSAGetLastError() == WSAEINTR; }
+static int pollSockets(pollfd* fds, size_t count, int timeoutMs) { return WSAPoll(fds, (ULONG)count, timeoutMs); }
+static const int SEND_FLAGS = 0;
+
+// Winsock has no socketpair: connect to our own listener and accept the
+// connection before the I/O thread starts, while the listener still blocks
+static bool makeWakePair(SOCKET listener, const sockaddr_un& addr, SOCKET pair[2]) {
+    SOCKET writer = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (writer == INVALID_SOCKET) return false;
+    if (connect(writer, reinterpret_cast<const sockaddr*>(&addr), (int)sizeof(addr)) != 0) {
+        closesocket(writer);
+        return false;
+    }
+    SOCKET reader = accept(listener, nullptr, nullptr);
+    if (reader == INVALID_SOCKET) {
+        closesocket(writer);
+        return false;
+    }
+    pair[0] = reader;
+    pair[1] = writer;
+    return true;
+}
+
+#else
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static bool startNetworking() { return true; }
+static void stopNetworking() {}
+static void closeSocket(int fd) { close(fd); }
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+static bool interrupted() { return errno == EINTR; }
+static int pollSockets(pollfd* fds, size_t count, int timeoutMs) { return poll(fds, (nfds_t)count, timeoutMs); }
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+
+static bool makeWakePair(int, const sockaddr_un&, int pair[2]) {
+    return socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+}
+
+#endif
+
+SpectatorServer::SpectatorServer(SpectatorFeed& feed, const std::string& socketPath) : feed(feed), socketPath(socketPath) {}
+
+SpectatorServer::~SpectatorServer() {
+    stop();
+}
+
+bool SpectatorServer::start() {
+    if (!startNetworking()) return false;
+    netStarted = true;
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd == NO_SOCKET) {
+        stop();
+        return false;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    std::remove(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), (int)sizeof(addr)) != 0 || listen(listenFd, 1024) != 0 ||
+        !makeWakePair(listenFd, addr, wake)) {
+        stop();
+        return false;
+    }
+    setNonBlocking(listenFd);
+    setNonBlocking(wake[0]);
+    setNonBlocking(wake[1]);
+    // Every publish wakes the I/O thread; a full buffer already means "wake up"
+    feed.setListener([this]() {
+        char c = 0;
+        ::send(wake[1], &c, 1, SEND_FLAGS);
+    });
+
+    running = true;
+    io = std::thread([this]() { loop(); });
+    return true;
+}
+
+void SpectatorServer::stop() {
+    if (running.exchange(false)) {
+        feed.setListener(nullptr);
+        char c = 0;
+        ::send(wake[1], &c, 1, SEND_FLAGS);
+        io.join();
+    }
+    if (listenFd != NO_SOCKET) {
+        closeSocket(listenFd);
+        std::remove(socketPath.c_str());
+        listenFd = NO_SOCKET;
+    }
+    for (Socket& s : wake) {
+        if (s != NO_SOCKET) closeSocket(s);
+        s = NO_SOCKET;
+    }
+    if (netStarted) stopNetworking();
+    netStarted = false;
+}
+
+bool SpectatorServer::flush(Client& client) {
+    while (!client.pending.empty()) {
+        const std::string& data = client.pending.front()->data;
+        long long n = ::send(client.fd, data.data() + client.offset, (int)(data.size() - client.offset), SEND_FLAGS);
+        if (n < 0) {
+            if (wouldBlock()) return true;
+            if (interrupted()) continue;
+            return false;
+        }
+        client.offset += n;
+        if (client.offset == data.size()) {
+            client.pending.pop_front();
+            client.offset = 0;
+        }
+    }
+    return true;
+}
+
+void SpectatorServer::loop() {
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    std::vector<SpectatorFramePtr> frames;
+
+    while (running) {
+        fds.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wake[0], POLLIN, 0});
+        for (const auto& client : clients) fds.push_back({client.fd, (short)(POLLIN | (client.pending.empty() ? 0 : POLLOUT)), 0});
+
+        if (pollSockets(fds.data(), fds.size(), 1000) < 0) {
+            if (interrupted()) continue;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char buf[256];
+            while (recv(wake[0], buf, (int)sizeof(buf), 0) > 0) {}
+        }
+
+        // Service existing spectators first: fds[2 + i] belongs to clients[i]
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client& client = clients[i];
+            short revents = fds[2 + i].revents;
+            bool alive = !(revents & (POLLERR | POLLHUP | POLLNVAL));
+            if (alive && (revents & POLLIN)) {
+                char buf[512];
+                long long n = recv(client.fd, buf, (int)sizeof(buf), 0);
+                if (n == 0 || (n < 0 && !wouldBlock() && !interrupted())) alive = false;
+            }
+            if (alive && (revents & POLLOUT)) alive = flush(client);
+            if (!alive) {
+                closeSocket(client.fd);
+                continue;
+            }
+            if (kept != i) clients[kept] = std::move(client);
+            kept++;
+        }
+        clients.resize(kept);
+
+        if (fds[0].revents & POLLIN) {
+            Socket fd;
+            while ((fd = accept(listenFd, nullptr, nullptr)) != NO_SOCKET) {
+                setNonBlocking(fd);
+                clients.push_back(Client());
+                clients.back().fd = fd;
+            }
+        }
+        clientCount = clients.size();
+
+        // Pull new frames for every spectator that has caught up; the others
+        // stay where they are and are resynced by the feed if they lag too
+        // far. Frames usually fit in the socket buffer, so send them right away.
+        for (auto& client : clients) {
+            if (client.pending.empty()) {
+                frames.clear();
+                skipped += feed.read(client.cursor, frames);
+                client.pending.assign(frames.begin(), frames.end());
+            }
+            if (!client.pending.empty()) flush(client);
+        }
+    }
+
+    for (auto& client : clients) closeSocket(client.fd);
+    clientCount = 0;
+}
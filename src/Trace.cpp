@@ -0,0 +1,134 @@
+#include "../include/Trace.h"
+
+#ifdef GOMOKU_TRACE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+const size_t RING_EVENTS = 1 << 18;    // Per thread, 6 MiB; older events are overwritten
+const int MAX_NAMES = 32;              // Distinct scope names with running totals
+
+struct Event {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durNs;
+};
+
+struct Total {
+    const char* name = nullptr;
+    uint64_t count = 0;
+    uint64_t ns = 0;
+};
+
+// One per thread. Buffers are owned by the registry, so the events of
+// threads that have already exited (search tasks, workers) are still exported.
+struct ThreadBuffer {
+    int tid = 0;
+    std::unique_ptr<Event[]> events{new Event[RING_EVENTS]};
+    std::atomic<uint64_t> written{0};
+    Total totals[MAX_NAMES];
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+const auto epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        buffer = registry.back().get();
+        buffer->tid = (int)registry.size();
+    }
+    return *buffer;
+}
+
+} // namespace
+
+uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& b = localBuffer();
+    uint64_t n = b.written.load(std::memory_order_relaxed);
+    b.events[n & (RING_EVENTS - 1)] = {name, startNs, endNs - startNs};
+    b.written.store(n + 1, std::memory_order_release);
+
+    for (auto& t : b.totals) {
+        if (t.name != name && t.name) continue;
+        t.name = name;
+        t.count++;
+        t.ns += endNs - startNs;
+        break;
+    }
+}
+
+bool writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& b : registry) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << b->tid
+            << ",\"args\":{\"name\":\"" << (b->tid == 1 ? "main" : "thread " + std::to_string(b->tid)) << "\"}}";
+        first = false;
+
+        uint64_t written = b->written.load(std::memory_order_acquire);
+        uint64_t begin = written > RING_EVENTS ? written - RING_EVENTS : 0;
+        for (uint64_t i = begin; i < written; ++i) {
+            const Event& e = b->events[i & (RING_EVENTS - 1)];
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << ",\"name\":\"" << e.name << "\",\"ts\":"
+                << std::fixed << std::setprecision(3) << e.startNs / 1000.0 << ",\"dur\":" << e.durNs / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+void printSummary(std::ostream& out) {
+    std::vector<Total> totals;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& b : registry) {
+            for (const auto& t : b->totals) {
+                if (!t.name) break;
+                auto it = std::find_if(totals.begin(), totals.end(), [&](const Total& x) { return x.name == t.name; });
+                if (it == totals.end()) totals.push_back(t);
+                else {
+                    it->count += t.count;
+                    it->ns += t.ns;
+                }
+            }
+        }
+    }
+    std::sort(totals.begin(), totals.end(), [](const Total& a, const Total& b) { return a.ns > b.ns; });
+    out << std::left << std::setw(22) << "scope" << std::setw(12) << "ms" << std::setw(12) << "calls" << "us/call\n";
+    for (const auto& t : totals) {
+        out << std::setw(22) << t.name << std::setw(12) << std::fixed << std::setprecision(1) << t.ns / 1e6
+            << std::setw(12) << t.count << std::setprecision(3) << t.ns / 1e3 / std::max<uint64_t>(1, t.count) << "\n";
+    }
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& b : registry) {
+        b->written.store(0);
+        for (auto& t : b->totals) t = Total();
+    }
+}
+
+} // namespace trace
+
+#endif
@@ -0,0 +1,57 @@
+#include "../include/WorkerPool.h"
+
+WorkerPool::WorkerPool(int threads, size_t maxQueued) : maxQueued(maxQueued) {
+    if (threads < 1) threads = 1;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+bool WorkerPool::submit(uint64_t owner, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || total >= maxQueued) return false;
+        auto& queue = queues[owner];
+        if (queue.empty()) ready.push_back(owner);
+        queue.push_back(std::move(task));
+        total++;
+    }
+    cv.notify_one();
+    return true;
+}
+
+size_t WorkerPool::queued() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total;
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return stopping || !ready.empty(); });
+            if (stopping && ready.empty()) return;
+
+            // One task from the owner at the front, then that owner goes to the back
+            uint64_t owner = ready.front();
+            ready.pop_front();
+            auto it = queues.find(owner);
+            task = std::move(it->second.front());
+            it->second.pop_front();
+            if (it->second.empty()) queues.erase(it);
+            else ready.push_back(owner);
+            total--;
+        }
+        task();
+    }
+}
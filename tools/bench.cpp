@@ -0,0 +1,1054 @@
+// Search benchmark.
+//   gomoku_bench [difficulty]             tactical suite: move, depth, nodes, time
+//   gomoku_bench selfplay <pairs> <ms>     equal-time self-play, quiescence on vs off
+//   gomoku_bench eval [iterations]         leaf throughput: evaluateBoard vs NNUE (random weights)
+//   gomoku_bench mcts <ms> <threads>...    MCTS playouts/s for each thread count
+//   gomoku_bench cache <file> [difficulty] suite twice against a persistent search cache, then a game played twice
+//   gomoku_bench stop <ms>                 stop latency: cancel Hard searches after <ms>
+//   gomoku_bench hint <ms> [lines]         multi-PV analysis of each suite position
+//   gomoku_bench rules [depth]             fixed-depth suite under each rule variant: moves, nodes/s
+//   gomoku_bench openings [depth] [dir]    first 10 plies of archived games, symmetry pruning on vs off
+//   gomoku_bench trace [file]              one Hard move with tracing: time per scope, Chrome trace JSON
+//   gomoku_bench spectate <n>...           spectator feed: publish cost and delivery latency for n socket readers
+//   gomoku_bench sparse [stones] [depth]   infinite board: move time, memory and per-call costs as a long game grows
+//   gomoku_bench forced [depth]            fixed-depth suite with forced-reply generation off vs on: nodes, time
+//   gomoku_bench journal [file] [moves]    move journal: game-side cost per action, writes and fsyncs, recovery time
+//   gomoku_bench levels [pairs] [top]      difficulty levels up to top: cost, moves idle vs loaded, Elo (95% CI) between adjacent levels
+//   gomoku_bench alloc [depth]             heap allocations per search at [depth]: none after the first search on a thread
+#include "../include/AIPlayer.h"
+#include "../include/GomokuRuleSet.h"
+#include "../include/Nnue.h"
+#include "../include/MctsPlayer.h"
+#include "../include/SearchCache.h"
+#include "../include/GameRecord.h"
+#include "../include/Trace.h"
+#include "../include/SpectatorServer.h"
+#include "../include/MoveJournal.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#else
+#include <malloc.h>
+#endif
+#include <cstddef>
+#include <new>
+
+// Every heap allocation in this program, for the alloc mode. All the
+// replaceable forms are replaced, so each new pairs with a matching delete.
+// The releases stay out of line: inlined into a caller, GCC would see the
+// pointer from operator new reach free() and warn (-Wmismatched-new-delete).
+static std::atomic<long long> heapAllocations{0};
+
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static void* heapAlloc(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+static void* heapAllocAligned(std::size_t size, std::align_val_t align) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = (std::size_t)align;
+    size = (size ? size + a - 1 : a) / a * a;
+#ifdef _WIN32
+    return _aligned_malloc(size, a);
+#else
+    return std::aligned_alloc(a, size);
+#endif
+}
+BENCH_NOINLINE static void heapFree(void* p) noexcept { std::free(p); }
+BENCH_NOINLINE static void heapFreeAligned(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = heapAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return heapAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return heapAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = heapAllocAligned(size, align)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t align) { return operator new(size, align); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return heapAllocAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return heapAllocAligned(size, align); }
+void operator delete(void* p) noexcept { heapFree(p); }
+void operator delete[](void* p) noexcept { heapFree(p); }
+void operator delete(void* p, std::size_t) noexcept { heapFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { heapFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { heapFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { heapFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { heapFreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { heapFreeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { heapFreeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { heapFreeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { heapFreeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { heapFreeAligned(p); }
+
+struct BenchPosition {
+    std::string name;
+    Side toMove;
+    std::vector<std::pair<Side, Pos>> stones;
+};
+
+static std::vector<BenchPosition> tacticalSuite() {
+    const Side B = Side::Black, W = Side::White;
+    return {
+        {"win-in-1", B, {{B,{7,7}},{B,{7,8}},{B,{7,9}},{B,{7,10}},{W,{7,11}},{W,{8,8}},{W,{6,6}},{W,{9,9}}}},
+        {"block-four", B, {{B,{7,7}},{W,{5,5}},{W,{5,6}},{W,{5,7}},{W,{5,8}},{B,{5,4}},{B,{8,8}},{B,{9,6}}}},
+        {"block-open-three", B, {{B,{7,7}},{W,{9,6}},{W,{9,7}},{W,{9,8}},{B,{6,8}},{B,{8,5}}}},
+        {"make-open-four", B, {{B,{7,6}},{B,{7,7}},{B,{7,8}},{W,{8,7}},{W,{6,7}},{W,{9,9}}}},
+        {"white-open-three", W, {{B,{7,7}},{W,{8,7}},{B,{8,6}},{W,{6,8}},{B,{7,6}},{W,{7,8}},{B,{9,6}}}},
+        {"midgame", B, {{B,{7,7}},{W,{8,7}},{B,{8,6}},{W,{6,8}},{B,{7,6}},{W,{7,8}},{B,{9,6}},{W,{6,6}},
+                        {B,{10,6}},{W,{11,6}},{B,{9,5}},{W,{6,7}}}},
+    };
+}
+
+// Fixed-depth search: no node budget, noise or clock from the difficulty
+static AIPlayer fixedDepthPlayer(int depth) {
+    AIPlayer ai(3);
+    ai.setMaxDepth(depth);
+    ai.setTimeLimitMs(600000);
+    ai.setNodeLimit(-1);
+    return ai;
+}
+
+// Plays one headless game; returns the winner (Side::None on draw). The
+// moves played are appended to record when given.
+static Side playGame(AIPlayer& black, AIPlayer& white, const std::vector<Pos>& opening, std::vector<Move>* record = nullptr) {
+    GomokuRuleSet rules;
+    Board board;
+    GameContext ctx;
+    rules.initGame(ctx, board);
+
+    while (true) {
+        Action action;
+        size_t ply = ctx.history.size();
+        if (ply < opening.size()) {
+            action = Action{ActionType::Place, Move(opening[ply]), 0};
+        } else {
+            AIPlayer& player = (ctx.toMove == Side::Black) ? black : white;
+            action = player.getAction(ctx, board, rules);
+        }
+
+        std::string reason;
+        Side mover = ctx.toMove;
+        if (!rules.validateAction(ctx, board, mover, action, reason)) {
+            return (mover == Side::Black) ? Side::White : Side::Black;
+        }
+        rules.applyAction(ctx, board, mover, action);
+        ctx.history.push_back(HistoryEntry(mover, action));
+        if (record) record->push_back(action.move);
+
+        Outcome outcome = rules.evaluateAfterAction(ctx, board, mover, action);
+        if (outcome.status == GameStatus::Win) return *outcome.winner;
+        if (outcome.status == GameStatus::PendingClaim) return Side::White; // White always claims
+        if (outcome.status == GameStatus::Draw) return Side::None;
+    }
+}
+
+// Short random opening after Tengen, so that game pairs differ
+static std::vector<Pos> randomOpening(std::mt19937& rng) {
+    std::uniform_int_distribution<int> near(-2, 2);
+    std::vector<Pos> opening = {{7, 7}};
+    opening.push_back({7 + std::abs(near(rng)) % 2 + 1, 7 + near(rng)});
+    while (true) {
+        Pos p = {7 + near(rng), 7 + near(rng)};
+        if (std::find(opening.begin(), opening.end(), p) == opening.end()) {
+            opening.push_back(p);
+            break;
+        }
+    }
+    return opening;
+}
+
+static int runSelfPlay(int pairs, int moveMs) {
+    std::mt19937 rng(12345);
+    int wins = 0, losses = 0, draws = 0;
+
+    for (int i = 0; i < pairs; ++i) {
+        std::vector<Pos> opening = randomOpening(rng);
+
+        for (int swap = 0; swap < 2; ++swap) {
+            AIPlayer withQs(3), withoutQs(3);
+            withQs.setTimeLimitMs(moveMs);
+            withoutQs.setTimeLimitMs(moveMs);
+            withQs.setNodeLimit(-1);
+            withoutQs.setNodeLimit(-1);
+            withoutQs.setQuiescence(false);
+
+            bool qsIsBlack = (swap == 0);
+            Side winner = qsIsBlack ? playGame(withQs, withoutQs, opening) : playGame(withoutQs, withQs, opening);
+            Side qsSide = qsIsBlack ? Side::Black : Side::White;
+            if (winner == Side::None) draws++;
+            else if (winner == qsSide) wins++;
+            else losses++;
+            std::cout << "game " << (2 * i + swap + 1) << ": quiescence as " << (qsIsBlack ? "Black" : "White")
+                      << " -> " << (winner == Side::None ? "draw" : (winner == qsSide ? "win" : "loss")) << std::endl;
+        }
+    }
+    std::cout << "quiescence vs none at " << moveMs << " ms/move: +" << wins << " -" << losses << " =" << draws << "\n";
+    return 0;
+}
+
+// Leaf throughput: make a move, evaluate, undo - the pattern a search leaf follows
+static int runEvalBench(int iterations) {
+    NnueNetwork net;
+    net.initRandom(1);
+    auto positions = tacticalSuite();
+
+    auto measure = [&](bool nnue) {
+        long long checksum = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& pos : positions) {
+            Board board;
+            for (const auto& s : pos.stones) board.set(s.second, s.first);
+            NnueAccumulator acc(net);
+            if (nnue) {
+                acc.refresh(board);
+                board.attach(&acc);
+            }
+            for (int i = 0; i < iterations; ++i) {
+                Pos p = {i % Board::SIZE, (i / Board::SIZE) % Board::SIZE};
+                if (!board.isEmpty(p)) continue;
+                board.set(p, pos.toMove);
+                checksum += nnue ? net.evaluate(acc, pos.toMove) : evaluateBoard(board, pos.toMove, pos.toMove == Side::Black ? Side::White : Side::Black);
+                board.clear(p);
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double rate = positions.size() * (double)iterations / sec;
+        std::cout << (nnue ? "nnue          " : "evaluateBoard ") << (long long)rate << " leaves/s (checksum " << checksum << ")\n";
+        return rate;
+    };
+    double hand = measure(false);
+    double nn = measure(true);
+    std::cout << "nnue / evaluateBoard throughput: " << nn / hand << "\n";
+    return 0;
+}
+
+static int runMctsBench(int moveMs, const std::vector<int>& threadCounts) {
+    GomokuRuleSet rules;
+    auto positions = tacticalSuite();
+    double base = 0;
+    for (int threads : threadCounts) {
+        long long playouts = 0, ms = 0, nodes = 0;
+        for (const auto& pos : positions) {
+            // Solved-at-the-root positions only revisit terminal nodes; they say nothing about playout rate
+            if (pos.name == "win-in-1" || pos.name == "make-open-four") continue;
+            Board board;
+            for (const auto& s : pos.stones) board.set(s.second, s.first);
+            GameContext ctx;
+            ctx.toMove = pos.toMove;
+            ctx.turnIndex = (int)pos.stones.size();
+            MctsPlayer mcts(moveMs, threads);
+            mcts.getAction(ctx, board, rules);
+            playouts += mcts.lastStats().playouts;
+            nodes += mcts.lastStats().nodes;
+            ms += mcts.lastStats().elapsedMs;
+        }
+        double rate = playouts * 1000.0 / std::max(1LL, ms);
+        if (base == 0) base = rate;
+        std::cout << threads << " threads: " << (long long)rate << " playouts/s, "
+                  << nodes * 1000 / std::max(1LL, ms) << " nodes/s, speed-up " << rate / base << "\n";
+    }
+    return 0;
+}
+
+// One pass over the tactical suite; returns the total search time in ms.
+// onClock: the difficulty's time limit instead of its node budget and noise
+static long long runSuite(int difficulty, bool onClock = false) {
+    GomokuRuleSet rules;
+
+    std::cout << std::left << std::setw(18) << "position" << std::setw(10) << "move"
+              << std::setw(7) << "depth" << std::setw(12) << "nodes" << std::setw(12) << "qnodes" << "ms\n";
+    long long totalNodes = 0, totalMs = 0;
+    for (const auto& pos : tacticalSuite()) {
+        Board board;
+        for (const auto& s : pos.stones) board.set(s.second, s.first);
+        GameContext ctx;
+        ctx.toMove = pos.toMove;
+        ctx.turnIndex = (int)pos.stones.size();
+
+        AIPlayer ai(difficulty);
+        if (onClock) {
+            ai.setNodeLimit(-1);
+            ai.setNoise(0);
+        }
+        Action action = ai.getAction(ctx, board, rules);
+        const auto& st = ai.lastStats();
+        std::string move = "(" + std::to_string(action.move.row()) + "," + std::to_string(action.move.col()) + ")";
+        std::cout << std::setw(18) << pos.name << std::setw(10) << move << std::setw(7) << st.depth
+                  << std::setw(12) << st.nodes << std::setw(12) << st.qnodes << st.elapsedMs << "\n";
+        totalNodes += st.nodes;
+        totalMs += st.elapsedMs;
+    }
+    std::cout << "total nodes " << totalNodes << ", " << totalMs << " ms\n";
+    return totalMs;
+}
+
+// Runs the suite on the clock against a persistent cache twice: the second
+// pass should be served from it. Then plays the same game twice at the
+// difficulty as played (node budget and noise): the second game must hit on
+// its searched moves and play the same moves as the first.
+static int runCacheBench(const std::string& path, int difficulty) {
+    if (!SearchCache::open(path)) {
+        std::cout << "Failed to open " << path << "\n";
+        return 1;
+    }
+    SearchCache* cache = SearchCache::active();
+    for (int pass = 1; pass <= 2; ++pass) {
+        long long probes = cache->stats().probes, hits = cache->stats().hits, saved = cache->stats().msSaved;
+        std::cout << "pass " << pass << "\n";
+        long long ms = runSuite(difficulty, true);
+        probes = cache->stats().probes - probes;
+        hits = cache->stats().hits - hits;
+        saved = cache->stats().msSaved - saved;
+        std::cout << "cache: " << hits << "/" << probes << " hits, " << saved << " ms of search saved, "
+                  << ms << " ms spent\n\n";
+    }
+
+    std::vector<Move> games[2];
+    long long gameHits = 0, gameProbes = 0;
+    double gameMs[2] = {0, 0};
+    for (int pass = 0; pass < 2; ++pass) {
+        long long probes = cache->stats().probes, hits = cache->stats().hits;
+        auto start = std::chrono::steady_clock::now();
+        AIPlayer black(difficulty), white(difficulty);
+        playGame(black, white, {{7, 7}, {8, 8}, {6, 8}}, &games[pass]);
+        gameMs[pass] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        gameProbes = cache->stats().probes - probes;
+        gameHits = cache->stats().hits - hits;
+    }
+    bool same = games[0] == games[1];
+    bool ok = same && gameProbes > 0 && gameHits == gameProbes;
+    std::cout << "game at difficulty " << difficulty << ": " << games[0].size() << " moves, " << std::fixed << std::setprecision(0)
+              << gameMs[0] << " ms, replayed in " << gameMs[1] << " ms with " << gameHits << "/" << gameProbes << " hits, "
+              << (same ? "same moves" : "DIFFERENT moves") << "\n";
+    SearchCache::closeActive();
+    return ok ? 0 : 1;
+}
+
+// Starts a Hard search on each suite position, stops it after stopAfterMs and
+// reports how long the search took to return once asked
+static int runStopBench(int stopAfterMs) {
+    GomokuRuleSet rules;
+    std::cout << std::left << std::setw(18) << "position" << std::setw(16) << "result" << "stop latency (ms)\n";
+    for (const auto& pos : tacticalSuite()) {
+        Board board;
+        for (const auto& s : pos.stones) board.set(s.second, s.first);
+        GameContext ctx;
+        ctx.toMove = pos.toMove;
+        ctx.turnIndex = (int)pos.stones.size();
+
+        for (int engine = 0; engine < 2; ++engine) {
+            AIPlayer ai(3);
+            ai.setNodeLimit(-1);
+            MctsPlayer mcts(60000);
+            Player& player = engine == 0 ? (Player&)ai : (Player&)mcts;
+            StopSource source;
+            StopToken token = source.token();
+            auto future = std::async(std::launch::async, [&, token]() { return player.getAction(ctx, board, rules, token); });
+            if (future.wait_for(std::chrono::milliseconds(stopAfterMs)) == std::future_status::ready) {
+                std::cout << std::setw(18) << pos.name << std::setw(16) << (engine == 0 ? "ab: done" : "mcts: done") << "-\n";
+                continue;
+            }
+            auto requested = std::chrono::steady_clock::now();
+            source.requestStop();
+            Action action = future.get();
+            double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requested).count();
+            std::string result = action.type == ActionType::Cancelled ? "cancelled" : "move";
+            std::cout << std::setw(18) << pos.name << std::setw(16) << ((engine == 0 ? "ab: " : "mcts: ") + result)
+                      << std::fixed << std::setprecision(2) << latency << "\n";
+        }
+    }
+    return 0;
+}
+
+static std::string cellName(Move m) {
+    return std::string(1, (char)('A' + m.col())) + std::to_string(m.row() + 1);
+}
+
+static int runHintBench(int budgetMs, int lineCount) {
+    GomokuRuleSet rules;
+    for (const auto& pos : tacticalSuite()) {
+        Board board;
+        for (const auto& s : pos.stones) board.set(s.second, s.first);
+        GameContext ctx;
+        ctx.toMove = pos.toMove;
+        ctx.turnIndex = (int)pos.stones.size();
+
+        AIPlayer analyst(3);
+        auto start = std::chrono::steady_clock::now();
+        std::cout << pos.name << "\n";
+        analyst.analyze(ctx, board, rules, lineCount, budgetMs, StopToken(), [&](const AIPlayer::Analysis& a) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  depth " << a.depth << " (" << ms << " ms):";
+            for (const auto& line : a.lines) {
+                std::cout << "  " << cellName(line.move) << " "
+                          << (line.forced > 0 ? "win" : line.forced < 0 ? "loss" : std::to_string(line.score));
+            }
+            std::cout << "\n";
+        });
+    }
+    return 0;
+}
+
+// Fixed-depth suite under each rule variant. With a fixed depth the node counts
+// and moves are deterministic, so runs of different builds can be compared
+// exactly; nodes/s shows the per-node cost of each policy.
+static int runRulesBench(int depth) {
+    FreestyleRuleSet freestyle;
+    StandardRuleSet standard;
+    GomokuRuleSet renju;
+    const RuleSet* variants[] = {&freestyle, &standard, &renju};
+
+    for (const RuleSet* rules : variants) {
+        std::cout << rules->name() << "\n";
+        long long totalNodes = 0;
+        double totalSec = 0;
+        for (const auto& pos : tacticalSuite()) {
+            Board board;
+            for (const auto& s : pos.stones) board.set(s.second, s.first);
+            GameContext ctx;
+            ctx.toMove = pos.toMove;
+            ctx.turnIndex = (int)pos.stones.size();
+
+            AIPlayer ai = fixedDepthPlayer(depth);
+            auto t0 = std::chrono::steady_clock::now();
+            Action action = ai.getAction(ctx, board, *rules);
+            totalSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            totalNodes += ai.lastStats().nodes;
+            std::cout << "  " << std::left << std::setw(18) << pos.name << std::setw(6) << cellName(action.move)
+                      << ai.lastStats().nodes << "\n";
+        }
+        std::cout << "  total nodes " << totalNodes << ", " << (long long)(totalNodes / std::max(1e-9, totalSec)) << " nodes/s\n";
+    }
+    return 0;
+}
+
+// Fixed-depth suite with and without forced-reply generation. Positions
+// with a four or an open three on the board collapse to a few replies per
+// node; 'forced' counts the nodes where that happened.
+static int runForcedBench(int depth) {
+    GomokuRuleSet rules;
+    std::cout << std::left << std::setw(18) << "position" << std::setw(8) << "move" << std::setw(12) << "nodes off"
+              << std::setw(10) << "ms off" << std::setw(8) << "move" << std::setw(12) << "nodes on" << std::setw(10) << "ms on"
+              << "forced\n";
+    long long totals[2] = {0, 0};
+    double totalMs[2] = {0, 0};
+    for (const auto& pos : tacticalSuite()) {
+        Board board;
+        for (const auto& s : pos.stones) board.set(s.second, s.first);
+        GameContext ctx;
+        ctx.toMove = pos.toMove;
+        ctx.turnIndex = (int)pos.stones.size();
+
+        std::cout << std::setw(18) << pos.name;
+        for (int on = 0; on < 2; ++on) {
+            AIPlayer ai = fixedDepthPlayer(depth);
+            ai.setForcedReplies(on == 1);
+            auto t0 = std::chrono::steady_clock::now();
+            Action action = ai.getAction(ctx, board, rules);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            totals[on] += ai.lastStats().nodes;
+            totalMs[on] += ms;
+            std::cout << std::setw(8) << cellName(action.move) << std::setw(12) << ai.lastStats().nodes
+                      << std::setw(10) << (long long)ms;
+            if (on) std::cout << ai.lastStats().forcedNodes;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "total nodes " << totals[0] << " -> " << totals[1] << ", " << (long long)totalMs[0] << " ms -> "
+              << (long long)totalMs[1] << " ms\n";
+    return 0;
+}
+
+// Replays the first 10 plies of each archived game and searches every
+// position to a fixed depth with and without symmetry pruning
+static int runOpeningsBench(int depth, const std::string& dir) {
+    const int OPENING_PLIES = 10;
+    GomokuRuleSet rules;
+    long long ms[2] = {0, 0}, nodes[2] = {0, 0}, roots[2] = {0, 0};
+    int positions = 0, symmetric = 0, differing = 0, scoreChanged = 0;
+
+    std::vector<std::string> files;
+    if (std::filesystem::is_directory(dir)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+            if (entry.path().extension() == ".txt") files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        GameRecord record;
+        if (!readGameRecord(in, record)) continue;
+        Board board;
+        for (int ply = 0; ply < OPENING_PLIES && ply < (int)record.moves.size(); ++ply) {
+            const HistoryEntry& next = record.moves[ply];
+            if (next.type() != ActionType::Place) break;
+            if (ply > 0) {
+                GameContext ctx;
+                ctx.toMove = next.side();
+                ctx.turnIndex = ply;
+                Move found[2];
+                long long score[2], positionNodes[2];
+                for (int on = 0; on < 2; ++on) {
+                    AIPlayer ai = fixedDepthPlayer(depth);
+                    ai.setSymmetry(on == 1);
+                    auto t0 = std::chrono::steady_clock::now();
+                    found[on] = ai.getAction(ctx, board, rules).move;
+                    ms[on] += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+                    nodes[on] += ai.lastStats().nodes;
+                    score[on] = ai.lastStats().score;
+                    positionNodes[on] = ai.lastStats().nodes;
+                    roots[on] += ai.lastStats().rootMoves;
+                }
+                // With pruning the engine may pick a mirror image of the unpruned move
+                uint8_t syms = board.symmetries();
+                bool same = false;
+                for (int s = 0; s < 8; ++s) same |= (syms & (1 << s)) && Board::transform(found[1], s) == found[0];
+                positions++;
+                if (syms != 1) symmetric++;
+                if (!same) differing++;
+                if (score[0] != score[1]) scoreChanged++;
+                std::cout << std::left << std::setw(34) << std::filesystem::path(file).filename().string() << " ply "
+                          << std::setw(3) << ply << (syms != 1 ? "symmetric  " : "           ")
+                          << std::setw(12) << (cellName(found[0]) + " / " + cellName(found[1]))
+                          << positionNodes[0] << " -> " << positionNodes[1] << " nodes\n";
+            }
+            board.set(next.move, next.side());
+        }
+    }
+    if (positions == 0) {
+        std::cout << "No game records in " << dir << "\n";
+        return 1;
+    }
+    std::cout << positions << " positions (" << symmetric << " symmetric), depth " << depth << "\n";
+    std::cout << "pruning off: " << roots[0] << " root moves, " << nodes[0] << " nodes, " << ms[0] << " ms\n";
+    std::cout << "pruning on:  " << roots[1] << " root moves, " << nodes[1] << " nodes, " << ms[1] << " ms\n";
+    // A different move with the same root score is an equal-valued alternative picked by move order
+    std::cout << "non-equivalent moves: " << differing << ", different root scores: " << scoreChanged << "\n";
+    return 0;
+}
+
+// One Hard move on the midgame position, played through the rule set like a
+// game turn; needs a build with -DGOMOKU_TRACE
+static int runTraceBench(const std::string& path) {
+    if (!trace::enabled()) {
+        std::cout << "Tracing is compiled out; configure with -DGOMOKU_TRACE=ON\n";
+        return 1;
+    }
+    GomokuRuleSet rules;
+    const BenchPosition pos = tacticalSuite().back();
+    Board board;
+    for (const auto& s : pos.stones) board.set(s.second, s.first);
+    GameContext ctx;
+    ctx.toMove = pos.toMove;
+    ctx.turnIndex = (int)pos.stones.size();
+
+    trace::reset();
+    AIPlayer ai(3);
+    Action action = ai.getAction(ctx, board, rules);
+    std::string reason;
+    if (rules.validateAction(ctx, board, ctx.toMove, action, reason)) {
+        rules.applyAction(ctx, board, pos.toMove, action);
+        rules.evaluateAfterAction(ctx, board, pos.toMove, action);
+    }
+    std::cout << pos.name << ": " << cellName(action.move) << ", depth " << ai.lastStats().depth << ", "
+              << ai.lastStats().nodes << " nodes, " << ai.lastStats().elapsedMs << " ms\n";
+    trace::printSummary(std::cout);
+    if (!trace::writeChromeJson(path)) {
+        std::cout << "Failed to write " << path << "\n";
+        return 1;
+    }
+    std::cout << "trace written to " << path << "\n";
+    return 0;
+}
+
+// Pattern counts recomputed from scratch, to check SparseBoard's running totals
+static void recountSparseFeatures(const SparseBoard& board, Side mySide, int features[PAT_COUNT]) {
+    for (int k = 0; k < PAT_COUNT; ++k) features[k] = 0;
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (Cell m : board.stones()) {
+        Side side = board.get(m);
+        for (auto& d : dirs) {
+            int fwd = board.countConsecutive(m.pos(), d[0], d[1], side);
+            int bwd = board.countConsecutive(m.pos(), -d[0], -d[1], side);
+            bool open1 = board.isEmpty(Pos{m.r + (fwd + 1) * d[0], m.c + (fwd + 1) * d[1]});
+            bool open2 = board.isEmpty(Pos{m.r - (bwd + 1) * d[0], m.c - (bwd + 1) * d[1]});
+            int pattern = classifyRun(1 + fwd + bwd, open1, open2);
+            if (pattern >= 0) features[pattern] += (side == mySide) ? 1 : -1;
+        }
+    }
+}
+
+// Would side's stone at m share an unblocked window of 5 with another of its
+// stones? Random games that avoid this stay quiet (no twos, so no forced wins)
+// however long they get, and each checkpoint is a full-depth search.
+static bool makesThreat(const SparseBoard& board, Cell m, Side side) {
+    static const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        for (int start = -4; start <= 0; ++start) {
+            int own = 1;
+            bool blocked = false;
+            for (int i = start; i < start + 5 && !blocked; ++i) {
+                if (i == 0) continue;
+                Side s = board.get(Pos{m.r + i * d[0], m.c + i * d[1]});
+                if (s == side) own++;
+                else if (s != Side::None) blocked = true;
+            }
+            if (!blocked && own >= 2) return true;
+        }
+    }
+    return false;
+}
+
+// Grows a quiet random game on the infinite board and, at checkpoints, times
+// an AI move and the board operations it is built on
+static int runSparseBench(int stones, int depth) {
+    std::mt19937 rng(2024);
+    SparseBoard board;
+    std::vector<Cell> candidates;
+    std::vector<int> checkpoints;
+    for (int n = 50; n < stones; n *= 2) checkpoints.push_back(n);
+    checkpoints.push_back(stones);
+
+    std::cout << std::left << std::setw(8) << "stones" << std::setw(12) << "bbox" << std::setw(12) << "candidates"
+              << std::setw(12) << "memory" << std::setw(14) << "set+clear ns" << std::setw(14) << "movegen us"
+              << std::setw(10) << "move" << std::setw(8) << "depth" << std::setw(10) << "nodes" << std::setw(8) << "ms" << "score\n";
+    Side toMove = Side::Black;
+    bool consistent = true;
+    for (int checkpoint : checkpoints) {
+        while (board.stoneCount() < checkpoint) {
+            board.candidates(candidates);
+            Cell m;
+            for (int tries = 0; tries < 256 && m.isNone(); ++tries) {
+                Cell c = candidates[rng() % candidates.size()];
+                if (!makesThreat(board, c, toMove)) m = c;
+            }
+            if (m.isNone()) break;
+            board.set(m, toMove);
+            toMove = (toMove == Side::Black) ? Side::White : Side::Black;
+        }
+
+        int incremental[PAT_COUNT], recounted[PAT_COUNT];
+        board.features(toMove, incremental);
+        recountSparseFeatures(board, toMove, recounted);
+        consistent = consistent && std::equal(incremental, incremental + PAT_COUNT, recounted);
+
+        // Place and remove each candidate once: the per-move cost inside the search
+        board.candidates(candidates);
+        auto t0 = std::chrono::steady_clock::now();
+        for (Cell c : candidates) {
+            board.set(c, toMove);
+            board.clear(c);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        // Move generation as the search sees it: the best-ordered 20 candidates
+        const int GEN_ROUNDS = 100;
+        std::vector<Cell> ordered;
+        std::vector<int> keys;
+        for (int i = 0; i < GEN_ROUNDS; ++i) board.orderedCandidates(toMove, 20, ordered, keys);
+        auto t2 = std::chrono::steady_clock::now();
+        double setNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / candidates.size();
+        double genUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / GEN_ROUNDS;
+
+        AIPlayer ai = fixedDepthPlayer(depth);
+        Cell move = ai.getSparseMove(board, toMove);
+        const auto& st = ai.lastStats();
+
+        SparseBoard::Box box = board.bounds();
+        std::ostringstream bbox, where;
+        bbox << (box.maxR - box.minR + 1) << "x" << (box.maxC - box.minC + 1);
+        where << move.r << "," << move.c;
+        std::cout << std::setw(8) << board.stoneCount() << std::setw(12) << bbox.str() << std::setw(12) << candidates.size()
+                  << std::setw(12) << (std::to_string(board.memoryBytes() / 1024) + " KB") << std::setw(14) << (long long)setNs
+                  << std::setw(14) << (long long)genUs << std::setw(10) << where.str() << std::setw(8) << st.depth
+                  << std::setw(10) << st.nodes << std::setw(8) << st.elapsedMs << st.score << "\n";
+    }
+    std::cout << "incremental pattern counts match a full recount: " << (consistent ? "yes" : "NO") << "\n";
+    return consistent ? 0 : 1;
+}
+
+#ifndef _WIN32
+// Publishes moves into a feed served to n local socket spectators and
+// measures the game-side publish call and the time until the last spectator
+// has read each move
+static int runSpectateBench(const std::vector<int>& counts) {
+    const int MOVES = 400;
+    const std::string path = "/tmp/gomoku_spectate_bench.sock";
+    std::cout << std::left << std::setw(12) << "spectators" << std::setw(16) << "publish (us)"
+              << std::setw(22) << "delivery p50 (us)" << std::setw(22) << "delivery p99 (us)" << "skipped\n";
+    for (int n : counts) {
+        SpectatorFeed feed;
+        SpectatorServer server(feed, path);
+        if (!server.start()) {
+            std::cout << "Failed to listen on " << path << "\n";
+            return 1;
+        }
+        Board board;
+        GameContext ctx;
+        feed.publishBoard(ctx, board);
+
+        std::vector<int> fds;
+        for (int i = 0; i < n; ++i) {
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                std::cout << "connect failed after " << i << " spectators\n";
+                return 1;
+            }
+            fds.push_back(fd);
+        }
+        // Reader thread: all spectator sockets, one line buffer each; a move
+        // counts as delivered when the last spectator has read its line
+        using Clock = std::chrono::steady_clock;
+        std::vector<Clock::time_point> published(MOVES + 1), delivered(MOVES + 1);
+        std::vector<int> receipts(MOVES + 1, 0);
+        std::atomic<int> complete{0}, synced{0};
+        std::thread reader([&]() {
+            std::vector<std::string> partial(n);
+            std::vector<pollfd> pfds;
+            for (int fd : fds) pfds.push_back({fd, POLLIN, 0});
+            char buf[65536];
+            while (complete < MOVES) {
+                if (poll(pfds.data(), pfds.size(), 200) <= 0) continue;
+                for (int i = 0; i < n; ++i) {
+                    if (!(pfds[i].revents & POLLIN)) continue;
+                    ssize_t got = recv(fds[i], buf, sizeof(buf), 0);
+                    if (got <= 0) continue;
+                    partial[i].append(buf, got);
+                    size_t start = 0, nl;
+                    while ((nl = partial[i].find('\n', start)) != std::string::npos) {
+                        if (partial[i].compare(start, 6, "BOARD ") == 0) synced++;
+                        if (partial[i].compare(start, 5, "MOVE ") == 0) {
+                            int seq = std::atoi(partial[i].c_str() + start + 5);
+                            if (seq >= 1 && seq <= MOVES && ++receipts[seq] == n) {
+                                delivered[seq] = Clock::now();
+                                complete++;
+                            }
+                        }
+                        start = nl + 1;
+                    }
+                    partial[i].erase(0, start);
+                }
+            }
+        });
+
+        // Spectators that join start from the latest BOARD frame: wait for all of them before the first move
+        while (synced < n) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        double publishUs = 0;
+        Side side = Side::Black;
+        for (int i = 1; i <= MOVES; ++i) {
+            Move m = Move::fromIndex((i * 37) % (Board::SIZE * Board::SIZE));
+            board.set(m, side);
+            ctx.history.push_back(HistoryEntry(side, Action{ActionType::Place, m, 100}));
+            side = (side == Side::Black) ? Side::White : Side::Black;
+            ctx.toMove = side;
+            published[i] = Clock::now();
+            feed.publishMove(ctx, board, ctx.history.back());
+            publishUs += std::chrono::duration<double, std::micro>(Clock::now() - published[i]).count();
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        auto deadline = Clock::now() + std::chrono::seconds(10);
+        while (complete < MOVES && Clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (complete < MOVES) {
+            std::cout << n << " spectators: only " << complete << "/" << MOVES << " moves delivered\n";
+            complete = MOVES;
+            reader.join();
+            for (int fd : fds) close(fd);
+            return 1;
+        }
+        reader.join();
+
+        std::vector<double> latency;
+        for (int i = 1; i <= MOVES; ++i) latency.push_back(std::chrono::duration<double, std::micro>(delivered[i] - published[i]).count());
+        std::sort(latency.begin(), latency.end());
+        std::cout << std::setw(12) << n << std::setw(16) << std::fixed << std::setprecision(2) << publishUs / MOVES
+                  << std::setw(22) << std::setprecision(1) << latency[MOVES / 2] << std::setw(22) << latency[MOVES * 99 / 100]
+                  << server.framesSkipped() << "\n";
+        for (int fd : fds) close(fd);
+        server.stop();
+    }
+    return 0;
+}
+#endif
+
+// Plays a random legal game through a journaled session at a steady pace,
+// then recovers it from the file. The game-side cost of each journal call is
+// timed next to the submit it records.
+static int runJournalBench(const std::string& path, int moves) {
+    using Clock = std::chrono::steady_clock;
+    auto rules = std::make_shared<GomokuRuleSet>();
+    std::mt19937 rng(7);
+
+    // The game: random empty points, as long as the rules accept them and nobody has won
+    std::vector<Action> actions;
+    {
+        GameSession game(rules);
+        while ((int)actions.size() < moves && !game.finished()) {
+            Action action{ActionType::Place, Move::fromIndex((int)(rng() % (Board::SIZE * Board::SIZE))), 500};
+            if (game.submit(action).applied) actions.push_back(action);
+        }
+    }
+
+    GameSession game(rules);
+    double submitNs = 0, journalNs = 0;
+    MoveJournal::Stats stats;
+    {
+        MoveJournal journal(path, 200);
+        journal.begin(0, 3, game.getContext());
+        for (const auto& action : actions) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            Side side = game.getContext().toMove;
+            auto t0 = Clock::now();
+            game.submit(action);
+            auto t1 = Clock::now();
+            journal.action(side, action, 1, game.getContext());
+            auto t2 = Clock::now();
+            submitNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            journalNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        }
+        journal.end(game.getContext());
+        journal.sync();
+        stats = journal.stats();
+    }
+
+    std::vector<MoveJournal::Record> records;
+    GameSession restored(rules);
+    auto r0 = Clock::now();
+    bool ok = MoveJournal::load(path, records) && MoveJournal::replay(records, restored);
+    double recoverUs = std::chrono::duration<double, std::micro>(Clock::now() - r0).count();
+    ok = ok && restored.getContext().history.size() == game.getContext().history.size();
+    for (int i = 0; ok && i < Board::SIZE * Board::SIZE; ++i) {
+        ok = restored.getBoard().get(Move::fromIndex(i)) == game.getBoard().get(Move::fromIndex(i));
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << actions.size() << " actions, one every 5 ms, " << stats.records << " records\n";
+    std::cout << "submit             " << submitNs / actions.size() << " ns/action\n";
+    std::cout << "journal            " << journalNs / actions.size() << " ns/action (game thread)\n";
+    std::cout << "background         " << stats.writes << " writes, " << stats.syncs << " fsyncs, "
+              << (stats.syncs ? (double)stats.syncMicros / stats.syncs : 0.0) << " us/fsync\n";
+    std::cout << "recovery           " << recoverUs << " us for " << records.size() << " records ("
+              << (ok ? "board and history match" : "MISMATCH") << ")\n";
+    return ok ? 0 : 1;
+}
+
+// Heap allocations of fixed-depth searches of each suite position. The
+// first search on a thread sets up the search buffers; every later one, by
+// the same player or a new one, must reuse them and allocate nothing.
+static int runAllocBench(int depth) {
+    GomokuRuleSet rules;
+    std::cout << std::left << std::setw(18) << "position" << std::setw(12) << "nodes" << std::setw(14) << "allocs warm"
+              << std::setw(14) << "allocs again" << "allocs new player\n";
+    bool clean = true;
+    for (const auto& pos : tacticalSuite()) {
+        Board board;
+        for (const auto& s : pos.stones) board.set(s.second, s.first);
+        GameContext ctx;
+        ctx.toMove = pos.toMove;
+        ctx.turnIndex = (int)pos.stones.size();
+
+        // Warm-up, the same player again, then a fresh player on the same thread
+        AIPlayer ai = fixedDepthPlayer(depth);
+        AIPlayer fresh = fixedDepthPlayer(depth);
+        AIPlayer* searches[] = {&ai, &ai, &fresh};
+        long long allocs[3];
+        for (int i = 0; i < 3; ++i) {
+            long long before = heapAllocations.load();
+            searches[i]->getAction(ctx, board, rules);
+            allocs[i] = heapAllocations.load() - before;
+        }
+        if (allocs[1] != 0 || allocs[2] != 0) clean = false;
+        std::cout << std::setw(18) << pos.name << std::setw(12) << ai.lastStats().nodes << std::setw(14) << allocs[0]
+                  << std::setw(14) << allocs[1] << allocs[2] << "\n";
+    }
+    std::cout << (clean ? "no allocations after warm-up\n" : "FAIL: a search allocates after warm-up\n");
+    return clean ? 0 : 1;
+}
+
+// Elo difference for a mean score, clamped to +-800
+static double eloFromScore(double score) {
+    score = std::clamp(score, 1 / 101.0, 100 / 101.0);
+    return -400 * std::log10(1 / score - 1);
+}
+
+// The difficulty levels as played: nodes and time of the suite per level up
+// to topLevel, run once idle and once next to busy threads (the moves must
+// not change), then game pairs between adjacent levels with the Elo
+// difference they imply. The games of a pair share an opening, so the 95%
+// interval comes from the spread of the pair scores. Openings are not
+// repeated, because the levels play the same game from the same opening.
+static int runLevelsBench(int pairs, int topLevel) {
+    static const char* LEVEL_NAMES[] = {"", "Easy", "Medium", "Hard"};
+    GomokuRuleSet rules;
+    bool deterministic = true;
+    std::cout << std::left << std::setw(8) << "level" << std::setw(12) << "nodes" << std::setw(10) << "ms idle"
+              << std::setw(10) << "ms loaded" << "same moves\n";
+    for (int level = 1; level <= topLevel; ++level) {
+        long long totalNodes = 0;
+        double totalMs[2] = {0, 0};
+        std::vector<Move> moves[2];
+        for (int loaded = 0; loaded < 2; ++loaded) {
+            // One spinning thread per core competes with the search for the CPU
+            std::atomic<bool> spin{loaded == 1};
+            std::vector<std::thread> load;
+            if (loaded) {
+                for (unsigned t = 0; t < std::max(1u, std::thread::hardware_concurrency()); ++t) {
+                    load.emplace_back([&spin]() { while (spin.load(std::memory_order_relaxed)) {} });
+                }
+            }
+            for (const auto& pos : tacticalSuite()) {
+                Board board;
+                for (const auto& st : pos.stones) board.set(st.second, st.first);
+                GameContext ctx;
+                ctx.toMove = pos.toMove;
+                ctx.turnIndex = (int)pos.stones.size();
+
+                AIPlayer ai(level);
+                auto t0 = std::chrono::steady_clock::now();
+                moves[loaded].push_back(ai.getAction(ctx, board, rules).move);
+                totalMs[loaded] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                if (!loaded) totalNodes += ai.lastStats().nodes;
+            }
+            spin = false;
+            for (auto& t : load) t.join();
+        }
+        bool same = moves[0] == moves[1];
+        deterministic = deterministic && same;
+        std::cout << std::setw(8) << LEVEL_NAMES[level] << std::setw(12) << totalNodes << std::setw(10) << (long long)totalMs[0]
+                  << std::setw(10) << (long long)totalMs[1] << (same ? "yes" : "no") << "\n";
+    }
+
+    std::mt19937 rng(2024);
+    for (int level = 1; level < topLevel; ++level) {
+        int wins = 0, losses = 0, draws = 0;    // For the stronger level
+        std::vector<double> pairScores;
+        std::vector<std::vector<Pos>> used;
+        for (int i = 0; i < pairs; ++i) {
+            std::vector<Pos> opening = randomOpening(rng);
+            for (int tries = 0; tries < 1000 && std::find(used.begin(), used.end(), opening) != used.end(); ++tries) {
+                opening = randomOpening(rng);
+            }
+            if (std::find(used.begin(), used.end(), opening) != used.end()) break;  // Every opening played
+            used.push_back(opening);
+            double pairScore = 0;
+            for (int swap = 0; swap < 2; ++swap) {
+                AIPlayer weaker(level), stronger(level + 1);
+                bool strongerIsBlack = (swap == 0);
+                Side winner = strongerIsBlack ? playGame(stronger, weaker, opening) : playGame(weaker, stronger, opening);
+                Side strongerSide = strongerIsBlack ? Side::Black : Side::White;
+                if (winner == Side::None) draws++;
+                else if (winner == strongerSide) wins++;
+                else losses++;
+                pairScore += (winner == Side::None) ? 0.25 : (winner == strongerSide) ? 0.5 : 0;
+            }
+            pairScores.push_back(pairScore);
+        }
+        double n = std::max<size_t>(1, pairScores.size()), mean = 0, var = 0;
+        for (double x : pairScores) mean += x / n;
+        for (double x : pairScores) var += (x - mean) * (x - mean) / std::max(1.0, n - 1);
+        double margin = 1.96 * std::sqrt(var / n);
+        std::cout << LEVEL_NAMES[level + 1] << " vs " << LEVEL_NAMES[level] << ": +" << wins << " -" << losses << " =" << draws
+                  << " in " << pairScores.size() << " pairs, score " << std::fixed << std::setprecision(3) << mean
+                  << std::setprecision(0) << ", Elo difference " << std::showpos << eloFromScore(mean) << " (95% "
+                  << eloFromScore(mean - margin) << " to " << eloFromScore(mean + margin) << ")\n" << std::noshowpos;
+    }
+    return deterministic ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "selfplay") {
+        int pairs = (argc > 2) ? std::stoi(argv[2]) : 10;
+        int moveMs = (argc > 3) ? std::stoi(argv[3]) : 200;
+        return runSelfPlay(pairs, moveMs);
+    }
+    if (argc > 1 && std::string(argv[1]) == "mcts") {
+        int moveMs = (argc > 2) ? std::stoi(argv[2]) : 1000;
+        std::vector<int> threadCounts;
+        for (int i = 3; i < argc; ++i) threadCounts.push_back(std::stoi(argv[i]));
+        if (threadCounts.empty()) threadCounts = {1, 2, 4};
+        return runMctsBench(moveMs, threadCounts);
+    }
+    if (argc > 1 && std::string(argv[1]) == "eval") {
+        return runEvalBench((argc > 2) ? std::stoi(argv[2]) : 200000);
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "hint") {
+        return runHintBench((argc > 2) ? std::stoi(argv[2]) : 5000, (argc > 3) ? std::stoi(argv[3]) : 3);
+    }
+#ifndef _WIN32
+    if (argc > 1 && std::string(argv[1]) == "spectate") {
+        std::vector<int> counts;
+        for (int i = 2; i < argc; ++i) counts.push_back(std::stoi(argv[i]));
+        if (counts.empty()) counts = {1, 10, 100, 400};
+        return runSpectateBench(counts);
+    }
+#endif
+    if (argc > 1 && std::string(argv[1]) == "sparse") {
+        return runSparseBench((argc > 2) ? std::stoi(argv[2]) : 600, (argc > 3) ? std::stoi(argv[3]) : 4);
+    }
+    if (argc > 1 && std::string(argv[1]) == "forced") {
+        return runForcedBench((argc > 2) ? std::stoi(argv[2]) : 4);
+    }
+    if (argc > 1 && std::string(argv[1]) == "journal") {
+        return runJournalBench((argc > 2) ? argv[2] : "/tmp/gomoku_bench.journal", (argc > 3) ? std::stoi(argv[3]) : 200);
+    }
+    if (argc > 1 && std::string(argv[1]) == "levels") {
+        return runLevelsBench((argc > 2) ? std::stoi(argv[2]) : 10, (argc > 3) ? std::clamp(std::stoi(argv[3]), 1, 3) : 3);
+    }
+    if (argc > 1 && std::string(argv[1]) == "alloc") {
+        return runAllocBench((argc > 2) ? std::stoi(argv[2]) : 4);
+    }
+    if (argc > 1 && std::string(argv[1]) == "trace") {
+        return runTraceBench((argc > 2) ? argv[2] : "gomoku_trace.json");
+    }
+    if (argc > 1 && std::string(argv[1]) == "openings") {
+        return runOpeningsBench((argc > 2) ? std::stoi(argv[2]) : 4, (argc > 3) ? argv[3] : "../match");
+    }
+    if (argc > 1 && std::string(argv[1]) == "rules") {
+        return runRulesBench((argc > 2) ? std::stoi(argv[2]) : 4);
+    }
+    if (argc > 1 && std::string(argv[1]) == "stop") {
+        return runStopBench((argc > 2) ? std::stoi(argv[2]) : 300);
+    }
+    if (argc > 2 && std::string(argv[1]) == "cache") {
+        return runCacheBench(argv[2], (argc > 3) ? std::stoi(argv[3]) : 2);
+    }
+
+    runSuite((argc > 1) ? std::stoi(argv[1]) : 3);
+    return 0;
+}
@@ -0,0 +1,265 @@
+// Self-play training data generator.
+//
+//   gomoku_datagen [-o file] [-n positions] [-t threads] [-N nodes] [-r plies] [-s seed] [-R renju|standard|freestyle]
+//
+// Every worker plays AIPlayer against itself from randomised openings (Tengen
+// plus 2..r random plies next to the stones) with a fixed node budget per
+// move, so the data does not depend on machine speed or load. Each searched
+// position becomes one record: the position, the search score and the final
+// result, both for the side to move. Positions are deduplicated across
+// workers by canonical hash (mirror images count once) and side to move;
+// positions with a forced win or loss score are skipped.
+//
+// Workers collect records in their own 1 MiB buffer and append it to the file
+// in one write when it fills, so the file is written in large sequential
+// chunks and workers rarely contend.
+//
+// File format, little-endian: a 16-byte header ("GMKDATA1", uint32 record
+// size = 64, uint32 rule variant), then 64-byte records:
+//   bytes 0-56   225 cells, 2 bits each (0 empty, 1 Black, 2 White); cell i is
+//                bits 2 * (i % 4) of byte i / 4, i = row * 15 + col
+//   byte  57     side to move (0 Black, 1 White)
+//   byte  58     stones on the board
+//   byte  59     result for the side to move (0 loss, 1 draw, 2 win)
+//   bytes 60-63  search score for the side to move (int32, evaluateBoard units)
+#include "../include/AIPlayer.h"
+#include "../include/GomokuRuleSet.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+static const size_t RECORD_BYTES = 64;
+static const size_t CELL_BYTES = (Board::SIZE * Board::SIZE + 3) / 4;
+static_assert(CELL_BYTES + 7 == RECORD_BYTES, "record layout");
+static const size_t FLUSH_BYTES = 1 << 20;
+static const long long FORCED_SCORE = 1000000000000LL - 100;   // AIPlayer's win score, less the ply margin
+
+// Position hashes seen by any worker, sharded so workers rarely share a lock
+class SeenPositions {
+public:
+    bool insert(uint64_t key) {
+        Shard& shard = shards[key % SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.keys.insert(key).second;
+    }
+
+private:
+    static const int SHARDS = 64;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<uint64_t> keys;
+    };
+    Shard shards[SHARDS];
+};
+
+struct Generator {
+    const RuleSet* rules;
+    long long target;
+    long long nodes;
+    int maxRandomPlies;
+    uint64_t seed;
+
+    std::ofstream out;
+    std::mutex outMutex;
+    SeenPositions seen;
+    std::atomic<long long> written{0};
+    std::atomic<long long> games{0};
+    std::atomic<long long> duplicates{0};
+
+    void flush(std::vector<uint8_t>& buffer) {
+        if (buffer.empty()) return;
+        std::lock_guard<std::mutex> lock(outMutex);
+        out.write(reinterpret_cast<const char*>(buffer.data()), (std::streamsize)buffer.size());
+        buffer.clear();
+    }
+};
+
+static void encodePosition(const Board& board, Side toMove, long long score, uint8_t* record) {
+    std::memset(record, 0, RECORD_BYTES);
+    int stones = 0;
+    for (int i = 0; i < Board::SIZE * Board::SIZE; ++i) {
+        Side s = board.get(Move::fromIndex(i));
+        if (s == Side::None) continue;
+        record[i / 4] |= (uint8_t)((s == Side::Black ? 1 : 2) << (2 * (i % 4)));
+        stones++;
+    }
+    record[CELL_BYTES] = (toMove == Side::White) ? 1 : 0;
+    record[CELL_BYTES + 1] = (uint8_t)stones;
+    uint32_t v = (uint32_t)(int32_t)std::clamp<long long>(score, INT32_MIN, INT32_MAX);
+    for (int b = 0; b < 4; ++b) record[CELL_BYTES + 3 + b] = (uint8_t)(v >> (8 * b));
+}
+
+// Validates and plays one action; false if the rules reject it
+static bool play(const RuleSet& rules, GameContext& ctx, Board& board, const Action& action, Outcome& outcome) {
+    std::string reason;
+    Side mover = ctx.toMove;
+    if (!rules.validateAction(ctx, board, mover, action, reason)) return false;
+    rules.applyAction(ctx, board, mover, action);
+    ctx.history.push_back(HistoryEntry(mover, action));
+    outcome = rules.evaluateAfterAction(ctx, board, mover, action);
+    return true;
+}
+
+// Tengen plus a random number of random plies, none of which ends the game
+static bool randomOpening(const RuleSet& rules, GameContext& ctx, Board& board, std::mt19937_64& rng, int maxPlies) {
+    rules.initGame(ctx, board);
+    int plies = 2 + (int)(rng() % (uint64_t)std::max(1, maxPlies - 1));
+    for (int i = 0; i < plies; ++i) {
+        std::vector<Move> moves = getCandidates(board);
+        bool placed = false;
+        for (int tries = 0; tries < 16 && !placed && !moves.empty(); ++tries) {
+            GameContext nextCtx = ctx;
+            Board next = board;
+            Outcome outcome;
+            Action action{ActionType::Place, moves[rng() % moves.size()], 0};
+            if (!play(rules, nextCtx, next, action, outcome) || outcome.status != GameStatus::Ongoing) continue;
+            ctx = std::move(nextCtx);
+            board = next;
+            placed = true;
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+static void worker(Generator& gen, int index) {
+    std::mt19937_64 rng(gen.seed * 0x9E3779B97F4A7C15ULL + (uint64_t)index);
+    std::vector<uint8_t> buffer;
+    buffer.reserve(FLUSH_BYTES);
+    std::vector<uint8_t> game;      // This game's records until the result is known
+    std::vector<Side> movers;
+
+    AIPlayer ai(3);
+    ai.setNodeLimit(gen.nodes);
+    ai.setTimeLimitMs(600000);      // The node budget decides, not the clock
+
+    while (gen.written.load() < gen.target) {
+        GameContext ctx;
+        Board board;
+        if (!randomOpening(*gen.rules, ctx, board, rng, gen.maxRandomPlies)) continue;
+
+        game.clear();
+        movers.clear();
+        Outcome outcome;
+        while (true) {
+            Side mover = ctx.toMove;
+            Action action = ai.getAction(ctx, board, *gen.rules);
+            long long score = ai.lastStats().score;
+            if (ai.lastStats().depth > 0 && std::llabs(score) < FORCED_SCORE) {
+                uint64_t key = board.canonicalHash() ^ (mover == Side::White ? 0xF0E1D2C3B4A59687ULL : 0);
+                if (gen.seen.insert(key)) {
+                    game.resize(game.size() + RECORD_BYTES);
+                    encodePosition(board, mover, score, &game[game.size() - RECORD_BYTES]);
+                    movers.push_back(mover);
+                } else {
+                    gen.duplicates++;
+                }
+            }
+            if (!play(*gen.rules, ctx, board, action, outcome)) {
+                // An illegal move loses, as in a real game
+                outcome.status = GameStatus::Win;
+                outcome.winner = (mover == Side::Black) ? Side::White : Side::Black;
+            }
+            if (outcome.status == GameStatus::PendingClaim) {
+                outcome.status = GameStatus::Win;   // White always claims
+                outcome.winner = Side::White;
+            }
+            if (outcome.status != GameStatus::Ongoing) break;
+        }
+        gen.games++;
+
+        for (size_t i = 0; i < movers.size(); ++i) {
+            uint8_t result = 1;
+            if (outcome.status == GameStatus::Win) result = (*outcome.winner == movers[i]) ? 2 : 0;
+            game[i * RECORD_BYTES + CELL_BYTES + 2] = result;
+        }
+        // Claim a slice of the target so the file ends with exactly that many records
+        long long start = gen.written.fetch_add((long long)movers.size());
+        long long take = std::clamp<long long>(gen.target - start, 0, (long long)movers.size());
+        buffer.insert(buffer.end(), game.begin(), game.begin() + take * RECORD_BYTES);
+        if (buffer.size() >= FLUSH_BYTES) gen.flush(buffer);
+    }
+    gen.flush(buffer);
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = "selfplay.bin";
+    std::string ruleName = "renju";
+    long long target = 100000;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    long long nodes = 20000;
+    int maxRandomPlies = 8;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) break;
+        if (arg == "-o") outPath = argv[++i];
+        else if (arg == "-n") target = std::stoll(argv[++i]);
+        else if (arg == "-t") threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-N") nodes = std::max(1LL, std::stoll(argv[++i]));
+        else if (arg == "-r") maxRandomPlies = std::max(2, std::stoi(argv[++i]));
+        else if (arg == "-s") seed = std::stoull(argv[++i]);
+        else if (arg == "-R") ruleName = argv[++i];
+    }
+
+    std::unique_ptr<RuleSet> rules;
+    if (ruleName == "freestyle") rules = std::make_unique<FreestyleRuleSet>();
+    else if (ruleName == "standard") rules = std::make_unique<StandardRuleSet>();
+    else rules = std::make_unique<GomokuRuleSet>();
+
+    Generator gen;
+    gen.rules = rules.get();
+    gen.target = target;
+    gen.nodes = nodes;
+    gen.maxRandomPlies = maxRandomPlies;
+    gen.seed = seed;
+    gen.out.open(outPath, std::ios::binary | std::ios::trunc);
+    if (!gen.out.is_open()) {
+        std::cout << "Failed to open " << outPath << "\n";
+        return 1;
+    }
+    uint8_t header[16] = {'G', 'M', 'K', 'D', 'A', 'T', 'A', '1', (uint8_t)RECORD_BYTES, 0, 0, 0, (uint8_t)rules->variant(), 0, 0, 0};
+    gen.out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    std::cout << rules->name() << ", " << threads << " threads, " << nodes << " nodes/move, target " << target << " positions\n";
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(worker, std::ref(gen), t);
+
+    auto report = [&](long long positions) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = positions / std::max(secs, 1e-9);
+        std::cout << std::fixed << std::setprecision(1) << positions << " positions, " << gen.games.load() << " games, "
+                  << gen.duplicates.load() << " duplicates skipped, " << rate << " pos/s (" << rate / threads << " per core)" << std::endl;
+    };
+    auto lastReport = start;
+    while (gen.written.load() < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(5)) {
+            lastReport = std::chrono::steady_clock::now();
+            report(std::min(gen.written.load(), target));
+        }
+    }
+    for (auto& w : workers) w.join();
+    report(target);
+
+    gen.out.close();
+    if (!gen.out) {
+        std::cout << "Failed to write " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << target << " records (" << (16 + target * RECORD_BYTES) / 1024 << " KiB) to " << outPath << "\n";
+    return 0;
+}
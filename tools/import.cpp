@@ -0,0 +1,208 @@
+// Game database importer.
+//
+//   gomoku_import [-o games.txt] [-t threads] [-R renju|standard|freestyle] [-f record|psq|renlib|moves] <file or directory>...
+//
+// Reads Piskvork/Gomocup .psq files, RenLib .lib trees, plain move lists and
+// our own match/ records (formats in include/GameImport.h; detected per file
+// unless -f is given), replays every game through the rule set and appends
+// the accepted ones to the output as match/ records, which gomoku_tune and
+// the Replay menu read. Directories are searched recursively.
+//
+// Each worker takes the next file, largest first, and streams it one game at
+// a time, so memory stays flat whatever the input size. Records collect in
+// the worker's own 1 MiB buffer and are appended to the output in one write
+// when it fills. Games per second and input MB/s are reported as it runs;
+// rejected games are counted by reason.
+#include "../include/GameImport.h"
+#include "../include/GomokuRuleSet.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct InputFile {
+    std::string path;
+    uint64_t size;
+};
+
+struct Import {
+    std::shared_ptr<const RuleSet> rules;
+    bool forceFormat = false;
+    ImportFormat format = ImportFormat::MoveList;
+    std::vector<InputFile> files;
+
+    std::atomic<size_t> nextFile{0};
+    std::atomic<long long> games{0};
+    std::atomic<long long> accepted{0};
+    std::atomic<uint64_t> bytes{0};
+
+    std::mutex mutex;               // Guards everything below
+    std::ofstream out;
+    std::map<std::string, long long> rejected;
+    std::map<std::string, long long> perFormat;
+    std::vector<std::string> errors;
+};
+
+static const size_t FLUSH_BYTES = 1 << 20;
+
+static void flush(Import& imp, std::ostringstream& chunk) {
+    std::lock_guard<std::mutex> lock(imp.mutex);
+    imp.out << chunk.str();
+    chunk.str(std::string());
+}
+
+static void worker(Import& imp) {
+    GameSession session(imp.rules);
+    ImportedGame game;
+    std::ostringstream chunk;
+    std::map<std::string, long long> rejected, perFormat;
+    std::string reason;
+
+    for (size_t i = imp.nextFile++; i < imp.files.size(); i = imp.nextFile++) {
+        const std::string& path = imp.files[i].path;
+        ImportFormat format = imp.forceFormat ? imp.format : GameReader::detect(path);
+        std::unique_ptr<GameReader> reader = GameReader::open(path, format);
+        uint64_t counted = 0;
+        long long fileGames = 0;
+        while (reader->next(game)) {
+            fileGames++;
+            if (validateImportedGame(session, game, reason)) {
+                if (game.record.black.empty()) game.record.black = "Unknown";
+                if (game.record.white.empty()) game.record.white = "Unknown";
+                writeGameRecord(chunk, game.record, session.getBoard());
+                chunk << "\n";
+                imp.accepted++;
+                if ((size_t)chunk.tellp() >= FLUSH_BYTES) flush(imp, chunk);
+            } else {
+                rejected[reason]++;
+            }
+            imp.games++;
+            imp.bytes += reader->bytesRead() - counted;
+            counted = reader->bytesRead();
+        }
+        imp.bytes += reader->bytesRead() - counted;
+        perFormat[importFormatName(format)] += fileGames;
+        if (!reader->error().empty()) {
+            std::lock_guard<std::mutex> lock(imp.mutex);
+            imp.errors.push_back(path + ": " + reader->error());
+        }
+    }
+    if (chunk.tellp() > 0) flush(imp, chunk);
+
+    std::lock_guard<std::mutex> lock(imp.mutex);
+    for (const auto& r : rejected) imp.rejected[r.first] += r.second;
+    for (const auto& f : perFormat) imp.perFormat[f.first] += f.second;
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = "imported_games.txt";
+    std::string ruleName = "renju";
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    Import imp;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.size() > 1 && arg[0] == '-' && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "-o") outPath = value;
+            else if (arg == "-t") threads = std::max(1, std::stoi(value));
+            else if (arg == "-R") ruleName = value;
+            else if (arg == "-f") {
+                imp.forceFormat = true;
+                if (value == "record") imp.format = ImportFormat::Record;
+                else if (value == "psq") imp.format = ImportFormat::Psq;
+                else if (value == "renlib") imp.format = ImportFormat::RenLib;
+                else imp.format = ImportFormat::MoveList;
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cout << "Usage: gomoku_import [-o games.txt] [-t threads] [-R renju|standard|freestyle] "
+                     "[-f record|psq|renlib|moves] <file or directory>...\n";
+        return 1;
+    }
+
+    if (ruleName == "freestyle") imp.rules = std::make_shared<FreestyleRuleSet>();
+    else if (ruleName == "standard") imp.rules = std::make_shared<StandardRuleSet>();
+    else imp.rules = std::make_shared<GomokuRuleSet>();
+
+    std::error_code ec;
+    uint64_t totalBytes = 0;
+    for (const auto& input : inputs) {
+        if (fs::is_directory(input, ec)) {
+            for (auto it = fs::recursive_directory_iterator(input, ec); it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (it->is_regular_file(ec)) imp.files.push_back({it->path().string(), (uint64_t)it->file_size(ec)});
+            }
+        } else if (fs::is_regular_file(input, ec)) {
+            imp.files.push_back({input, (uint64_t)fs::file_size(input, ec)});
+        } else {
+            std::cout << "Skipping " << input << ": not a file or directory\n";
+        }
+    }
+    // Largest first, so no worker is left with a big file at the end
+    std::sort(imp.files.begin(), imp.files.end(), [](const InputFile& a, const InputFile& b) { return a.size > b.size; });
+    for (const auto& f : imp.files) totalBytes += f.size;
+
+    imp.out.open(outPath, std::ios::binary | std::ios::trunc);
+    if (!imp.out.is_open()) {
+        std::cout << "Failed to open " << outPath << "\n";
+        return 1;
+    }
+    threads = std::max(1, std::min(threads, (int)imp.files.size()));
+    std::cout << imp.rules->name() << ", " << imp.files.size() << " files, " << std::fixed << std::setprecision(1)
+              << totalBytes / 1e6 << " MB, " << threads << " threads\n";
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(worker, std::ref(imp));
+
+    auto report = [&]() {
+        double secs = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 1e-9);
+        long long games = imp.games.load();
+        uint64_t bytes = imp.bytes.load();
+        std::cout << std::fixed << std::setprecision(1) << games << " games, " << imp.accepted.load() << " accepted, "
+                  << bytes / 1e6 << "/" << totalBytes / 1e6 << " MB, " << games / secs << " games/s, "
+                  << bytes / 1e6 / secs << " MB/s" << std::endl;
+    };
+    auto lastReport = start;
+    while (imp.nextFile.load() < imp.files.size() + (size_t)threads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(5)) {
+            lastReport = std::chrono::steady_clock::now();
+            report();
+        }
+    }
+    for (auto& w : workers) w.join();
+    report();
+
+    imp.out.close();
+    if (!imp.out) {
+        std::cout << "Failed to write " << outPath << "\n";
+        return 1;
+    }
+    for (const auto& f : imp.perFormat) std::cout << "  " << f.first << ": " << f.second << " games\n";
+    if (!imp.rejected.empty()) {
+        std::vector<std::pair<long long, std::string>> reasons;
+        for (const auto& r : imp.rejected) reasons.push_back({r.second, r.first});
+        std::sort(reasons.rbegin(), reasons.rend());
+        std::cout << "Rejected:\n";
+        for (const auto& r : reasons) std::cout << "  " << r.first << "  " << r.second << "\n";
+    }
+    for (const auto& e : imp.errors) std::cout << "Stopped early: " << e << "\n";
+    std::cout << "Wrote " << imp.accepted.load() << " games to " << outPath << "\n";
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Exhaustive solver for small-board k-in-a-row variants.
+//
+//   gomoku_solve [-n size] [-k inRow] [-t threads] [-m tableMB] [-p splitPlies] [-o file.sol] [moves...]
+//
+// Solves the position after the given moves ("d4 c3 ..."; none = the empty
+// board) with SmallBoardSolver on all threads and prints its value, the value
+// of each move from it when split (-p 1, the default with several threads),
+// and the node count and time. The proven positions
+// are written as a SolutionBook file (default smallNxN_kK.sol) for
+// AIPlayer::setSolution. The file is then checked by letting AIPlayer play
+// both sides from the position on the file alone, and the probe time is
+// measured.
+#include "../include/AIPlayer.h"
+#include "../include/SmallBoardSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char* valueText(int value) {
+    return value > 0 ? "win" : value < 0 ? "loss" : "draw";
+}
+
+int main(int argc, char** argv) {
+    int size = 7, inRow = 5;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    size_t tableMb = 256;
+    int splitPly = -1;
+    std::string outPath;
+    std::vector<std::string> moveTexts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.size() > 1 && arg[0] == '-' && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "-n") size = std::stoi(value);
+            else if (arg == "-k") inRow = std::stoi(value);
+            else if (arg == "-t") threads = std::max(1, std::stoi(value));
+            else if (arg == "-m") tableMb = (size_t)std::max(1, std::stoi(value));
+            else if (arg == "-p") splitPly = std::max(0, std::stoi(value));
+            else if (arg == "-o") outPath = value;
+        } else {
+            moveTexts.push_back(arg);
+        }
+    }
+    if (size < 3 || size > SmallBoard::MAX_SIZE || inRow < 3 || inRow > size) {
+        std::cout << "Board sizes 3-" << SmallBoard::MAX_SIZE << " and run lengths 3-size are supported\n";
+        return 1;
+    }
+    if (splitPly < 0) splitPly = (threads > 1) ? 1 : 0;    // A split only pays for itself with threads to fill
+    if (outPath.empty()) outPath = "small" + std::to_string(size) + "x" + std::to_string(size) + "_k" + std::to_string(inRow) + ".sol";
+
+    SmallBoard board(size, inRow);
+    for (const auto& text : moveTexts) {
+        int cell = board.parseCell(text);
+        if (cell < 0 || !board.isEmpty(cell)) {
+            std::cout << "Bad move " << text << "\n";
+            return 1;
+        }
+        if (board.play(cell)) {
+            std::cout << "The game is over after " << text << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << size << "x" << size << ", " << inRow << " in a row, " << board.stones() << " stones, " << threads
+              << " threads, " << tableMb << " MB table, split at ply " << splitPly << "\n" << board.toString();
+
+    SmallBoardSolver solver(tableMb);
+    int best = -1;
+    int value = solver.solveParallel(board, threads, splitPly, best, [](long long done, long long jobs, long long nodes) {
+        std::cout << "  " << done << "/" << jobs << " subtrees, " << nodes << " nodes" << std::endl;
+    });
+    const auto& stats = solver.stats();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << (board.toMove() == Side::Black ? "Black" : "White") << " to move: " << valueText(value);
+    if (best >= 0) std::cout << ", best " << board.cellName(best);
+    std::cout << "\n" << stats.nodes << " nodes in " << stats.seconds << " s (" << stats.nodes / std::max(stats.seconds, 1e-9) / 1000
+              << "k nodes/s), " << stats.treePositions << " positions in the split tree, " << stats.jobs << " subtrees, table "
+              << solver.tableUsage() * 100 << "% full\n";
+    if (!solver.rootMoves().empty()) {
+        std::cout << "Moves (one per mirror image):";
+        for (const auto& m : solver.rootMoves()) std::cout << " " << board.cellName(m.cell) << "=" << valueText(m.value);
+        std::cout << "\n";
+    }
+
+    size_t written = 0;
+    if (!solver.writeBook(outPath, board, &written)) {
+        std::cout << "Failed to write " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << written << " positions (" << (24 + written * 10) / 1024 << " KiB) to " << outPath << "\n";
+
+    // Check the file: both sides play from it alone; every move must keep the value
+    auto book = std::make_shared<SolutionBook>();
+    if (!book->load(outPath)) {
+        std::cout << "Failed to read " << outPath << " back\n";
+        return 1;
+    }
+    AIPlayer ai(3);
+    ai.setSolution(book);
+    ai.setTimeLimitMs(10);  // Positions outside the file are not solved at length here
+    SmallBoard game = board;
+    std::vector<SmallBoard> positions;
+    int expected = value, misses = 0;
+    bool consistent = true;
+    std::string line;
+    while (!game.isFull()) {
+        positions.push_back(game);
+        int v, m;
+        if (!book->probe(game, v, m)) misses++;
+        int move = ai.getSmallBoardMove(game);
+        if (ai.lastStats().depth > 0 && ai.lastStats().score != expected) consistent = false;
+        line += " " + game.cellName(move);
+        if (game.play(move)) break;
+        expected = -expected;
+    }
+    std::cout << "Perfect play:" << line << " (" << (consistent ? "value kept" : "VALUE CHANGED") << ", " << misses
+              << " positions not in the file)\n";
+
+    const int PROBES = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    long long found = 0;
+    for (int i = 0; i < PROBES; ++i) {
+        int v, m;
+        found += book->probe(positions[i % positions.size()], v, m);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / PROBES;
+    std::cout << "Probe: " << ns << " ns (" << found << "/" << PROBES << " found)\n";
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+// SPSA tuner for the AIPlayer search parameters (SearchParams).
+//
+//   gomoku_spsa [-o search.txt] [-i iterations] [-g games] [-t threads] [-d difficulty]
+//               [-m ms] [-N nodes] [-p name,name,...] [-r rate] [-R renju|standard|freestyle] [-s seed]
+//
+// Every iteration perturbs all tuned parameters at once by +-c (random sign
+// per parameter), plays a batch of headless games between the "plus" and the
+// "minus" settings on all threads (each random opening twice, colours
+// swapped) and moves the parameters along the measured score difference.
+// Perturbation and step size shrink with the usual SPSA schedules.
+//
+// Games use the difficulty's node budget and noise from the starting
+// parameters, so the result is tuned for the production levels; -N sets
+// another budget, -m plays on the clock instead. By default the tunable parameters are searched (see
+// SearchParams.cpp); -p picks others, e.g. depth limits. The values are
+// written after every iteration as a config file for
+// SearchParams::loadDefault().
+#include "../include/AIPlayer.h"
+#include "../include/GomokuRuleSet.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MatchSettings {
+    const RuleSet* rules;
+    int difficulty;
+    int moveMs;             // 0 = the difficulty's limit
+    long long nodes;        // 0 = the difficulty's budget
+};
+
+static AIPlayer makePlayer(const MatchSettings& m, const SearchParams& params) {
+    AIPlayer ai(m.difficulty);
+    ai.setParams(params);
+    if (m.moveMs > 0) {
+        ai.setTimeLimitMs(m.moveMs);
+        ai.setNodeLimit(-1);    // The clock decides unless -N is given too
+    }
+    if (m.nodes > 0) {
+        ai.setNodeLimit(m.nodes);
+        if (m.moveMs <= 0) ai.setTimeLimitMs(600000);   // The node budget decides
+    }
+    return ai;
+}
+
+// Plays one headless game from the opening; returns the winner (Side::None on draw)
+static Side playGame(const MatchSettings& m, const SearchParams& black, const SearchParams& white, const std::vector<Move>& opening) {
+    AIPlayer blackAi = makePlayer(m, black), whiteAi = makePlayer(m, white);
+    Board board;
+    GameContext ctx;
+    m.rules->initGame(ctx, board);
+
+    while (true) {
+        Action action;
+        size_t ply = ctx.history.size();
+        if (ply < opening.size()) {
+            action = Action{ActionType::Place, opening[ply], 0};
+        } else {
+            AIPlayer& player = (ctx.toMove == Side::Black) ? blackAi : whiteAi;
+            action = player.getAction(ctx, board, *m.rules);
+        }
+
+        std::string reason;
+        Side mover = ctx.toMove;
+        if (!m.rules->validateAction(ctx, board, mover, action, reason)) {
+            return (mover == Side::Black) ? Side::White : Side::Black;
+        }
+        m.rules->applyAction(ctx, board, mover, action);
+        ctx.history.push_back(HistoryEntry(mover, action));
+
+        Outcome outcome = m.rules->evaluateAfterAction(ctx, board, mover, action);
+        if (outcome.status == GameStatus::Win) return *outcome.winner;
+        if (outcome.status == GameStatus::PendingClaim) return Side::White; // White always claims
+        if (outcome.status == GameStatus::Draw) return Side::None;
+    }
+}
+
+// Tengen (placed by initGame) plus 2-4 random candidate moves; none of them ends the game
+static std::vector<Move> randomOpening(const RuleSet& rules, std::mt19937_64& rng) {
+    while (true) {
+        Board board;
+        GameContext ctx;
+        rules.initGame(ctx, board);
+        std::vector<Move> opening;
+        for (const auto& h : ctx.history) opening.push_back(h.move);
+
+        int plies = 2 + (int)(rng() % 3);
+        bool ok = true;
+        for (int i = 0; i < plies && ok; ++i) {
+            std::vector<Move> moves = getCandidates(board);
+            Action action{ActionType::Place, moves[rng() % moves.size()], 0};
+            std::string reason;
+            Side mover = ctx.toMove;
+            ok = rules.validateAction(ctx, board, mover, action, reason);
+            if (!ok) break;
+            rules.applyAction(ctx, board, mover, action);
+            ctx.history.push_back(HistoryEntry(mover, action));
+            ok = rules.evaluateAfterAction(ctx, board, mover, action).status == GameStatus::Ongoing;
+            opening.push_back(action.move);
+        }
+        if (ok) return opening;
+    }
+}
+
+static SearchParams rounded(const SearchParams& base, const std::vector<int>& tuned, const std::vector<double>& values) {
+    SearchParams p = base;
+    for (size_t i = 0; i < tuned.size(); ++i) {
+        const auto& info = SearchParams::info(tuned[i]);
+        p[tuned[i]] = (int)std::clamp(std::lround(values[i]), (long)info.min, (long)info.max);
+    }
+    return p;
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = "search.txt";
+    std::string ruleName = "renju";
+    std::string paramList;
+    int iterations = 100;
+    int games = 16;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int difficulty = 3;
+    int moveMs = 0;
+    long long nodes = 0;
+    double rate = 1.0;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) break;
+        if (arg == "-o") outPath = argv[++i];
+        else if (arg == "-i") iterations = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-g") games = std::max(2, std::stoi(argv[++i]) / 2 * 2);
+        else if (arg == "-t") threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-d") difficulty = std::clamp(std::stoi(argv[++i]), 1, 3);
+        else if (arg == "-m") moveMs = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "-N") nodes = std::max(0LL, std::stoll(argv[++i]));
+        else if (arg == "-p") paramList = argv[++i];
+        else if (arg == "-r") rate = std::stod(argv[++i]);
+        else if (arg == "-R") ruleName = argv[++i];
+        else if (arg == "-s") seed = std::stoull(argv[++i]);
+    }
+
+    std::unique_ptr<RuleSet> rules;
+    if (ruleName == "freestyle") rules = std::make_unique<FreestyleRuleSet>();
+    else if (ruleName == "standard") rules = std::make_unique<StandardRuleSet>();
+    else rules = std::make_unique<GomokuRuleSet>();
+
+    // Start from the engine's current parameters
+    SearchParams::loadDefault();
+    const SearchParams base = SearchParams::active();
+
+    std::vector<int> tuned;
+    if (paramList.empty()) {
+        for (int i = 0; i < SearchParams::count(); ++i) {
+            if (SearchParams::info(i).tunable) tuned.push_back(i);
+        }
+    } else {
+        std::istringstream names(paramList);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            int index = SearchParams::find(name);
+            if (index < 0) {
+                std::cout << "Unknown parameter " << name << "\n";
+                return 1;
+            }
+            tuned.push_back(index);
+        }
+    }
+
+    // theta: current values; c: initial perturbation, a fifth of the starting value but at least 1
+    std::vector<double> theta, c;
+    for (int index : tuned) {
+        theta.push_back(base[index]);
+        c.push_back(std::max(1.0, 0.2 * std::abs(base[index])));
+    }
+    const double A = iterations / 10.0;     // Stability constant: damps the first steps
+    const double ALPHA = 0.602, GAMMA = 0.101;
+
+    MatchSettings match{rules.get(), difficulty, moveMs, nodes};
+    std::mt19937_64 rng(seed);
+    std::cout << rules->name() << ", " << tuned.size() << " parameters, " << games << " games/iteration on "
+              << threads << " threads, ";
+    if (nodes > 0) std::cout << nodes << " nodes/move\n";
+    else if (moveMs > 0) std::cout << moveMs << " ms/move\n";
+    else std::cout << "difficulty " << difficulty << " node budget\n";
+
+    for (int k = 0; k < iterations; ++k) {
+        double ck = 1.0 / std::pow(k + 1, GAMMA);
+        double rk = rate / std::pow(k + 1 + A, ALPHA);
+
+        std::vector<int> delta(tuned.size());
+        std::vector<double> plusValues(tuned.size()), minusValues(tuned.size());
+        for (size_t i = 0; i < tuned.size(); ++i) {
+            delta[i] = (rng() & 1) ? 1 : -1;
+            plusValues[i] = theta[i] + ck * c[i] * delta[i];
+            minusValues[i] = theta[i] - ck * c[i] * delta[i];
+        }
+        SearchParams plus = rounded(base, tuned, plusValues);
+        SearchParams minus = rounded(base, tuned, minusValues);
+
+        std::vector<std::vector<Move>> openings;
+        for (int g = 0; g < games / 2; ++g) openings.push_back(randomOpening(*rules, rng));
+
+        // Game g: opening g / 2, "plus" plays Black in even games; scores are for "plus"
+        std::vector<int> results(games);
+        std::atomic<int> next{0};
+        auto worker = [&]() {
+            for (int g = next++; g < games; g = next++) {
+                bool plusBlack = (g % 2 == 0);
+                Side winner = plusBlack ? playGame(match, plus, minus, openings[g / 2]) : playGame(match, minus, plus, openings[g / 2]);
+                Side plusSide = plusBlack ? Side::Black : Side::White;
+                results[g] = (winner == Side::None) ? 0 : (winner == plusSide ? 1 : -1);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 0; t < std::min(threads, games); ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+
+        int wins = 0, losses = 0;
+        for (int r : results) {
+            if (r > 0) wins++;
+            if (r < 0) losses++;
+        }
+        double score = (double)(wins - losses) / games;
+
+        for (size_t i = 0; i < tuned.size(); ++i) {
+            const auto& info = SearchParams::info(tuned[i]);
+            theta[i] = std::clamp(theta[i] + rk * ck * c[i] * score * delta[i], (double)info.min, (double)info.max);
+        }
+
+        SearchParams current = rounded(base, tuned, theta);
+        std::cout << "iteration " << (k + 1) << ": plus +" << wins << " -" << losses << " =" << (games - wins - losses);
+        for (size_t i = 0; i < tuned.size(); ++i) std::cout << "  " << SearchParams::info(tuned[i]).name << " " << current[tuned[i]];
+        std::cout << std::endl;
+        if (!current.save(outPath)) {
+            std::cout << "Failed to write " << outPath << "\n";
+            return 1;
+        }
+    }
+    std::cout << "Wrote " << outPath << "; copy it to weights/search.txt or point $GOMOKU_PARAMS at it\n";
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Texel-style tuner for the evaluateBoard pattern weights.
+//
+//   gomoku_tune [-o weights.txt] [-t threads] [-i iterations] <record files or directories>...
+//
+// Replays finished games from match/ records, keeps quiet positions (no
+// immediate five for either side) labelled with the game result, and fits the
+// weights so that sigmoid(K * eval) predicts the result. The output file is
+// what EvalWeights::loadDefault() reads at startup.
+#include "../include/Board.h"
+#include "../include/EvalWeights.h"
+#include "../include/GameRecord.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+namespace fs = std::filesystem;
+
+// 18 bytes per position: pattern counts (Black minus White) and the result for Black
+struct TunePosition {
+    int16_t features[PAT_COUNT];
+    uint8_t result; // 0 = White won, 1 = draw, 2 = Black won
+};
+
+// Patterns that are fitted; fives never occur in quiet positions and singles score nothing
+static const int TUNED[] = {PAT_OPEN_FOUR, PAT_FOUR, PAT_OPEN_THREE, PAT_THREE, PAT_OPEN_TWO, PAT_TWO};
+static const int TUNED_COUNT = sizeof(TUNED) / sizeof(TUNED[0]);
+
+static bool hasFiveThreat(const Board& board) {
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (int r = 0; r < Board::SIZE; ++r) {
+        for (int c = 0; c < Board::SIZE; ++c) {
+            Pos p = {r, c};
+            if (!board.isEmpty(p)) continue;
+            for (Side side : {Side::Black, Side::White}) {
+                for (auto& d : dirs) {
+                    if (1 + board.countConsecutive(p, d[0], d[1], side) + board.countConsecutive(p, -d[0], -d[1], side) >= 5) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Result of a recorded game for Black (2/1/0), or -1 if the record does not show how it ended
+static int gameResult(const GameRecord& record) {
+    if (record.moves.empty()) return -1;
+    const HistoryEntry& last = record.moves.back();
+    if (last.type() == ActionType::Resign) return last.side() == Side::Black ? 0 : 2;
+    if (last.type() == ActionType::ClaimForbidden) return 0;
+    if (last.type() != ActionType::Place || last.move.isNone()) return -1;
+
+    Board board;
+    for (const auto& move : record.moves) {
+        if (move.type() == ActionType::Place && !move.move.isNone()) board.set(move.move, move.side());
+    }
+    if (board.isFull()) return 1;
+    Pos p = last.move.pos();
+    int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (auto& d : dirs) {
+        if (1 + board.countConsecutive(p, d[0], d[1], last.side()) + board.countConsecutive(p, -d[0], -d[1], last.side()) >= 5) {
+            return last.side() == Side::Black ? 2 : 0;
+        }
+    }
+    return -1;
+}
+
+// Every record in the file: match/ holds one game per file, gomoku_import archives many
+static void collectPositions(const std::string& path, std::vector<TunePosition>& out, int& games) {
+    std::ifstream in(path);
+    GameRecord record;
+    while (in.is_open() && readGameRecord(in, record)) {
+        int result = gameResult(record);
+        if (result < 0) continue;
+        games++;
+
+        Board board;
+        for (size_t i = 0; i < record.moves.size(); ++i) {
+            const HistoryEntry& move = record.moves[i];
+            if (move.type() != ActionType::Place || move.move.isNone()) continue;
+            board.set(move.move, move.side());
+            if (i < 4 || hasFiveThreat(board)) continue;
+
+            int features[PAT_COUNT];
+            extractEvalFeatures(board, Side::Black, Side::White, features);
+            TunePosition tp;
+            for (int k = 0; k < PAT_COUNT; ++k) tp.features[k] = (int16_t)std::clamp(features[k], -32768, 32767);
+            tp.result = (uint8_t)result;
+            out.push_back(tp);
+        }
+    }
+}
+
+static double sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+// Mean squared error of the predictions and its gradient w.r.t. each tuned weight
+static double lossAndGradient(const std::vector<TunePosition>& data, const double* weights, double k, int threads, double* grad) {
+    std::vector<double> partialLoss(threads, 0.0);
+    std::vector<std::vector<double>> partialGrad(threads, std::vector<double>(PAT_COUNT, 0.0));
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            size_t begin = data.size() * t / threads;
+            size_t end = data.size() * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) {
+                const auto& tp = data[i];
+                double eval = 0;
+                for (int f = 0; f < PAT_COUNT; ++f) eval += weights[f] * tp.features[f];
+                double pred = sigmoid(k * eval);
+                double err = tp.result * 0.5 - pred;
+                partialLoss[t] += err * err;
+                if (grad) {
+                    double g = -2.0 * err * pred * (1.0 - pred) * k;
+                    for (int f = 0; f < PAT_COUNT; ++f) partialGrad[t][f] += g * tp.features[f];
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    double loss = 0;
+    if (grad) std::fill(grad, grad + PAT_COUNT, 0.0);
+    for (int t = 0; t < threads; ++t) {
+        loss += partialLoss[t];
+        if (grad) for (int f = 0; f < PAT_COUNT; ++f) grad[f] += partialGrad[t][f];
+    }
+    double n = (double)std::max<size_t>(1, data.size());
+    if (grad) for (int f = 0; f < PAT_COUNT; ++f) grad[f] /= n;
+    return loss / n;
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = "../weights/eval.txt";
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int iterations = 2000;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "-t" && i + 1 < argc) threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-i" && i + 1 < argc) iterations = std::stoi(argv[++i]);
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) inputs.push_back("../match");
+
+    std::vector<TunePosition> data;
+    int games = 0;
+    for (const auto& input : inputs) {
+        if (fs::is_directory(input)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input)) {
+                if (entry.path().extension() == ".txt") collectPositions(entry.path().string(), data, games);
+            }
+        } else {
+            collectPositions(input, data, games);
+        }
+    }
+    std::cout << games << " games, " << data.size() << " quiet positions ("
+              << data.size() * sizeof(TunePosition) / 1024 << " KiB)\n";
+    if (data.empty()) return 1;
+
+    EvalWeights weights = EvalWeights::active();
+    double w[PAT_COUNT];
+    for (int f = 0; f < PAT_COUNT; ++f) w[f] = (double)weights.board[f];
+
+    // Scale K: pick the value that best fits the current weights (log-scale ternary search)
+    double lo = -12, hi = 0;
+    for (int it = 0; it < 60; ++it) {
+        double m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+        if (lossAndGradient(data, w, std::pow(10.0, m1), threads, nullptr) < lossAndGradient(data, w, std::pow(10.0, m2), threads, nullptr)) hi = m2;
+        else lo = m1;
+    }
+    double k = std::pow(10.0, (lo + hi) / 2);
+    double startLoss = lossAndGradient(data, w, k, threads, nullptr);
+    std::cout << "K = " << k << ", initial loss " << startLoss << "\n";
+
+    // Gradient descent on log-weights keeps every weight positive and handles
+    // their very different magnitudes; Adam-style step normalisation.
+    double theta[PAT_COUNT], m[PAT_COUNT] = {}, v[PAT_COUNT] = {};
+    for (int f = 0; f < PAT_COUNT; ++f) theta[f] = std::log(std::max(1.0, w[f]));
+    const double rate = 0.01, beta1 = 0.9, beta2 = 0.999;
+    double grad[PAT_COUNT];
+    double loss = startLoss;
+    for (int it = 1; it <= iterations; ++it) {
+        loss = lossAndGradient(data, w, k, threads, grad);
+        for (int i = 0; i < TUNED_COUNT; ++i) {
+            int f = TUNED[i];
+            double g = grad[f] * w[f]; // d(loss)/d(theta)
+            m[f] = beta1 * m[f] + (1 - beta1) * g;
+            v[f] = beta2 * v[f] + (1 - beta2) * g * g;
+            double mHat = m[f] / (1 - std::pow(beta1, it));
+            double vHat = v[f] / (1 - std::pow(beta2, it));
+            theta[f] -= rate * mHat / (std::sqrt(vHat) + 1e-12);
+            w[f] = std::exp(theta[f]);
+        }
+        if (it % 200 == 0) std::cout << "iteration " << it << ": loss " << loss << "\n";
+    }
+
+    for (int i = 0; i < TUNED_COUNT; ++i) {
+        int f = TUNED[i];
+        weights.board[f] = std::llround(w[f]);
+        std::cout << "board." << EvalWeights::patternName(f) << " " << weights.board[f] << "\n";
+    }
+    std::cout << "loss " << startLoss << " -> " << loss << "\n";
+
+    fs::path parent = fs::path(outPath).parent_path();
+    if (!parent.empty() && !fs::exists(parent)) fs::create_directories(parent);
+    if (!weights.save(outPath)) {
+        std::cout << "Failed to write " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Weights written to " << outPath << "\n";
+    return 0;
+}